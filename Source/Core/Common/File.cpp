@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cerrno>
 #include <cstddef>
 #include <cstdio>
 #include <string>
@@ -109,6 +110,39 @@ u64 IOFile::Tell() const
     return UINT64_MAX;
 }
 
+bool IOFile::ReadAt(u64 offset, void* data, size_t length)
+{
+#ifdef _WIN32
+  return Seek(static_cast<s64>(offset), SEEK_SET) && ReadBytes(data, length);
+#else
+  if (!IsOpen())
+  {
+    m_good = false;
+    return false;
+  }
+
+  const int fd = fileno(m_file);
+  u8* out = static_cast<u8*>(data);
+  while (length > 0)
+  {
+    const ssize_t result = pread(fd, out, length, static_cast<off_t>(offset));
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result <= 0)
+    {
+      m_good = false;
+      return false;
+    }
+
+    out += result;
+    offset += result;
+    length -= result;
+  }
+
+  return m_good;
+#endif
+}
+
 bool IOFile::Flush()
 {
   if (!IsOpen() || 0 != std::fflush(m_file))
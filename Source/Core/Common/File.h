@@ -67,6 +67,11 @@ public:
     return WriteArray(reinterpret_cast<const char*>(data), length);
   }
 
+  // Reads length bytes starting at the given absolute offset. Where possible this is done
+  // with a single positioned read (pread) that does not move the stream position,
+  // otherwise it falls back to Seek + ReadBytes. Buffered writes must be flushed first.
+  bool ReadAt(u64 offset, void* data, size_t length);
+
   bool IsOpen() const { return nullptr != m_file; }
   // m_good is set to false when a read, write or other function fails
   bool IsGood() const { return m_good; }
@@ -0,0 +1,98 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a lockless thread-safe,
+// multiple producer, single consumer queue
+//
+// Pushing is a single compare-exchange on the head of a list of the pushed elements. The
+// consumer takes the whole list at once and reverses it, so the elements of each producer come
+// out in the order they were pushed.
+
+#include <atomic>
+#include <utility>
+
+namespace Common
+{
+template <typename T>
+class MPSCQueue
+{
+public:
+  MPSCQueue() = default;
+  MPSCQueue(const MPSCQueue&) = delete;
+  MPSCQueue& operator=(const MPSCQueue&) = delete;
+  ~MPSCQueue() { Clear(); }
+
+  template <typename Arg>
+  void Push(Arg&& t)
+  {
+    Node* node = new Node{T(std::forward<Arg>(t)), m_head.load(std::memory_order_relaxed)};
+    while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                         std::memory_order_relaxed))
+    {
+    }
+  }
+
+  // The rest may only be called by the consumer
+
+  bool Empty() const { return !m_popped && !m_head.load(std::memory_order_acquire); }
+
+  bool Pop(T& t)
+  {
+    if (!m_popped)
+    {
+      // Avoids the atomic exchange when the queue is empty, which is most of the time
+      if (!m_head.load(std::memory_order_relaxed))
+        return false;
+
+      Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+      while (node)
+      {
+        Node* next = node->next;
+        node->next = m_popped;
+        m_popped = node;
+        node = next;
+      }
+      if (!m_popped)
+        return false;
+    }
+
+    Node* node = m_popped;
+    m_popped = node->next;
+    t = std::move(node->value);
+    delete node;
+    return true;
+  }
+
+  void Clear()
+  {
+    Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+    while (node)
+    {
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
+    while (m_popped)
+    {
+      Node* next = m_popped->next;
+      delete m_popped;
+      m_popped = next;
+    }
+  }
+
+private:
+  struct Node
+  {
+    T value;
+    Node* next;
+  };
+
+  // The most recently pushed element, linked to the ones pushed before it
+  std::atomic<Node*> m_head{nullptr};
+  // Elements taken from m_head and not popped yet, oldest first
+  Node* m_popped = nullptr;
+};
+}  // namespace Common
@@ -0,0 +1,531 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/TaskScheduler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+
+namespace Common
+{
+namespace
+{
+constexpr size_t NUM_PRIORITIES = 2;
+constexpr size_t DEQUE_CAPACITY = 1024;
+constexpr size_t INJECTION_QUEUE_CAPACITY = 4096;
+// How many times an idle worker looks for work before going to sleep
+constexpr u32 IDLE_SPIN_COUNT = 64;
+
+struct Task
+{
+  std::function<void()> function;
+  // Counter of the TaskGroup the task belongs to, if any
+  std::atomic<u32>* pending;
+};
+
+// Chase-Lev work-stealing deque with a fixed capacity.
+// Only the owning worker may Push and Pop (at the bottom); any thread may Steal (at the top).
+// See "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al., PPoPP 2013).
+class WorkStealingDeque final
+{
+public:
+  WorkStealingDeque()
+  {
+    for (auto& task : m_tasks)
+      task.store(nullptr, std::memory_order_relaxed);
+  }
+
+  // Returns false if the deque is full.
+  bool Push(Task* task)
+  {
+    const s64 bottom = m_bottom.load(std::memory_order_relaxed);
+    const s64 top = m_top.load(std::memory_order_acquire);
+    if (bottom - top >= static_cast<s64>(DEQUE_CAPACITY))
+      return false;
+
+    m_tasks[bottom & MASK].store(task, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  Task* Pop()
+  {
+    const s64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    s64 top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    Task* task = m_tasks[bottom & MASK].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+      // Last task: race against thieves for it
+      if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed))
+      {
+        task = nullptr;
+      }
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+  }
+
+  Task* Steal()
+  {
+    s64 top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const s64 bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+      return nullptr;
+
+    Task* task = m_tasks[top & MASK].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed))
+    {
+      return nullptr;
+    }
+    return task;
+  }
+
+private:
+  static constexpr s64 MASK = DEQUE_CAPACITY - 1;
+  static_assert((DEQUE_CAPACITY & (DEQUE_CAPACITY - 1)) == 0, "Capacity must be a power of 2");
+
+  alignas(64) std::atomic<s64> m_top{0};
+  alignas(64) std::atomic<s64> m_bottom{0};
+  std::array<std::atomic<Task*>, DEQUE_CAPACITY> m_tasks;
+};
+
+// Bounded lock-free multi-producer multi-consumer queue (Dmitry Vyukov's design).
+class InjectionQueue final
+{
+public:
+  InjectionQueue()
+  {
+    for (size_t i = 0; i < m_cells.size(); ++i)
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  bool TryPush(Task* task)
+  {
+    size_t position = m_enqueue_position.load(std::memory_order_relaxed);
+    while (true)
+    {
+      Cell& cell = m_cells[position & MASK];
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const intptr_t difference =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+      if (difference == 0)
+      {
+        if (m_enqueue_position.compare_exchange_weak(position, position + 1,
+                                                     std::memory_order_relaxed))
+        {
+          cell.task = task;
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0)
+      {
+        return false;
+      }
+      else
+      {
+        position = m_enqueue_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  Task* TryPop()
+  {
+    size_t position = m_dequeue_position.load(std::memory_order_relaxed);
+    while (true)
+    {
+      Cell& cell = m_cells[position & MASK];
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const intptr_t difference =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+      if (difference == 0)
+      {
+        if (m_dequeue_position.compare_exchange_weak(position, position + 1,
+                                                     std::memory_order_relaxed))
+        {
+          Task* task = cell.task;
+          cell.sequence.store(position + MASK + 1, std::memory_order_release);
+          return task;
+        }
+      }
+      else if (difference < 0)
+      {
+        return nullptr;
+      }
+      else
+      {
+        position = m_dequeue_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  static constexpr size_t MASK = INJECTION_QUEUE_CAPACITY - 1;
+  static_assert((INJECTION_QUEUE_CAPACITY & MASK) == 0, "Capacity must be a power of 2");
+
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    Task* task;
+  };
+
+  std::array<Cell, INJECTION_QUEUE_CAPACITY> m_cells;
+  alignas(64) std::atomic<size_t> m_enqueue_position{0};
+  alignas(64) std::atomic<size_t> m_dequeue_position{0};
+};
+
+struct alignas(64) Worker
+{
+  std::array<WorkStealingDeque, NUM_PRIORITIES> deques;
+  // Only written by the worker itself
+  std::atomic<u64> tasks_executed{0};
+  std::atomic<u64> tasks_stolen{0};
+  std::atomic<u64> steal_attempts{0};
+  u32 random_state = 0;
+  std::thread thread;
+};
+
+thread_local int s_worker_index = -1;
+
+class Scheduler final
+{
+public:
+  Scheduler()
+  {
+    const size_t num_workers = static_cast<size_t>(std::max(1, cpu_info.logical_cpu_count - 1));
+    m_workers.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i)
+    {
+      m_workers.push_back(std::make_unique<Worker>());
+      m_workers.back()->random_state = static_cast<u32>(i * 2654435761u + 1);
+    }
+    for (size_t i = 0; i < num_workers; ++i)
+      m_workers[i]->thread = std::thread(&Scheduler::WorkerLoop, this, static_cast<int>(i));
+  }
+
+  ~Scheduler()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_sleep_mutex);
+      m_running.store(false);
+    }
+    m_sleep_condition.notify_all();
+    for (auto& worker : m_workers)
+      worker->thread.join();
+
+    // Anything still queued is dropped
+    for (size_t priority = 0; priority < NUM_PRIORITIES; ++priority)
+    {
+      while (Task* task = m_injection_queues[priority].TryPop())
+        delete task;
+      for (auto& worker : m_workers)
+      {
+        while (Task* task = worker->deques[priority].Steal())
+          delete task;
+      }
+    }
+  }
+
+  void Enqueue(std::function<void()> function, std::atomic<u32>* pending, TaskPriority priority)
+  {
+    const size_t index = static_cast<size_t>(priority);
+    Task* task = new Task{std::move(function), pending};
+
+    const s64 depth = m_queue_depth.fetch_add(1, std::memory_order_relaxed) + 1;
+    u64 max_depth = m_max_queue_depth.load(std::memory_order_relaxed);
+    while (static_cast<u64>(depth) > max_depth &&
+           !m_max_queue_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed))
+    {
+    }
+
+    if (s_worker_index >= 0)
+    {
+      // Workers queue on their own deque, or run the task right away if it's full
+      if (!m_workers[s_worker_index]->deques[index].Push(task) &&
+          !m_injection_queues[index].TryPush(task))
+      {
+        RunTask(task);
+        return;
+      }
+    }
+    else
+    {
+      while (!m_injection_queues[index].TryPush(task))
+        YieldCPU();
+    }
+
+    m_work_epoch.fetch_add(1);
+    if (m_sleepers.load() != 0)
+    {
+      std::lock_guard<std::mutex> lock(m_sleep_mutex);
+      m_sleep_condition.notify_one();
+    }
+  }
+
+  // Runs a single queued task on the calling thread. Returns false if none was found.
+  bool RunOneTask(TaskPriority lowest_priority)
+  {
+    Task* task = FindTask(s_worker_index, lowest_priority);
+    if (!task)
+      return false;
+    RunTask(task);
+    return true;
+  }
+
+  size_t GetWorkerCount() const { return m_workers.size(); }
+
+  TaskSchedulerCounters GetCounters() const
+  {
+    TaskSchedulerCounters counters;
+    for (const auto& worker : m_workers)
+    {
+      counters.tasks_executed += worker->tasks_executed.load(std::memory_order_relaxed);
+      counters.tasks_stolen += worker->tasks_stolen.load(std::memory_order_relaxed);
+      counters.steal_attempts += worker->steal_attempts.load(std::memory_order_relaxed);
+    }
+    counters.tasks_executed += m_external_tasks_executed.load(std::memory_order_relaxed);
+    counters.queue_depth = std::max<s64>(0, m_queue_depth.load(std::memory_order_relaxed));
+    counters.max_queue_depth = m_max_queue_depth.load(std::memory_order_relaxed);
+    return counters;
+  }
+
+  void ResetCounters()
+  {
+    for (auto& worker : m_workers)
+    {
+      worker->tasks_executed.store(0, std::memory_order_relaxed);
+      worker->tasks_stolen.store(0, std::memory_order_relaxed);
+      worker->steal_attempts.store(0, std::memory_order_relaxed);
+    }
+    m_external_tasks_executed.store(0, std::memory_order_relaxed);
+    m_max_queue_depth.store(std::max<s64>(0, m_queue_depth.load(std::memory_order_relaxed)),
+                            std::memory_order_relaxed);
+  }
+
+private:
+  void WorkerLoop(int index)
+  {
+    s_worker_index = index;
+    Common::SetCurrentThreadName(StringFromFormat("Task Worker %d", index).c_str());
+
+    u32 idle_count = 0;
+    while (m_running.load(std::memory_order_relaxed))
+    {
+      const u64 epoch = m_work_epoch.load();
+      if (RunOneTask(TaskPriority::Background))
+      {
+        idle_count = 0;
+        continue;
+      }
+
+      if (++idle_count < IDLE_SPIN_COUNT)
+      {
+        YieldCPU();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(m_sleep_mutex);
+      m_sleepers.fetch_add(1);
+      m_sleep_condition.wait(lock, [this, epoch] {
+        return m_work_epoch.load() != epoch || !m_running.load(std::memory_order_relaxed);
+      });
+      m_sleepers.fetch_sub(1);
+      idle_count = 0;
+    }
+  }
+
+  // Looks for a task of the given priority or higher: first in the worker's own deque, then
+  // in the injection queue, then in the other workers' deques.
+  Task* FindTask(int worker_index, TaskPriority lowest_priority)
+  {
+    Worker* self = worker_index >= 0 ? m_workers[worker_index].get() : nullptr;
+    for (size_t priority = 0; priority <= static_cast<size_t>(lowest_priority); ++priority)
+    {
+      if (self)
+      {
+        if (Task* task = self->deques[priority].Pop())
+          return task;
+      }
+
+      if (Task* task = m_injection_queues[priority].TryPop())
+        return task;
+
+      if (Task* task = Steal(self, worker_index, priority))
+        return task;
+    }
+    return nullptr;
+  }
+
+  Task* Steal(Worker* self, int worker_index, size_t priority)
+  {
+    const size_t num_workers = m_workers.size();
+    size_t start = 0;
+    if (self)
+    {
+      // xorshift, so that thieves don't all go for the same victim
+      u32& x = self->random_state;
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      start = x % num_workers;
+    }
+
+    for (size_t i = 0; i < num_workers; ++i)
+    {
+      const size_t victim = (start + i) % num_workers;
+      if (static_cast<int>(victim) == worker_index)
+        continue;
+
+      Task* task = m_workers[victim]->deques[priority].Steal();
+      if (self)
+        self->steal_attempts.fetch_add(1, std::memory_order_relaxed);
+      if (task)
+      {
+        if (self)
+          self->tasks_stolen.fetch_add(1, std::memory_order_relaxed);
+        return task;
+      }
+    }
+    return nullptr;
+  }
+
+  void RunTask(Task* task)
+  {
+    m_queue_depth.fetch_sub(1, std::memory_order_relaxed);
+    task->function();
+    if (task->pending)
+      task->pending->fetch_sub(1, std::memory_order_release);
+    delete task;
+
+    if (s_worker_index >= 0)
+      m_workers[s_worker_index]->tasks_executed.fetch_add(1, std::memory_order_relaxed);
+    else
+      m_external_tasks_executed.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::array<InjectionQueue, NUM_PRIORITIES> m_injection_queues;
+
+  std::atomic<s64> m_queue_depth{0};
+  std::atomic<u64> m_max_queue_depth{0};
+  std::atomic<u64> m_external_tasks_executed{0};
+
+  // Incremented whenever a task is queued, so that a worker going to sleep can tell whether
+  // anything was queued since it last looked.
+  std::atomic<u64> m_work_epoch{0};
+  std::atomic<u32> m_sleepers{0};
+  std::mutex m_sleep_mutex;
+  std::condition_variable m_sleep_condition;
+  std::atomic<bool> m_running{true};
+};
+
+Scheduler& GetScheduler()
+{
+  static Scheduler scheduler;
+  return scheduler;
+}
+}  // namespace
+
+void TaskGroup::Run(std::function<void()> task, TaskPriority priority)
+{
+  m_pending.fetch_add(1, std::memory_order_relaxed);
+  GetScheduler().Enqueue(std::move(task), &m_pending, priority);
+}
+
+void TaskGroup::Wait()
+{
+  if (m_pending.load(std::memory_order_acquire) == 0)
+    return;
+
+  // Other threads must not pick up Background work here, as it could take much longer than
+  // the tasks being waited on.
+  Scheduler& scheduler = GetScheduler();
+  const TaskPriority lowest_priority =
+      s_worker_index >= 0 ? TaskPriority::Background : TaskPriority::High;
+  while (m_pending.load(std::memory_order_acquire) != 0)
+  {
+    if (!scheduler.RunOneTask(lowest_priority))
+      YieldCPU();
+  }
+}
+
+void TaskScheduler::Submit(std::function<void()> task, TaskPriority priority)
+{
+  GetScheduler().Enqueue(std::move(task), nullptr, priority);
+}
+
+void TaskScheduler::ParallelFor(s32 begin, s32 end, s32 grain,
+                                const std::function<void(s32, s32)>& body, TaskPriority priority)
+{
+  if (end <= begin)
+    return;
+
+  grain = std::max(grain, 1);
+  if (end - begin <= grain)
+  {
+    body(begin, end);
+    return;
+  }
+
+  TaskGroup group;
+  for (s64 start = s64{begin} + grain; start < end; start += grain)
+  {
+    const s32 range_begin = static_cast<s32>(start);
+    const s32 range_end = static_cast<s32>(std::min<s64>(start + grain, end));
+    group.Run([&body, range_begin, range_end] { body(range_begin, range_end); }, priority);
+  }
+
+  body(begin, begin + grain);
+  group.Wait();
+}
+
+size_t TaskScheduler::GetWorkerCount()
+{
+  return GetScheduler().GetWorkerCount();
+}
+
+int TaskScheduler::GetCurrentWorkerIndex()
+{
+  return s_worker_index;
+}
+
+TaskSchedulerCounters TaskScheduler::GetCounters()
+{
+  return GetScheduler().GetCounters();
+}
+
+void TaskScheduler::ResetCounters()
+{
+  GetScheduler().ResetCounters();
+}
+
+}  // namespace Common
@@ -0,0 +1,83 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// TaskScheduler is a work-stealing scheduler that subsystems share instead of starting their
+// own threads, so that together they never use more threads than there are cores.
+//
+// Each worker owns a lock-free deque per priority. Tasks started from a worker go to the
+// bottom of its own deque and are taken from there in LIFO order, while idle workers steal
+// from the top of the other workers' deques. Tasks started from any other thread go through
+// lock-free multi-producer queues.
+//
+// High priority work (something the GPU or CPU thread is waiting on) is always taken before
+// Background work (shader compilation, prefetching), wherever it is queued.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+enum class TaskPriority
+{
+  High,
+  Background,
+};
+
+struct TaskSchedulerCounters
+{
+  u64 tasks_executed = 0;
+  // Tasks taken from another worker's deque
+  u64 tasks_stolen = 0;
+  u64 steal_attempts = 0;
+  // Tasks that are queued but haven't started yet
+  u64 queue_depth = 0;
+  u64 max_queue_depth = 0;
+};
+
+// A set of tasks that can be waited on.
+class TaskGroup final
+{
+public:
+  TaskGroup() = default;
+  ~TaskGroup() { Wait(); }
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  void Run(std::function<void()> task, TaskPriority priority = TaskPriority::High);
+
+  // Returns once every task of the group has finished. While waiting, the calling thread
+  // runs High priority tasks itself (Background tasks too if it is a worker).
+  void Wait();
+
+private:
+  std::atomic<u32> m_pending{0};
+};
+
+class TaskScheduler final
+{
+public:
+  // Runs task on a worker. There is no way to wait for it; use a TaskGroup for that.
+  static void Submit(std::function<void()> task, TaskPriority priority = TaskPriority::Background);
+
+  // Calls body(range_begin, range_end) for consecutive ranges of at most grain elements that
+  // together cover [begin, end), in parallel. The calling thread takes part and the call
+  // returns once all ranges are done.
+  static void ParallelFor(s32 begin, s32 end, s32 grain,
+                          const std::function<void(s32, s32)>& body,
+                          TaskPriority priority = TaskPriority::High);
+
+  static size_t GetWorkerCount();
+  // Index of the worker the calling thread is, or -1 for other threads.
+  static int GetCurrentWorkerIndex();
+
+  static TaskSchedulerCounters GetCounters();
+  static void ResetCounters();
+};
+
+}  // namespace Common
@@ -1,38 +1,18 @@
+#include <algorithm>
+
 #include "Common/Common.h"
-#include "Common/CPUDetect.h"
+#include "Common/TaskScheduler.h"
 #include "Common/ThreadPool.h"
-#ifdef _WIN32
-#include <windows.h>
-#endif
 using namespace Common;
 std::mutex ThreadPool::m_workerLock;
 
-ThreadPool::ThreadPool() : m_workflag(0), m_workercount(0), m_workers(16)
+// The pool has no threads of its own: pending work is picked up by the shared TaskScheduler.
+ThreadPool::ThreadPool() : m_workers()
 {
-  m_working.store(true);
-  int workers = cpu_info.logical_cpu_count - 2;
-  workers = workers < 1 ? 1 : workers;
-  for (size_t i = 0; i < workers; i++)
-  {
-    std::thread* current = new std::thread(&ThreadPool::Workloop, std::ref(*this), i);
-    m_workerThreads.push_back(std::unique_ptr<std::thread>(current));
-#ifdef _WIN32
-    SetThreadPriority(current->native_handle(), THREAD_MODE_BACKGROUND_BEGIN);
-#endif
-  }
 }
 
 ThreadPool::~ThreadPool()
 {
-  m_working.store(false);
-  for (u32 i = 0; i < m_workerThreads.size(); i++)
-  {
-    std::thread* current = m_workerThreads[i].get();
-    if (current->joinable())
-    {
-      current->join();
-    }
-  };
 }
 
 ThreadPool& ThreadPool::Getinstance()
@@ -43,76 +23,41 @@ ThreadPool& ThreadPool::Getinstance()
 
 void ThreadPool::NotifyWorkPending()
 {
-  ThreadPool::Getinstance().m_workflag.fetch_add(2);
+  TaskScheduler::Submit(&ThreadPool::RunPendingTask, TaskPriority::Background);
 }
 
 void ThreadPool::RegisterWorker(IWorker* worker)
 {
   std::lock_guard<std::mutex> guard(m_workerLock);
-  ThreadPool& instance = ThreadPool::Getinstance();
-  size_t count = instance.m_workercount.fetch_add(1);
-  instance.m_workers[count] = worker;
+  ThreadPool::Getinstance().m_workers.push_back(worker);
 }
 
 void ThreadPool::UnregisterWorker(IWorker* worker)
 {
   std::lock_guard<std::mutex> guard(m_workerLock);
-  ThreadPool& instance = ThreadPool::Getinstance();
-  s32 count = instance.m_workercount.load();
-  s32 index = -1;
-  for (s32 i = 0; i < count; i++)
-  {
-    if (instance.m_workers[i] == worker)
-    {
-      index = i;
-      break;
-    }
-  }
-  if (index > -1 && index < count)
-  {
-    instance.m_workers[index] = instance.m_workers[count - 1];
-    instance.m_workercount.fetch_sub(1);
-  }
+  std::vector<IWorker*>& workers = ThreadPool::Getinstance().m_workers;
+  workers.erase(std::remove(workers.begin(), workers.end(), worker), workers.end());
 }
 
-void ThreadPool::Workloop(ThreadPool &state, size_t ID)
+size_t ThreadPool::GetThreadCount()
 {
-  u32 rest_time = 1;
-  while (state.m_working.load())
+  return TaskScheduler::GetWorkerCount();
+}
+
+// Each notification accounts for one unit of work from one of the registered workers.
+void ThreadPool::RunPendingTask()
+{
+  std::vector<IWorker*> workers;
   {
-    if (state.m_workflag.load() > ID)
-    {
-      bool worked = false;
-      u32 count = state.m_workercount.load();
-      for (u32 i = 0; i < count; i++)
-      {
-        IWorker* worker = state.m_workers[i];
-        if (worker)
-        {
-          if (worker->NextTask(ID))
-          {
-            worked = true;
-            state.m_workflag.fetch_sub(1);
-          }
-        }
-      }
-      if (worked)
-      {
-        Common::YieldCPU();
-        continue;
-      }
-      else if (state.m_workflag.load() > ID)
-      {
-        state.m_workflag.fetch_sub(1);
-      }
-      rest_time = 1;
-    }
-    else
-    {
-      rest_time++;
-      rest_time = rest_time > 5 ? 5 : rest_time;
-    }
-    SleepCurrentThread(rest_time);
+    std::lock_guard<std::mutex> guard(m_workerLock);
+    workers = ThreadPool::Getinstance().m_workers;
+  }
+  const int index = TaskScheduler::GetCurrentWorkerIndex();
+  const size_t ID = index < 0 ? 0 : static_cast<size_t>(index);
+  for (IWorker* worker : workers)
+  {
+    if (worker->NextTask(ID))
+      return;
   }
 }
 
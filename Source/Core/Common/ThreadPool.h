@@ -440,13 +440,9 @@ public:
 class ThreadPool
 {
 private:
-  std::vector<std::unique_ptr<std::thread>> m_workerThreads;
   std::vector<IWorker*> m_workers;
-  std::atomic<s32> m_workflag;
-  std::atomic<s32> m_workercount;
-  std::atomic<bool> m_working;
   static std::mutex m_workerLock;
-  static void Workloop(ThreadPool &state, size_t ID);
+  static void RunPendingTask();
   static ThreadPool &Getinstance();
   ThreadPool(ThreadPool const&);
   void operator=(ThreadPool const&);
@@ -456,9 +452,7 @@ public:
   static void NotifyWorkPending();
   static void RegisterWorker(IWorker* worker);
   static void UnregisterWorker(IWorker* worker);
-  static inline size_t GetThreadCount() {
-    return Getinstance().m_workerThreads.size();
-  }
+  static size_t GetThreadCount();
 };
 
 class AsyncWorker final : IWorker
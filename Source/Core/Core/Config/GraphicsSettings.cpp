@@ -46,8 +46,13 @@ const ConfigInfo<bool> GFX_CACHE_HIRES_TEXTURES{{System::GFX, "Settings", "Cache
 const ConfigInfo<bool> GFX_WAIT_CACHE_HIRES_TEXTURES{{System::GFX, "Settings", "WaitForCachedHiresTextures"},
                                                 false};
 const ConfigInfo<bool> GFX_DUMP_EFB_TARGET{{System::GFX, "Settings", "DumpEFBTarget"}, false};
+const ConfigInfo<int> GFX_DUMP_PNG_COMPRESSION_LEVEL{
+    {System::GFX, "Settings", "DumpPNGCompressionLevel"}, 6};
 const ConfigInfo<bool> GFX_DUMP_FRAMES_AS_IMAGES{{System::GFX, "Settings", "DumpFramesAsImages"},
                                                  false};
+const ConfigInfo<bool> GFX_DUMP_FRAMES_RAW{{System::GFX, "Settings", "DumpFramesRaw"}, false};
+const ConfigInfo<bool> GFX_DUMP_FRAMES_RAW_COMPRESSION{
+    {System::GFX, "Settings", "DumpFramesRawCompression"}, true};
 const ConfigInfo<bool> GFX_FREE_LOOK{{System::GFX, "Settings", "FreeLook"}, false};
 const ConfigInfo<bool> GFX_COMPILE_SHADERS_ON_STARTUP{ { System::GFX, "Settings", "CompileShaderOnStartup" }, true };
 const ConfigInfo<bool> GFX_USE_BLACK_FRAME_INSERTION{ {System::GFX, "Settings", "UseBlackFrameInsertion"}, false};
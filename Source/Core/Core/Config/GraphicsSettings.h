@@ -39,7 +39,10 @@ extern const ConfigInfo<bool> GFX_HIRES_MATERIAL_MAPS_BUILD;
 extern const ConfigInfo<bool> GFX_CACHE_HIRES_TEXTURES;
 extern const ConfigInfo<bool> GFX_WAIT_CACHE_HIRES_TEXTURES;
 extern const ConfigInfo<bool> GFX_DUMP_EFB_TARGET;
+extern const ConfigInfo<int> GFX_DUMP_PNG_COMPRESSION_LEVEL;
 extern const ConfigInfo<bool> GFX_DUMP_FRAMES_AS_IMAGES;
+extern const ConfigInfo<bool> GFX_DUMP_FRAMES_RAW;
+extern const ConfigInfo<bool> GFX_DUMP_FRAMES_RAW_COMPRESSION;
 extern const ConfigInfo<bool> GFX_FREE_LOOK;
 extern const ConfigInfo<bool> GFX_COMPILE_SHADERS_ON_STARTUP;
 extern const ConfigInfo<bool> GFX_USE_BLACK_FRAME_INSERTION;
@@ -48,7 +48,10 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_CACHE_HIRES_TEXTURES.location,
       Config::GFX_WAIT_CACHE_HIRES_TEXTURES.location,
       Config::GFX_DUMP_EFB_TARGET.location,
+      Config::GFX_DUMP_PNG_COMPRESSION_LEVEL.location,
       Config::GFX_DUMP_FRAMES_AS_IMAGES.location,
+      Config::GFX_DUMP_FRAMES_RAW.location,
+      Config::GFX_DUMP_FRAMES_RAW_COMPRESSION.location,
       Config::GFX_FREE_LOOK.location,
       Config::GFX_COMPILE_SHADERS_ON_STARTUP.location,
       Config::GFX_USE_FFV1.location,
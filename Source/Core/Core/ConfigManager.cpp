@@ -239,6 +239,9 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("TimingVariance", iTimingVariance);
   core->Set("CPUCore", iCPUCore);
   core->Set("Fastmem", bFastmem);
+  core->Set("JITTraces", bJITTraces);
+  core->Set("JITRegisterBinding", bJITRegisterBinding);
+  core->Set("JITBackgroundCompile", bJITBackgroundCompile);
   core->Set("CPUThread", bCPUThread);
   core->Set("DSPHLE", bDSPHLE);
   core->Set("SyncOnSkipIdle", bSyncGPUOnSkipIdleHack);
@@ -537,6 +540,9 @@ void SConfig::LoadCoreSettings(IniFile& ini)
   core->Get("CPUCore", &iCPUCore, PowerPC::CORE_INTERPRETER);
 #endif
   core->Get("Fastmem", &bFastmem, true);
+  core->Get("JITTraces", &bJITTraces, true);
+  core->Get("JITRegisterBinding", &bJITRegisterBinding, true);
+  core->Get("JITBackgroundCompile", &bJITBackgroundCompile, true);
   core->Get("DSPHLE", &bDSPHLE, true);
   core->Get("TimingVariance", &iTimingVariance, 40);
   core->Get("CPUThread", &bCPUThread, true);
@@ -795,6 +801,9 @@ void SConfig::LoadDefaults()
   bRunCompareServer = false;
   bDSPHLE = true;
   bFastmem = true;
+  bJITTraces = true;
+  bJITRegisterBinding = true;
+  bJITBackgroundCompile = true;
   bFPRF = false;
   bAccurateNaNs = false;
 #ifdef _M_X86_64
@@ -78,6 +78,12 @@ struct SConfig
 
   bool bJITNoBlockCache = false;
   bool bJITNoBlockLinking = false;
+  // Recompile hot blocks as traces that follow their usually taken branches
+  bool bJITTraces = true;
+  // Keep the hot GPRs of loops in host registers across the links back to their start
+  bool bJITRegisterBinding = true;
+  // Run cold code through the cached interpreter and compile hot blocks on another thread
+  bool bJITBackgroundCompile = true;
   bool bJITOff = false;
   bool bJITLoadStoreOff = false;
   bool bJITLoadStorelXzOff = false;
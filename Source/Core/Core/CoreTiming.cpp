@@ -5,16 +5,19 @@
 #include "Core/CoreTiming.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cinttypes>
-#include <mutex>
+#include <iterator>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "Common/Assert.h"
+#include "Common/BitHelpers.h"
 #include "Common/ChunkFile.h"
 #include "Common/Logging/Log.h"
-#include "Common/SPSCQueue.h"
+#include "Common/MPSCQueue.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 
@@ -31,6 +34,10 @@ struct EventType
 {
   TimedCallback callback;
   const std::string* name;
+  // Bumped by RemoveEvent to cancel the events of this type that are in the queue
+  u32 generation;
+  // Events in the queue that haven't been cancelled
+  u32 pending;
 };
 
 struct Event
@@ -39,6 +46,8 @@ struct Event
   u64 fifo_order;
   u64 userdata;
   EventType* type;
+  // The generation of the type when the event was queued
+  u32 generation;
 };
 
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
@@ -56,19 +65,49 @@ static bool operator<(const Event& left, const Event& right)
 static std::unordered_map<std::string, EventType> s_event_types;
 
 // STATE_TO_SAVE
-// The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-// We don't use std::priority_queue because we need to be able to serialize, unserialize and
-// erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
-// by the standard adaptor class.
-static std::vector<Event> s_event_queue;
+// The queue is a timing wheel. The near future is split into WHEEL_SIZE buckets of
+// 2^BUCKET_SHIFT cycles each, starting with the bucket of s_wheel_base, which covers the
+// global timer. Most events, like VI, SI polling, DSP and audio DMA, are due within the wheel and
+// go into their bucket, which rarely holds more than one event, so scheduling them and finding
+// the next one hardly depends on how many events are queued.
+// Events beyond the wheel go into s_far_events. They are compared with the first bucket when
+// looking for the next event, so they don't have to be moved into the wheel as it turns.
+//
+// The buckets and s_far_events are min-heaps using std::make_heap/push_heap/pop_heap, ordered
+// by time and then by the order the events were added, so events run in the same order as from
+// a single heap. We don't use std::priority_queue because we need to be able to serialize,
+// unserialize and erase arbitrary events (CompactEventQueue()) regardless of the queue order.
+// These aren't accomodated by the standard adaptor class.
+//
+// RemoveEvent() doesn't search the queue. It cancels the events of a type by bumping its
+// generation, and the cancelled events are dropped when they reach the front of the queue, or
+// all at once when they make up half of it.
+// 64 cycle buckets, covering the next 65536 cycles
+static constexpr int BUCKET_SHIFT = 6;
+static constexpr u32 WHEEL_SIZE = 1024;
+static std::array<std::vector<Event>, WHEEL_SIZE> s_wheel;
+// A bit for each bucket that isn't empty
+static std::array<u64, WHEEL_SIZE / 64> s_wheel_occupied;
+// The bucket number (time >> BUCKET_SHIFT) of the first bucket of the wheel
+static s64 s_wheel_base;
+static std::vector<Event> s_far_events;
+// Including the cancelled ones
+static size_t s_event_count;
 static u64 s_event_fifo_id;
-static std::mutex s_ts_write_lock;
-static Common::SPSCQueue<Event, false> s_ts_queue;
+static u32 s_cancelled_events;
+// Events scheduled from other threads, moved into the queue by the CPU thread
+static Common::MPSCQueue<Event> s_ts_queue;
 
 static float s_last_OC_factor;
 static constexpr int MAX_SLICE_LENGTH = 20000;
 
 static s64 s_idled_cycles;
+// Not saved in states, only reported at shutdown
+static u64 s_idle_skips;
+static u64 s_events_scheduled;
+static std::atomic<u64> s_events_scheduled_from_threads;
+static u64 s_events_run;
+static u64 s_events_removed;
 static u32 s_fake_dec_start_value;
 static u64 s_fake_dec_start_ticks;
 
@@ -109,7 +148,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
                "during Init to avoid breaking save states.",
                name.c_str());
 
-  auto info = s_event_types.emplace(name, EventType{callback, nullptr});
+  auto info = s_event_types.emplace(name, EventType{callback, nullptr, 0, 0});
   EventType* event_type = &info.first->second;
   event_type->name = &info.first->first;
   return event_type;
@@ -117,7 +156,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-  ASSERT_MSG(POWERPC, s_event_queue.empty(), "Cannot unregister events with events pending");
+  ASSERT_MSG(POWERPC, s_event_count == 0, "Cannot unregister events with events pending");
   s_event_types.clear();
 }
 
@@ -128,7 +167,13 @@ void Init()
   PowerPC::ppcState.downcount = CyclesToDowncount(MAX_SLICE_LENGTH);
   g.slice_length = MAX_SLICE_LENGTH;
   g.global_timer = 0;
+  s_wheel_base = 0;
   s_idled_cycles = 0;
+  s_idle_skips = 0;
+  s_events_scheduled = 0;
+  s_events_scheduled_from_threads = 0;
+  s_events_run = 0;
+  s_events_removed = 0;
 
   // The time between CoreTiming being intialized and the first call to Advance() is considered
   // the slice boundary between slice -1 and slice 0. Dispatcher loops must call Advance() before
@@ -142,15 +187,178 @@ void Init()
 
 void Shutdown()
 {
-  std::lock_guard<std::mutex> lk(s_ts_write_lock);
+  if (s_idle_skips)
+  {
+    INFO_LOG(POWERPC, "Idle skipping: %" PRIu64 " cycles skipped in %" PRIu64 " idle loops",
+             static_cast<u64>(s_idled_cycles), s_idle_skips);
+  }
+
+  const u64 events_scheduled_from_threads = s_events_scheduled_from_threads.load();
+  INFO_LOG(POWERPC,
+           "Events: %" PRIu64 " scheduled, %" PRIu64 " of them from other threads, %" PRIu64
+           " run, %" PRIu64 " removed",
+           s_events_scheduled + events_scheduled_from_threads, events_scheduled_from_threads,
+           s_events_run, s_events_removed);
+
   MoveEvents();
   ClearPendingEvents();
   UnregisterAllEvents();
 }
 
+static bool IsCancelled(const Event& ev)
+{
+  return ev.generation != ev.type->generation;
+}
+
+static void PushEvent(Event&& ev)
+{
+  ev.generation = ev.type->generation;
+  ev.type->pending++;
+  s_event_count++;
+
+  // Events in the past go into the first bucket, where they still come first
+  const s64 bucket = std::max(ev.time >> BUCKET_SHIFT, s_wheel_base);
+  if (bucket - s_wheel_base >= WHEEL_SIZE)
+  {
+    s_far_events.emplace_back(std::move(ev));
+    std::push_heap(s_far_events.begin(), s_far_events.end(), std::greater<Event>());
+    return;
+  }
+
+  const u32 slot = static_cast<u32>(bucket) & (WHEEL_SIZE - 1);
+  s_wheel[slot].emplace_back(std::move(ev));
+  std::push_heap(s_wheel[slot].begin(), s_wheel[slot].end(), std::greater<Event>());
+  s_wheel_occupied[slot / 64] |= 1ULL << (slot % 64);
+}
+
+// Returns the slot of the first bucket that isn't empty, or WHEEL_SIZE
+static u32 FindFirstBucket()
+{
+  const u32 first_slot = static_cast<u32>(s_wheel_base) & (WHEEL_SIZE - 1);
+  const u32 first_word = first_slot / 64;
+
+  // From the first bucket to the end of the array, then from the start of the array
+  u64 bits = s_wheel_occupied[first_word] & (~0ULL << (first_slot % 64));
+  if (bits)
+    return first_word * 64 + LeastSignificantSetBit(bits);
+  for (u32 i = 1; i <= s_wheel_occupied.size(); i++)
+  {
+    const u32 word = (first_word + i) % s_wheel_occupied.size();
+    bits = s_wheel_occupied[word];
+    if (word == first_word)
+      bits &= (1ULL << (first_slot % 64)) - 1;
+    if (bits)
+      return word * 64 + LeastSignificantSetBit(bits);
+  }
+  return WHEEL_SIZE;
+}
+
+// Returns the heap holding the next event, or nullptr if there are no events
+static std::vector<Event>* GetNextEventHeap()
+{
+  const u32 slot = FindFirstBucket();
+  if (slot == WHEEL_SIZE)
+    return s_far_events.empty() ? nullptr : &s_far_events;
+  if (!s_far_events.empty() && s_far_events.front() < s_wheel[slot].front())
+    return &s_far_events;
+  return &s_wheel[slot];
+}
+
+static Event PopEvent(std::vector<Event>& heap)
+{
+  Event ev = std::move(heap.front());
+  std::pop_heap(heap.begin(), heap.end(), std::greater<Event>());
+  heap.pop_back();
+  if (heap.empty() && &heap != &s_far_events)
+  {
+    const size_t slot = &heap - s_wheel.data();
+    s_wheel_occupied[slot / 64] &= ~(1ULL << (slot % 64));
+  }
+
+  s_event_count--;
+  if (IsCancelled(ev))
+    s_cancelled_events--;
+  else
+    ev.type->pending--;
+  return ev;
+}
+
+// Drops the cancelled events from the front of the queue, and returns the heap holding the next
+// event, or nullptr if there are no events
+static std::vector<Event>* PeekEvent()
+{
+  while (std::vector<Event>* heap = GetNextEventHeap())
+  {
+    if (!IsCancelled(heap->front()))
+      return heap;
+    PopEvent(*heap);
+  }
+  return nullptr;
+}
+
+static void CompactHeap(std::vector<Event>& heap)
+{
+  auto itr = std::remove_if(heap.begin(), heap.end(), IsCancelled);
+  s_event_count -= heap.end() - itr;
+  heap.erase(itr, heap.end());
+  // Removing random items breaks the invariant so we have to re-establish it.
+  std::make_heap(heap.begin(), heap.end(), std::greater<Event>());
+}
+
+static void CompactEventQueue()
+{
+  if (!s_cancelled_events)
+    return;
+
+  for (u32 slot = 0; slot < WHEEL_SIZE; slot++)
+  {
+    if (!(s_wheel_occupied[slot / 64] & (1ULL << (slot % 64))))
+      continue;
+    CompactHeap(s_wheel[slot]);
+    if (s_wheel[slot].empty())
+      s_wheel_occupied[slot / 64] &= ~(1ULL << (slot % 64));
+  }
+  CompactHeap(s_far_events);
+  s_cancelled_events = 0;
+}
+
+// Returns copies of all of the events that haven't been cancelled, in no particular order
+static std::vector<Event> GetQueuedEvents()
+{
+  std::vector<Event> events;
+  events.reserve(s_event_count);
+  for (const std::vector<Event>& bucket : s_wheel)
+  {
+    std::copy_if(bucket.begin(), bucket.end(), std::back_inserter(events),
+                 [](const Event& ev) { return !IsCancelled(ev); });
+  }
+  std::copy_if(s_far_events.begin(), s_far_events.end(), std::back_inserter(events),
+               [](const Event& ev) { return !IsCancelled(ev); });
+  return events;
+}
+
+// Runs the events that are due, in order, and returns the heap holding the next event
+static std::vector<Event>* RunEvents()
+{
+  std::vector<Event>* heap;
+  while ((heap = PeekEvent()) != nullptr)
+  {
+    if (heap->front().time > g.global_timer)
+      break;
+    Event evt = PopEvent(*heap);
+    // NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
+    //            g.global_timer, evt.time);
+    s_events_run++;
+    evt.type->callback(evt.userdata, g.global_timer - evt.time);
+  }
+
+  // Everything before the bucket of the global timer has run, so the wheel can turn to it
+  s_wheel_base = std::max(s_wheel_base, g.global_timer >> BUCKET_SHIFT);
+  return heap;
+}
+
 void DoState(PointerWrap& p)
 {
-  std::lock_guard<std::mutex> lk(s_ts_write_lock);
   p.Do(g.slice_length);
   p.Do(g.global_timer);
   p.Do(s_idled_cycles);
@@ -165,7 +373,8 @@ void DoState(PointerWrap& p)
   p.DoMarker("CoreTimingData");
 
   MoveEvents();
-  p.DoEachElement(s_event_queue, [](PointerWrap& pw, Event& ev) {
+  std::vector<Event> events = GetQueuedEvents();
+  p.DoEachElement(events, [](PointerWrap& pw, Event& ev) {
     pw.Do(ev.time);
     pw.Do(ev.fifo_order);
 
@@ -202,7 +411,12 @@ void DoState(PointerWrap& p)
   // The exact layout of the heap in memory is implementation defined, therefore it is platform
   // and library version specific.
   if (p.GetMode() == PointerWrap::MODE_READ)
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+  {
+    ClearPendingEvents();
+    s_wheel_base = g.global_timer >> BUCKET_SHIFT;
+    for (Event& ev : events)
+      PushEvent(std::move(ev));
+  }
 }
 
 // This should only be called from the CPU thread. If you are calling
@@ -225,7 +439,14 @@ u64 GetIdleTicks()
 
 void ClearPendingEvents()
 {
-  s_event_queue.clear();
+  for (std::vector<Event>& bucket : s_wheel)
+    bucket.clear();
+  s_wheel_occupied.fill(0);
+  s_far_events.clear();
+  s_event_count = 0;
+  s_cancelled_events = 0;
+  for (auto& event_type : s_event_types)
+    event_type.second.pending = 0;
 }
 
 void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata, FromThread from)
@@ -253,8 +474,8 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
     if (!s_is_global_timer_sane)
       ForceExceptionCheck(cycles_into_future);
 
-    s_event_queue.emplace_back(Event{timeout, s_event_fifo_id++, userdata, event_type});
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    PushEvent(Event{timeout, s_event_fifo_id++, userdata, event_type, 0});
+    s_events_scheduled++;
   }
   else
   {
@@ -265,22 +486,23 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
                 event_type->name->c_str());
     }
 
-    std::lock_guard<std::mutex> lk(s_ts_write_lock);
-    s_ts_queue.Push(Event{g.global_timer + cycles_into_future, 0, userdata, event_type});
+    s_ts_queue.Push(Event{g.global_timer + cycles_into_future, 0, userdata, event_type, 0});
+    s_events_scheduled_from_threads.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
 void RemoveEvent(EventType* event_type)
 {
-  auto itr = std::remove_if(s_event_queue.begin(), s_event_queue.end(),
-                            [&](const Event& e) { return e.type == event_type; });
+  if (!event_type->pending)
+    return;
 
-  // Removing random items breaks the invariant so we have to re-establish it.
-  if (itr != s_event_queue.end())
-  {
-    s_event_queue.erase(itr, s_event_queue.end());
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-  }
+  s_events_removed += event_type->pending;
+  s_cancelled_events += event_type->pending;
+  event_type->pending = 0;
+  event_type->generation++;
+
+  if (s_cancelled_events * 2 > s_event_count)
+    CompactEventQueue();
 }
 
 void RemoveAllEvents(EventType* event_type)
@@ -293,15 +515,7 @@ void RemoveAllEvents(EventType* event_type)
 void ProcessFifoWaitEvents()
 {
   MoveEvents();
-  while (!s_event_queue.empty() && s_event_queue.front().time <= g.global_timer)
-  {
-    Event evt = std::move(s_event_queue.front());
-    std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-    s_event_queue.pop_back();
-    // NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
-    //            g.global_timer, evt.time);
-    evt.type->callback(evt.userdata, g.global_timer - evt.time);
-  }
+  RunEvents();
 }
 
 void ForceExceptionCheck(s64 cycles)
@@ -321,8 +535,7 @@ void MoveEvents()
   for (Event ev; s_ts_queue.Pop(ev);)
   {
     ev.fifo_order = s_event_fifo_id++;
-    s_event_queue.emplace_back(std::move(ev));
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    PushEvent(std::move(ev));
   }
 }
 
@@ -338,23 +551,15 @@ void Advance()
 
   s_is_global_timer_sane = true;
 
-  while (!s_event_queue.empty() && s_event_queue.front().time <= g.global_timer)
-  {
-    Event evt = std::move(s_event_queue.front());
-    std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-    s_event_queue.pop_back();
-    // NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
-    //            g.global_timer, evt.time);
-    evt.type->callback(evt.userdata, g.global_timer - evt.time);
-  }
+  const std::vector<Event>* heap = RunEvents();
 
   s_is_global_timer_sane = false;
 
   // Still events left (scheduled in the future)
-  if (!s_event_queue.empty())
+  if (heap)
   {
     g.slice_length = static_cast<int>(
-        std::min<s64>(s_event_queue.front().time - g.global_timer, MAX_SLICE_LENGTH));
+        std::min<s64>(heap->front().time - g.global_timer, MAX_SLICE_LENGTH));
   }
 
   PowerPC::ppcState.downcount = CyclesToDowncount(g.slice_length);
@@ -368,7 +573,7 @@ void Advance()
 
 void LogPendingEvents()
 {
-  auto clone = s_event_queue;
+  auto clone = GetQueuedEvents();
   std::sort(clone.begin(), clone.end());
   for (const Event& ev : clone)
   {
@@ -380,10 +585,14 @@ void LogPendingEvents()
 // Should only be called from the CPU thread after the PPC clock has changed
 void AdjustEventQueueTimes(u32 new_ppc_clock, u32 old_ppc_clock)
 {
-  for (Event& ev : s_event_queue)
+  // The events may end up in other buckets
+  std::vector<Event> events = GetQueuedEvents();
+  ClearPendingEvents();
+  for (Event& ev : events)
   {
     const s64 ticks = (ev.time - g.global_timer) * new_ppc_clock / old_ppc_clock;
     ev.time = g.global_timer + ticks;
+    PushEvent(std::move(ev));
   }
 }
 
@@ -398,6 +607,7 @@ void Idle()
   }
 
   s_idled_cycles += DowncountToCycles(PowerPC::ppcState.downcount);
+  s_idle_skips++;
   PowerPC::ppcState.downcount = 0;
 }
 
@@ -406,7 +616,7 @@ std::string GetScheduledEventsSummary()
   std::string text = "Scheduled events\n";
   text.reserve(1000);
 
-  auto clone = s_event_queue;
+  auto clone = GetQueuedEvents();
   std::sort(clone.begin(), clone.end());
   for (const Event& ev : clone)
   {
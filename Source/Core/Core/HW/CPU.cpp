@@ -13,6 +13,7 @@
 #include "Core/Core.h"
 #include "Core/Host.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/SamplingProfiler.h"
 #include "VideoCommon/Fifo.h"
 
 namespace CPU
@@ -99,7 +100,9 @@ void Run()
       }
 
       // Enter a fast runloop
+      SamplingProfiler::RegisterCPUThread();
       PowerPC::RunLoop();
+      SamplingProfiler::UnregisterCPUThread();
 
       state_lock.lock();
       s_state_cpu_thread_active = false;
@@ -79,13 +79,16 @@ const u8* CachedInterpreter::GetCodePtr() const
 }
 
 void CachedInterpreter::ExecuteOneBlock()
+{
+  if (!RunBlock())
+    Jit(PC);
+}
+
+bool CachedInterpreter::RunBlock()
 {
   const u8* normal_entry = m_block_cache.Dispatch();
   if (!normal_entry)
-  {
-    Jit(PC);
-    return;
-  }
+    return false;
 
   const Instruction* code = reinterpret_cast<const Instruction*>(normal_entry);
 
@@ -99,7 +102,7 @@ void CachedInterpreter::ExecuteOneBlock()
 
     case Instruction::Type::Conditional:
       if (code->conditional_callback(code->data))
-        return;
+        return true;
       break;
 
     default:
@@ -107,6 +110,7 @@ void CachedInterpreter::ExecuteOneBlock()
       break;
     }
   }
+  return true;
 }
 
 void CachedInterpreter::Run()
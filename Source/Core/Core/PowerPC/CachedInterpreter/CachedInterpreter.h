@@ -28,6 +28,9 @@ public:
 
   void Jit(u32 address) override;
 
+  // Runs the block at PC. Returns false without running anything if it hasn't been compiled.
+  bool RunBlock();
+
   JitBaseBlockCache* GetBlockCache() override { return &m_block_cache; }
   const char* GetName() const override { return "Cached Interpreter"; }
   const CommonAsmRoutinesBase* GetAsmRoutines() override { return nullptr; }
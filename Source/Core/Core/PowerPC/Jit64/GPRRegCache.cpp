@@ -46,6 +46,14 @@ const X64Reg* GPRRegCache::GetAllocationOrder(size_t* count)
   return allocation_order;
 }
 
+// The first registers of the allocation order are callee saved, so the ABI calls at block exits
+// and entries leave them alone.
+X64Reg GPRRegCache::GetBoundXReg(size_t index)
+{
+  size_t count;
+  return GetAllocationOrder(&count)[index];
+}
+
 void GPRRegCache::SetImmediate32(size_t preg, u32 imm_value, bool dirty)
 {
   // "dirty" can be false to avoid redundantly flushing an immediate when
@@ -11,6 +11,9 @@ class Jit64;
 class GPRRegCache final : public RegCache
 {
 public:
+  // The most GPRs that linked blocks hand over in host registers
+  static constexpr size_t MAX_BOUND_REGISTERS = 4;
+
   explicit GPRRegCache(Jit64& jit);
 
   void StoreRegister(size_t preg, const Gen::OpArg& new_loc) override;
@@ -20,4 +23,7 @@ public:
   void SetImmediate32(size_t preg, u32 imm_value, bool dirty = true);
   BitSet32 GetRegUtilization() override;
   BitSet32 CountRegsIn(size_t preg, u32 lookahead) override;
+
+  // The host register of the GPR at the given position in a register binding.
+  Gen::X64Reg GetBoundXReg(size_t index);
 };
@@ -4,6 +4,8 @@
 
 #include "Core/PowerPC/Jit64/Jit.h"
 
+#include <algorithm>
+#include <iterator>
 #include <map>
 #include <string>
 
@@ -18,6 +20,7 @@
 #include "Common/MemoryUtil.h"
 #include "Common/PerformanceCounter.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 #include "Common/x64ABI.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -26,6 +29,7 @@
 #include "Core/HW/GPFifo.h"
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/PatchEngine.h"
+#include "Core/PowerPC/Gekko.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/FarCodeCache.h"
@@ -213,6 +217,10 @@ void Jit64::Init()
   InitializeInstructionTables();
   EnableBlockLink();
 
+  // Breakpoints and single stepping need every block compiled as it is reached
+  m_background_compile = SConfig::GetInstance().bJITBackgroundCompile &&
+                         !SConfig::GetInstance().bEnableDebugging;
+
   jo.optimizeGatherPipe = true;
   jo.accurateSinglePrecision = true;
   UpdateMemoryOptions();
@@ -255,10 +263,22 @@ void Jit64::Init()
   code_block.m_gpa = &js.gpa;
   code_block.m_fpa = &js.fpa;
   EnableOptimization();
+
+  // Loaded on the first miss, as the boot only sets the game ID after the JIT is initialized
+  m_analysis_cache_game_id.clear();
+  m_warm_start_pending = false;
+
+  if (m_background_compile)
+  {
+    m_interpreter_tier.Init();
+    m_compile_thread_exit = false;
+    m_compile_thread = std::thread(&Jit64::CompileThread, this);
+  }
 }
 
 void Jit64::ClearCache()
 {
+  m_analysis_cache.Record(*this);
   blocks.Clear();
   trampolines.ClearCodeSpace();
   m_far_code.ClearCodeSpace();
@@ -266,10 +286,94 @@ void Jit64::ClearCache()
   ClearCodeSpace();
   Clear();
   UpdateMemoryOptions();
+  m_register_bindings.clear();
+  m_dbat_snapshot.reset();
+  // Blocks are promoted to traces again as they turn hot
+  js.traceAddresses.clear();
+  js.likelyTakenBranches.clear();
+
+  if (m_background_compile)
+  {
+    // The valid block bits that made invalidations of the interpreted code reach us are gone
+    m_interpreter_tier.ClearCache();
+    DropCompileRequests();
+  }
+}
+
+void Jit64::ClearSafe()
+{
+  m_analysis_cache.Record(*this);
+  blocks.Clear();
+  m_register_bindings.clear();
+  // Called when the BATs change
+  m_dbat_snapshot.reset();
+  js.traceAddresses.clear();
+  js.likelyTakenBranches.clear();
+
+  if (m_background_compile)
+  {
+    m_interpreter_tier.ClearSafe();
+    DropCompileRequests();
+  }
+}
+
+void Jit64::InvalidateICache(u32 address, u32 length, bool forced)
+{
+  blocks.InvalidateICache(address, length, forced);
+
+  // The code may be different now, and has to turn hot again to become a trace
+  const auto in_range = [address, length](u32 a) { return a - address < length; };
+  for (std::unordered_set<u32>* addresses : {&js.traceAddresses, &js.likelyTakenBranches})
+  {
+    for (auto it = addresses->begin(); it != addresses->end();)
+      it = in_range(*it) ? addresses->erase(it) : std::next(it);
+  }
+
+  if (!m_background_compile)
+    return;
+
+  m_interpreter_tier.InvalidateICache(address, length, forced);
+
+  // Requests for the code would compile what it was before
+  auto translated = PowerPC::JitCache_TranslateAddress(address);
+  if (!translated.valid)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_compile_wakeup_lock);
+  auto it = m_compile_requests.begin();
+  while (it != m_compile_requests.end())
+  {
+    if (it->code_block.m_physical_addresses.lower_bound(translated.address) !=
+        it->code_block.m_physical_addresses.lower_bound(translated.address + length))
+    {
+      m_cold_block_runs.erase(it->address);
+      it = m_compile_requests.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
 }
 
 void Jit64::Shutdown()
 {
+  if (m_background_compile)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_compile_wakeup_lock);
+      m_compile_thread_exit = true;
+    }
+    m_compile_wakeup.notify_one();
+    m_compile_thread.join();
+    m_compile_requests.clear();
+    m_cold_block_runs.clear();
+    m_interpreter_tier.Shutdown();
+  }
+
+  m_analysis_cache.Record(*this);
+  m_analysis_cache.Save();
+
   FreeStack();
   FreeCodeSpace();
 
@@ -396,6 +500,17 @@ bool Jit64::Cleanup()
   return did_something;
 }
 
+void Jit64::ProfileBranchTaken(u32 branch_address)
+{
+  JitBlock* b = js.curBlock;
+  if (!js.profileForTrace || b->branch_profiles.size() == b->branch_profiles.capacity())
+    return;
+
+  b->branch_profiles.push_back({branch_address, 0});
+  MOV(64, R(RSCRATCH), ImmPtr(&b->branch_profiles.back().taken));
+  ADD(32, MatR(RSCRATCH), Imm8(1));
+}
+
 void Jit64::FakeBLCall(u32 after)
 {
   if (!m_enable_blr_optimization)
@@ -416,6 +531,11 @@ void Jit64::WriteExit(u32 destination, bool bl, u32 after)
   if (!m_enable_blr_optimization)
     bl = false;
 
+  // The bound registers are callee saved, so they survive the calls in Cleanup()
+  const BitSet32 binding = bl ? BitSet32() : GetRegisterBinding(destination);
+  if (binding)
+    MoveToBoundRegisters(binding);
+
   Cleanup();
 
   if (bl)
@@ -426,7 +546,10 @@ void Jit64::WriteExit(u32 destination, bool bl, u32 after)
 
   SUB(32, PPCSTATE(downcount), Imm32(js.downcountAmount));
 
-  JustWriteExit(destination, bl, after);
+  if (binding)
+    JustWriteBoundExit(destination, binding);
+  else
+    JustWriteExit(destination, bl, after);
 }
 
 void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
@@ -453,6 +576,149 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
   }
 }
 
+void Jit64::JustWriteBoundExit(u32 destination, BitSet32 binding)
+{
+  JitBlock::LinkData linkData;
+  linkData.exitAddress = destination;
+  linkData.linkStatus = false;
+  linkData.registerBinding = binding.m_val;
+
+  // Until the exit is linked to a block with the same binding, it falls through to storing the
+  // bound registers and a regular exit.
+  linkData.exitPtrs = GetWritableCodePtr();
+  FixupBranch fallback = J(true);
+  SetJumpTarget(fallback);
+  linkData.fallback = GetCodePtr();
+  js.curBlock->linkData.push_back(linkData);
+
+  StoreBoundRegisters(binding);
+  JustWriteExit(destination, false, 0);
+}
+
+BitSet32 Jit64::GetRegisterBinding(u32 address) const
+{
+  auto it = m_register_bindings.find(address);
+  return it != m_register_bindings.end() ? it->second : BitSet32();
+}
+
+BitSet32 Jit64::GetBranchRegisterBinding(const PPCAnalyst::CodeOp& op) const
+{
+  // Idle loops exit to the dispatcher
+  if (op.inst.LK || op.branchIsIdleLoop)
+    return BitSet32();
+
+  if (op.inst.OPCD == 18)  // bx
+  {
+    const u32 offset = SignExt26(op.inst.LI << 2);
+    return GetRegisterBinding(op.inst.AA ? offset : op.address + offset);
+  }
+  if (op.inst.OPCD == 16)  // bcx
+  {
+    const u32 offset = SignExt16(op.inst.BD << 2);
+    return GetRegisterBinding(op.inst.AA ? offset : op.address + offset);
+  }
+  return BitSet32();
+}
+
+// Hot loops keep their counters and base pointers in host registers from one iteration to the
+// next. A block that branches back to its own start binds the GPRs it reads on entry and uses
+// the most, so its exits to itself neither store nor reload them.
+BitSet32 Jit64::ComputeRegisterBinding(u32 em_address, const PPCAnalyst::CodeOp* ops) const
+{
+  if (!jo.enableBlocklink || !SConfig::GetInstance().bJITRegisterBinding)
+    return BitSet32();
+
+  bool loops = false;
+  std::array<u32, 32> uses{};
+  for (u32 i = 0; i < code_block.m_num_instructions; i++)
+  {
+    const PPCAnalyst::CodeOp& op = ops[i];
+    for (int reg : op.regsIn)
+      uses[reg]++;
+    for (int reg : op.regsOut)
+      uses[reg]++;
+
+    // Branches that the block follows don't leave it, and idle loops go through the dispatcher
+    if (op.skip || op.branchFollowed || op.branchIsIdleLoop || op.inst.LK || op.inst.AA)
+      continue;
+    if (op.inst.OPCD == 18)
+      loops |= op.address + SignExt26(op.inst.LI << 2) == em_address;
+    else if (op.inst.OPCD == 16)
+      loops |= op.address + SignExt16(op.inst.BD << 2) == em_address;
+  }
+  if (!loops)
+    return BitSet32();
+
+  BitSet32 binding;
+  for (size_t n = 0; n < GPRRegCache::MAX_BOUND_REGISTERS; n++)
+  {
+    int best = -1;
+    for (int reg : code_block.m_gpr_inputs & ~binding)
+    {
+      if (uses[reg] >= 2 && (best < 0 || uses[reg] > uses[best]))
+        best = reg;
+    }
+    if (best < 0)
+      break;
+    binding[best] = true;
+  }
+  return binding;
+}
+
+void Jit64::MoveToBoundRegisters(BitSet32 binding)
+{
+  struct Move
+  {
+    X64Reg dest;
+    OpArg src;
+  };
+  std::vector<Move> moves;
+  size_t index = 0;
+  for (int reg : binding)
+  {
+    const X64Reg xreg = gpr.GetBoundXReg(index++);
+    if (!gpr.R(reg).IsSimpleReg(xreg))
+      moves.push_back({xreg, gpr.R(reg)});
+  }
+
+  while (!moves.empty())
+  {
+    // A move can be done once no other move reads its destination
+    auto move = std::find_if(moves.begin(), moves.end(), [&moves](const Move& m) {
+      return std::none_of(moves.begin(), moves.end(),
+                          [&m](const Move& other) { return other.src.IsSimpleReg(m.dest); });
+    });
+    if (move == moves.end())
+    {
+      // Only cycles are left. Break one up by moving a destination out of the way.
+      const X64Reg blocked = moves.front().dest;
+      MOV(32, R(RSCRATCH), R(blocked));
+      for (Move& m : moves)
+      {
+        if (m.src.IsSimpleReg(blocked))
+          m.src = R(RSCRATCH);
+      }
+      continue;
+    }
+    MOV(32, R(move->dest), move->src);
+    moves.erase(move);
+  }
+}
+
+void Jit64::LoadBoundRegisters(BitSet32 binding)
+{
+  size_t index = 0;
+  for (int reg : binding)
+    MOV(32, R(gpr.GetBoundXReg(index++)), PPCSTATE(gpr[reg]));
+}
+
+void Jit64::StoreBoundRegisters(BitSet32 binding)
+{
+  size_t index = 0;
+  for (int reg : binding)
+    MOV(32, PPCSTATE(gpr[reg]), R(gpr.GetBoundXReg(index++)));
+}
+
 void Jit64::WriteExitDestInRSCRATCH(bool bl, u32 after)
 {
   if (!m_enable_blr_optimization)
@@ -521,6 +787,15 @@ void Jit64::WriteExceptionExit()
   JMP(asm_routines.dispatcher, true);
 }
 
+void Jit64::WriteIdleExit(u32 destination)
+{
+  ABI_PushRegistersAndAdjustStack({}, 0);
+  ABI_CallFunction(CoreTiming::Idle);
+  ABI_PopRegistersAndAdjustStack({}, 0);
+  MOV(32, PPCSTATE(pc), Imm32(destination));
+  WriteExceptionExit();
+}
+
 void Jit64::WriteExternalExceptionExit()
 {
   Cleanup();
@@ -570,6 +845,102 @@ void Jit64::Trace()
 }
 
 void Jit64::Jit(u32 em_address)
+{
+  if (m_background_compile)
+  {
+    RunColdBlock(em_address);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_cache_lock);
+  ClearCacheIfNeeded();
+
+  LoadAnalysisCacheIfNeeded();
+  if (m_warm_start_pending)
+  {
+    CompileHotBlocks();
+    if (blocks.GetBlockFromStartAddress(em_address, MSR))
+      return;
+  }
+
+  u32 nextPC = AnalyzeBlock(em_address);
+  if (code_block.m_memory_exception)
+  {
+    // Address of instruction could not be translated
+    NPC = nextPC;
+    PowerPC::ppcState.Exceptions |= EXCEPTION_ISI;
+    PowerPC::CheckExceptions();
+    WARN_LOG(POWERPC, "ISI exception at 0x%08x", nextPC);
+    return;
+  }
+
+  CompileBlock(em_address, nextPC);
+}
+
+void Jit64::CompileBlock(u32 em_address, u32 nextPC)
+{
+  JitBlock* b = blocks.AllocateBlock(em_address);
+  DoJit(em_address, &code_buffer, b, nextPC);
+  b->code_hash = JitAnalysisCache::HashCode(code_buffer.codebuffer, code_block.m_num_instructions);
+  blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+}
+
+// Follows the game ID, which the boot sets after Init and which changes when the system menu
+// launches a title.
+void Jit64::LoadAnalysisCacheIfNeeded()
+{
+  const std::string& game_id = SConfig::GetInstance().GetGameID();
+  if (game_id == m_analysis_cache_game_id)
+    return;
+
+  m_analysis_cache.Record(*this);
+  m_analysis_cache.Save();
+  m_analysis_cache_game_id = game_id;
+  m_analysis_cache.Load(game_id);
+  m_analysis_cache.ApplyLikelyTakenBranches(*this);
+  m_warm_start_pending =
+      m_analysis_cache.HasBlocks() && !SConfig::GetInstance().bEnableDebugging;
+}
+
+// Compiles the blocks that were hot when the game last ran, as far as their code is in place
+// already, with what was learned about their instructions back then.
+void Jit64::CompileHotBlocks()
+{
+  m_warm_start_pending = false;
+
+  const u32 msr_bits = MSR & JitBaseBlockCache::JIT_CACHE_MSR_MASK;
+  for (const JitAnalysisCache::Block& entry : m_analysis_cache.GetHotBlocks())
+  {
+    if (entry.msr_bits != msr_bits || blocks.GetBlockFromStartAddress(entry.address, MSR))
+      continue;
+    if (IsAlmostFull() || m_far_code.IsAlmostFull() || trampolines.IsAlmostFull())
+      break;
+
+    // A trace is only the same code if it follows the same branches
+    const bool new_trace = entry.is_trace && js.traceAddresses.insert(entry.address).second;
+    u32 nextPC = AnalyzeBlock(entry.address);
+    if (code_block.m_memory_exception ||
+        JitAnalysisCache::HashCode(code_buffer.codebuffer, code_block.m_num_instructions) !=
+            entry.code_hash)
+    {
+      if (new_trace)
+        js.traceAddresses.erase(entry.address);
+      continue;
+    }
+
+    m_analysis_cache.ApplyToBlock(*this, code_block, code_buffer.codebuffer);
+    // The GPRs belong to whatever code runs now, so don't speculate on their values
+    js.entryGpr.fill(0);
+    js.entryGqr = m_analysis_cache.GetGQRs();
+
+    if (m_background_compile)
+      QueueCompile(entry.address, nextPC);
+    else
+      CompileBlock(entry.address, nextPC);
+  }
+}
+
+void Jit64::ClearCacheIfNeeded()
 {
   if (m_cleanup_after_stackfault)
   {
@@ -586,7 +957,10 @@ void Jit64::Jit(u32 em_address)
   {
     ClearCache();
   }
+}
 
+u32 Jit64::AnalyzeBlock(u32 em_address)
+{
   int blockSize = code_buffer.GetSize();
 
   if (SConfig::GetInstance().bEnableDebugging)
@@ -614,24 +988,175 @@ void Jit64::Jit(u32 em_address)
     }
   }
 
+  // Hot blocks are recompiled as traces that follow the branches they usually take. Until then,
+  // blocks count their runs and how often each of their branches is taken.
+  const bool use_traces =
+      SConfig::GetInstance().bJITTraces && blockSize > 1 &&
+      analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE);
+  const bool is_trace = use_traces && js.traceAddresses.count(em_address) != 0;
+  js.profileForTrace = use_traces && !is_trace;
+  if (is_trace)
+    analyzer.SetLikelyTakenBranches(&js.likelyTakenBranches);
+
   // Analyze the block, collect all instructions it is made of (including inlining,
   // if that is enabled), reorder instructions for optimal performance, and join joinable
   // instructions.
   u32 nextPC = analyzer.Analyze(em_address, &code_block, &code_buffer, blockSize);
+  analyzer.SetLikelyTakenBranches(nullptr);
+
+  std::copy(std::begin(PowerPC::ppcState.gpr), std::end(PowerPC::ppcState.gpr),
+            js.entryGpr.begin());
+  for (size_t i = 0; i < js.entryGqr.size(); i++)
+    js.entryGqr[i] = GQR(i);
+
+  return nextPC;
+}
+
+// With background compilation, blocks that miss the cache run in the cached interpreter, and
+// the ones that keep running are queued for the compile thread. It holds m_cache_lock while it
+// compiles a block, so the CPU thread only tries to take the lock and keeps interpreting if the
+// compile thread has it. The lock isn't held while the block runs, as interpreted icbi, dcbi and
+// exception checks call back into JitInterface, which takes it too.
+void Jit64::RunColdBlock(u32 em_address)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_cache_lock, std::try_to_lock);
+    if (lock.owns_lock())
+    {
+      ClearCacheIfNeeded();
+      blocks.LinkDeferredBlocks();
+      LoadAnalysisCacheIfNeeded();
+      if (m_warm_start_pending)
+        CompileHotBlocks();
+
+      // The block may have been compiled since the dispatcher missed it
+      if (blocks.GetBlockFromStartAddress(em_address, MSR))
+        return;
+
+      if (++m_cold_block_runs[em_address] == BACKGROUND_COMPILE_THRESHOLD)
+        RequestCompile(em_address);
+    }
+  }
 
+  if (m_interpreter_tier.RunBlock())
+    return;
+
+  // The JIT's valid block bits have to cover the interpreted code too, as they decide whether
+  // the icache invalidations of JIT code reach us.
+  std::lock_guard<std::mutex> lock(m_cache_lock);
+  const u32 msr = MSR;
+  m_interpreter_tier.Jit(em_address);
+  JitBlock* b = m_interpreter_tier.GetBlockCache()->GetBlockFromStartAddress(em_address, msr);
+  if (b)
+    blocks.MarkValid(b->physical_addresses);
+}
+
+void Jit64::RequestCompile(u32 em_address)
+{
+  u32 nextPC = AnalyzeBlock(em_address);
   if (code_block.m_memory_exception)
   {
-    // Address of instruction could not be translated
-    NPC = nextPC;
-    PowerPC::ppcState.Exceptions |= EXCEPTION_ISI;
-    PowerPC::CheckExceptions();
-    WARN_LOG(POWERPC, "ISI exception at 0x%08x", nextPC);
+    // Leave raising the ISI to the cached interpreter, which is about to run the block
+    m_cold_block_runs.erase(em_address);
     return;
   }
 
-  JitBlock* b = blocks.AllocateBlock(em_address);
-  DoJit(em_address, &code_buffer, b, nextPC);
-  blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+  QueueCompile(em_address, nextPC);
+}
+
+void Jit64::QueueCompile(u32 em_address, u32 nextPC)
+{
+  // Keeps the block from being requested again while it is queued
+  m_cold_block_runs[em_address] = BACKGROUND_COMPILE_THRESHOLD;
+
+  CompileRequest request;
+  request.address = em_address;
+  request.physical_address = PowerPC::JitCache_TranslateAddress(em_address).address;
+  request.msr = MSR;
+  request.next_pc = nextPC;
+  request.profile_for_trace = js.profileForTrace;
+  request.code_block = code_block;
+  request.st = js.st;
+  request.gpa = js.gpa;
+  request.fpa = js.fpa;
+  request.ops.assign(code_buffer.codebuffer,
+                     code_buffer.codebuffer + code_block.m_num_instructions);
+  request.entry_gpr = js.entryGpr;
+  request.entry_gqr = js.entryGqr;
+  if (!m_dbat_snapshot)
+    m_dbat_snapshot = std::make_shared<const PowerPC::BatTable>(PowerPC::dbat_table);
+  request.dbat_table = m_dbat_snapshot;
+
+  // Until the block is compiled, invalidations of its code have to drop the request
+  blocks.MarkValid(code_block.m_physical_addresses);
+
+  {
+    std::lock_guard<std::mutex> lock(m_compile_wakeup_lock);
+    m_compile_requests.push_back(std::move(request));
+  }
+  m_compile_wakeup.notify_one();
+}
+
+void Jit64::DropCompileRequests()
+{
+  std::lock_guard<std::mutex> lock(m_compile_wakeup_lock);
+  m_compile_requests.clear();
+  m_cold_block_runs.clear();
+}
+
+void Jit64::CompileThread()
+{
+  Common::SetCurrentThreadName("JIT compile thread");
+
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_compile_wakeup_lock);
+      m_compile_wakeup.wait(
+          lock, [this] { return m_compile_thread_exit || !m_compile_requests.empty(); });
+      if (m_compile_thread_exit)
+        return;
+    }
+
+    // The request can only be dropped before we have the cache lock, after that the CPU thread
+    // waits for the block to be installed before invalidating anything.
+    std::lock_guard<std::mutex> lock(m_cache_lock);
+    CompileRequest request;
+    {
+      std::lock_guard<std::mutex> wakeup_lock(m_compile_wakeup_lock);
+      if (m_compile_requests.empty())
+        continue;
+      request = std::move(m_compile_requests.front());
+      m_compile_requests.pop_front();
+    }
+    CompileRequested(request);
+  }
+}
+
+void Jit64::CompileRequested(const CompileRequest& request)
+{
+  m_cold_block_runs.erase(request.address);
+
+  // Clearing the cache has to wait for the CPU thread, which may be running any of the code.
+  // The block is requested again once it has run enough after that.
+  if (IsAlmostFull() || m_far_code.IsAlmostFull() || trampolines.IsAlmostFull())
+    return;
+
+  code_block = request.code_block;
+  js.st = request.st;
+  js.gpa = request.gpa;
+  js.fpa = request.fpa;
+  std::copy(request.ops.begin(), request.ops.end(), code_buffer.codebuffer);
+  js.entryGpr = request.entry_gpr;
+  js.entryGqr = request.entry_gqr;
+  js.profileForTrace = request.profile_for_trace;
+  js.dataBATs = request.dbat_table.get();
+
+  JitBlock* b = blocks.AllocateBlock(request.address, request.physical_address, request.msr);
+  DoJit(request.address, &code_buffer, b, request.next_pc);
+  js.dataBATs = nullptr;
+  b->code_hash = JitAnalysisCache::HashCode(code_buffer.codebuffer, code_block.m_num_instructions);
+  blocks.FinalizeBlockWithDeferredLinks(*b, jo.enableBlocklink, code_block.m_physical_addresses);
 }
 
 const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBlock* b, u32 nextPC)
@@ -647,9 +1172,32 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 
   PPCAnalyst::CodeOp* ops = code_buf->codebuffer;
 
+  // Set up before the block is compiled, as it may exit to itself
+  const BitSet32 binding = ComputeRegisterBinding(em_address, ops);
+  js.registerBinding = binding;
+  b->register_binding = binding.m_val;
+  b->boundEntry = nullptr;
+  if (binding)
+    m_register_bindings[em_address] = binding;
+  else
+    m_register_bindings.erase(em_address);
+
   const u8* start =
       AlignCode4();  // TODO: Test if this or AlignCode16 make a difference from GetCodePtr
-  b->checkedEntry = start;
+
+  // Linked exits that keep the bound registers enter here. The downcount check is the same as
+  // at the checked entry, but has to store them first.
+  FixupBranch bound_skip;
+  if (binding)
+  {
+    b->boundEntry = start;
+    bound_skip = J_CC(CC_G, true);
+    StoreBoundRegisters(binding);
+    MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
+    JMP(asm_routines.doTiming, true);
+  }
+
+  b->checkedEntry = GetCodePtr();
 
   // Downcount flag check. The last block decremented downcounter, and the flag should still be
   // available.
@@ -661,6 +1209,12 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
   const u8* normalEntry = GetCodePtr();
   b->normalEntry = normalEntry;
 
+  if (binding)
+  {
+    LoadBoundRegisters(binding);
+    SetJumpTarget(bound_skip);
+  }
+
   // Used to get a trace of the last few blocks before a crash, sometimes VERY useful
   if (ImHereDebug)
   {
@@ -679,6 +1233,30 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
     ADD(64, MDisp(ABI_PARAM1, offset), Imm8(1));
     ABI_CallFunction(QueryPerformanceCounter);
   }
+
+  if (js.profileForTrace)
+  {
+    // The code refers to the branch profiles, so they must never be reallocated.
+    b->branch_profiles.reserve(
+        std::count_if(ops, ops + code_block.m_num_instructions,
+                      [](const PPCAnalyst::CodeOp& op) { return op.inst.OPCD == 16; }));
+
+    // Have the block recompiled as a trace once it is hot
+    b->trace_countdown = TRACE_THRESHOLD;
+    MOV(64, R(RSCRATCH), ImmPtr(&b->trace_countdown));
+    SUB(32, MatR(RSCRATCH), Imm8(1));
+    FixupBranch hot = J_CC(CC_Z, true);
+
+    SwitchToFarCode();
+    SetJumpTarget(hot);
+    StoreBoundRegisters(binding);
+    MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
+    ABI_PushRegistersAndAdjustStack({}, 0);
+    ABI_CallFunction(JitInterface::CompileTrace);
+    ABI_PopRegistersAndAdjustStack({}, 0);
+    JMP(asm_routines.dispatcherNoCheck, true);
+    SwitchToNearCode();
+  }
 #if defined(_DEBUG) || defined(DEBUGFAST) || defined(NAN_CHECK)
   // should help logged stack-traces become more accurate
   MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
@@ -688,6 +1266,9 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
   // They use the information in gpa/fpa to preload commonly used registers.
   gpr.Start();
   fpr.Start();
+  size_t bound_index = 0;
+  for (int reg : binding)
+    gpr.AssumeBoundToRegister(reg, gpr.GetBoundXReg(bound_index++));
 
   js.downcountAmount = 0;
   js.skipInstructions = 0;
@@ -707,6 +1288,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
     {
       SwitchToFarCode();
       const u8* target = GetCodePtr();
+      StoreBoundRegisters(binding);
       MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
       ABI_PushRegistersAndAdjustStack({}, 0);
       ABI_CallFunctionC(JitInterface::CompileExceptionCheck,
@@ -719,7 +1301,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
       // the start of the block in case our guess turns out wrong.
       for (int gqr : gqr_static)
       {
-        u32 value = GQR(gqr);
+        u32 value = js.entryGqr[gqr];
         js.constantGqr[gqr] = value;
         CMP_or_TEST(32, PPCSTATE(spr[SPR_GQR0 + gqr]), Imm32(value));
         J_CC(CC_NZ, target);
@@ -927,8 +1509,9 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
         SwitchToNearCode();
       }
 
-      // If we have a register that will never be used again, flush it.
-      for (int j : ~ops[i].gprInUse)
+      // If we have a register that will never be used again, flush it. The bound registers
+      // are used again by the block's exits to itself.
+      for (int j : ~(ops[i].gprInUse | binding))
         gpr.StoreFromRegister(j);
       for (int j : ~ops[i].fprInUse)
         fpr.StoreFromRegister(j);
@@ -953,16 +1536,16 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 
   if (code_block.m_broken)
   {
-    gpr.Flush();
+    gpr.Flush(RegCache::FlushMode::All, ~GetRegisterBinding(nextPC));
     fpr.Flush();
     WriteExit(nextPC);
   }
 
-  b->codeSize = (u32)(GetCodePtr() - start);
+  b->codeSize = (u32)(GetCodePtr() - b->checkedEntry);
   b->originalSize = code_block.m_num_instructions;
 
 #ifdef JIT_LOG_X86
-  LogGeneratedX86(code_block.m_num_instructions, code_buf, start, b);
+  LogGeneratedX86(code_block.m_num_instructions, code_buf, b->checkedEntry, b);
 #endif
 
   return normalEntry;
@@ -1010,18 +1593,20 @@ void Jit64::IntializeSpeculativeConstants()
   // the first block loads the constant.
   // Insert a check at the start of the block to verify that the value is actually constant.
   // This can save a lot of backpatching and optimize gather pipe writes in more places.
+  // The bound registers may be newer than ppcState
   const u8* target = nullptr;
-  for (auto i : code_block.m_gpr_inputs)
+  for (auto i : code_block.m_gpr_inputs & ~js.registerBinding)
   {
-    u32 compileTimeValue = PowerPC::ppcState.gpr[i];
-    if (PowerPC::IsOptimizableGatherPipeWrite(compileTimeValue) ||
-        PowerPC::IsOptimizableGatherPipeWrite(compileTimeValue - 0x8000) ||
+    u32 compileTimeValue = js.entryGpr[i];
+    if (IsOptimizableGatherPipeWrite(compileTimeValue) ||
+        IsOptimizableGatherPipeWrite(compileTimeValue - 0x8000) ||
         compileTimeValue == 0xCC000000)
     {
       if (!target)
       {
         SwitchToFarCode();
         target = GetCodePtr();
+        StoreBoundRegisters(js.registerBinding);
         MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
         ABI_PushRegistersAndAdjustStack({}, 0);
         ABI_CallFunctionC(JitInterface::CompileExceptionCheck,
@@ -18,14 +18,26 @@
 // ----------
 #pragma once
 
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
+#include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
 #include "Core/PowerPC/Jit64/FPURegCache.h"
 #include "Core/PowerPC/Jit64/GPRRegCache.h"
 #include "Core/PowerPC/Jit64/JitAsm.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/Jit64Base.h"
+#include "Core/PowerPC/JitCommon/JitAnalysisCache.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 
@@ -57,6 +69,8 @@ public:
   void Trace();
 
   void ClearCache() override;
+  void ClearSafe() override;
+  void InvalidateICache(u32 address, u32 length, bool forced) override;
 
   const CommonAsmRoutines* GetAsmRoutines() override { return &asm_routines; }
   const char* GetName() const override { return "JIT64"; }
@@ -66,16 +80,28 @@ public:
 
   // Utilities for use by opcodes
 
+  // Counts the runs of a conditional branch's taken path, for the trace the block may become
+  void ProfileBranchTaken(u32 branch_address);
   void FakeBLCall(u32 after);
   void WriteExit(u32 destination, bool bl = false, u32 after = 0);
   void JustWriteExit(u32 destination, bool bl, u32 after);
+  void JustWriteBoundExit(u32 destination, BitSet32 binding);
   void WriteExitDestInRSCRATCH(bool bl = false, u32 after = 0);
   void WriteBLRExit();
   void WriteExceptionExit();
   void WriteExternalExceptionExit();
+  // Skips ahead to the next event before going on at destination, for branches of idle loops.
+  void WriteIdleExit(u32 destination);
   void WriteRfiExitDestInRSCRATCH();
   bool Cleanup();
 
+  // The GPRs that the block at the address takes over in host registers from linked exits.
+  // The n-th GPR in the set is bound to gpr.GetBoundXReg(n). Exits to the block don't need to
+  // flush them.
+  BitSet32 GetRegisterBinding(u32 address) const;
+  // The binding of the target of an immediate branch that doesn't set LR
+  BitSet32 GetBranchRegisterBinding(const PPCAnalyst::CodeOp& op) const;
+
   void GenerateConstantOverflow(bool overflow);
   void GenerateConstantOverflow(s64 val);
   void GenerateOverflow();
@@ -231,12 +257,54 @@ public:
   void eieio(UGeckoInstruction inst);
 
 private:
+  // A block to be compiled on the compile thread. It is analyzed on the CPU thread, as that
+  // reads the code through the instruction cache and the current address translation.
+  struct CompileRequest
+  {
+    u32 address;
+    u32 physical_address;
+    u32 msr;
+    u32 next_pc;
+    bool profile_for_trace;
+    PPCAnalyst::CodeBlock code_block;
+    PPCAnalyst::BlockStats st;
+    PPCAnalyst::BlockRegStats gpa;
+    PPCAnalyst::BlockRegStats fpa;
+    std::vector<PPCAnalyst::CodeOp> ops;
+    std::array<u32, 32> entry_gpr;
+    std::array<u32, 8> entry_gqr;
+    // The data BATs, which decide what loads and stores with constant addresses compile to
+    std::shared_ptr<const PowerPC::BatTable> dbat_table;
+  };
+
+  // Runs of a block in the cached interpreter before it is queued for compilation
+  static constexpr u32 BACKGROUND_COMPILE_THRESHOLD = 8;
+
   static void InitializeInstructionTables();
   void CompileInstruction(PPCAnalyst::CodeOp& op);
 
   void AllocStack();
   void FreeStack();
 
+  void ClearCacheIfNeeded();
+  u32 AnalyzeBlock(u32 em_address);
+  void CompileBlock(u32 em_address, u32 nextPC);
+  void LoadAnalysisCacheIfNeeded();
+  void CompileHotBlocks();
+
+  void RunColdBlock(u32 em_address);
+  void RequestCompile(u32 em_address);
+  void QueueCompile(u32 em_address, u32 nextPC);
+  void DropCompileRequests();
+  void CompileThread();
+  void CompileRequested(const CompileRequest& request);
+
+  BitSet32 ComputeRegisterBinding(u32 em_address, const PPCAnalyst::CodeOp* ops) const;
+  // Puts the bound GPRs into their host registers, wherever the register cache has them.
+  void MoveToBoundRegisters(BitSet32 binding);
+  void LoadBoundRegisters(BitSet32 binding);
+  void StoreBoundRegisters(BitSet32 binding);
+
   GPRRegCache gpr{*this};
   FPURegCache fpr{*this};
 
@@ -248,4 +316,29 @@ private:
   bool m_enable_blr_optimization;
   bool m_cleanup_after_stackfault;
   u8* m_stack;
+
+  JitAnalysisCache m_analysis_cache;
+  std::string m_analysis_cache_game_id;
+  // The hot blocks from the analysis cache are compiled on the first miss, when the game's
+  // code has been loaded.
+  bool m_warm_start_pending = false;
+
+  // Cold code runs in here until the compile thread has compiled it.
+  CachedInterpreter m_interpreter_tier;
+  // How often each cold block has run. Like everything the compile thread uses, the counters
+  // and requests are guarded by m_cache_lock.
+  std::unordered_map<u32, u32> m_cold_block_runs;
+  std::deque<CompileRequest> m_compile_requests;
+  // Also guards the requests, so that the compile thread can wait for them without holding
+  // m_cache_lock.
+  std::mutex m_compile_wakeup_lock;
+  // A copy of dbat_table that the requests share until the BATs change, which clears the cache
+  std::shared_ptr<const PowerPC::BatTable> m_dbat_snapshot;
+  std::condition_variable m_compile_wakeup;
+  bool m_compile_thread_exit = false;
+  std::thread m_compile_thread;
+
+  // The register bindings of the compiled blocks, guarded by m_cache_lock. Blocks compiled
+  // later pick them up for their exits.
+  std::unordered_map<u32, BitSet32> m_register_bindings;
 };
@@ -185,9 +185,19 @@ void Jit64AsmRoutineManager::Generate()
   ABI_CallFunction(JitTrampoline);
   ABI_PopRegistersAndAdjustStack({}, 0);
 
+  // With background compilation, Jit may have run the block in the cached interpreter.
+  FixupBranch interpreted_timing;
+  if (m_jit.CompilesInBackground())
+  {
+    CMP(32, PPCSTATE(downcount), Imm8(0));
+    interpreted_timing = J_CC(CC_LE, true);
+  }
+
   JMP(dispatcherNoCheck, true);
 
   SetJumpTarget(bail);
+  if (m_jit.CompilesInBackground())
+    SetJumpTarget(interpreted_timing);
   doTiming = GetCodePtr();
 
   // make sure npc contains the next pc (needed for exception checking in CoreTiming::Advance)
@@ -205,6 +205,17 @@ void RegCache::BindToRegister(size_t i, bool doLoad, bool makeDirty)
   }
 }
 
+void RegCache::AssumeBoundToRegister(size_t preg, X64Reg xreg)
+{
+  ASSERT_MSG(DYNA_REC, m_xregs[xreg].free && !m_regs[preg].away,
+             "Jit64 - Binding reg %zu to a register that is in use", preg);
+  m_xregs[xreg].free = false;
+  m_xregs[xreg].ppcReg = preg;
+  m_xregs[xreg].dirty = true;
+  m_regs[preg].away = true;
+  m_regs[preg].location = ::Gen::R(xreg);
+}
+
 void RegCache::StoreFromRegister(size_t i, FlushMode mode)
 {
   if (m_regs[i].away)
@@ -64,6 +64,9 @@ public:
   // TODO - instead of doload, use "read", "write"
   // read only will not set dirty flag
   void BindToRegister(size_t preg, bool doLoad = true, bool makeDirty = true);
+  // Records that xreg already holds preg, with a value that may be newer than the one in
+  // ppcState. No code is emitted.
+  void AssumeBoundToRegister(size_t preg, Gen::X64Reg xreg);
   void StoreFromRegister(size_t preg, FlushMode mode = FlushMode::All);
 
   const Gen::OpArg& R(size_t preg) const;
@@ -358,6 +358,10 @@ bool Jit64::CheckMergedBranch(u32 crf)
   if (!CanMergeNextInstructions(1))
     return false;
 
+  // Branches followed by a trace are compiled on their own; see bcx
+  if (js.op[1].branchFollowed)
+    return false;
+
   const UGeckoInstruction& next = js.op[1].inst;
   return (((next.OPCD == 16 /* bcx */) ||
            ((next.OPCD == 19) && (next.SUBOP10 == 528) /* bcctrx */) ||
@@ -381,6 +385,12 @@ void Jit64::DoMergedBranch()
       destination = SignExt16(next.BD << 2);
     else
       destination = nextPC + SignExt16(next.BD << 2);
+    if (js.op[1].branchIsIdleLoop)
+    {
+      WriteIdleExit(destination);
+      return;
+    }
+    ProfileBranchTaken(nextPC);
     WriteExit(destination, next.LK, nextPC + 4);
   }
   else if ((next.OPCD == 19) && (next.SUBOP10 == 528))  // bcctrx
@@ -427,7 +437,7 @@ void Jit64::DoMergedBranchCondition()
   else  // SO bit, do not branch (we don't emulate SO for cmp).
     pDontBranch = J(true);
 
-  gpr.Flush(RegCache::FlushMode::MaintainState);
+  gpr.Flush(RegCache::FlushMode::MaintainState, ~GetBranchRegisterBinding(js.op[1]));
   fpr.Flush(RegCache::FlushMode::MaintainState);
 
   DoMergedBranch();
@@ -465,7 +475,7 @@ void Jit64::DoMergedBranchImmediate(s64 val)
 
   if (branch)
   {
-    gpr.Flush();
+    gpr.Flush(RegCache::FlushMode::All, ~GetBranchRegisterBinding(js.op[1]));
     fpr.Flush();
     DoMergedBranch();
   }
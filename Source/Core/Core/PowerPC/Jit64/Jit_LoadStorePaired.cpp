@@ -7,6 +7,7 @@
 
 #include "Core/PowerPC/Jit64/Jit.h"
 
+#include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
 #include "Common/x64Emitter.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
@@ -24,7 +25,7 @@ void Jit64::psq_stXX(UGeckoInstruction inst)
   JITDISABLE(bJITLoadStorePairedOff);
 
   // For performance, the AsmCommon routines assume address translation is on.
-  FALLBACK_IF(!UReg_MSR(MSR).DR);
+  FALLBACK_IF(!IsDataTranslationOn());
 
   s32 offset = inst.SIMM_12;
   bool indexed = inst.OPCD == 4;
@@ -58,28 +59,10 @@ void Jit64::psq_stXX(UGeckoInstruction inst)
 
   if (gqrIsConstant)
   {
-    int type = gqrValue & 0x7;
-
-    // Paired stores (other than w/type zero) don't yield any real change in
-    // performance right now, but if we can improve fastmem support this might change
-    if (gqrValue == 0)
-    {
-      if (w)
-        GenQuantizedStore(true, static_cast<EQuantizeType>(type), (gqrValue & 0x3F00) >> 8);
-      else
-        GenQuantizedStore(false, static_cast<EQuantizeType>(type), (gqrValue & 0x3F00) >> 8);
-    }
-    else
-    {
-      // We know what GQR is here, so we can load RSCRATCH2 and call into the store method directly
-      // with just the scale bits.
-      MOV(32, R(RSCRATCH2), Imm32(gqrValue & 0x3F00));
-
-      if (w)
-        CALL(asm_routines.singleStoreQuantized[type]);
-      else
-        CALL(asm_routines.pairedStoreQuantized[type]);
-    }
+    // With the type and scale known, the store is inlined with the scale as a constant, instead
+    // of calling the routine that looks it up. That also gives it the fastmem path.
+    GenQuantizedStore(w != 0, static_cast<EQuantizeType>(gqrValue & 0x7),
+                      (gqrValue & 0x3F00) >> 8);
   }
   else
   {
@@ -114,7 +97,7 @@ void Jit64::psq_lXX(UGeckoInstruction inst)
   JITDISABLE(bJITLoadStorePairedOff);
 
   // For performance, the AsmCommon routines assume address translation is on.
-  FALLBACK_IF(!UReg_MSR(MSR).DR);
+  FALLBACK_IF(!IsDataTranslationOn());
 
   s32 offset = inst.SIMM_12;
   bool indexed = inst.OPCD == 4;
@@ -130,6 +113,38 @@ void Jit64::psq_lXX(UGeckoInstruction inst)
   bool gqrIsConstant = it != js.constantGqr.end();
   u32 gqrValue = gqrIsConstant ? it->second >> 16 : 0;
 
+  // Matrix rows and vectors are loaded by consecutive psq_l of float pairs. Two of them are
+  // fused into a single 16 byte load with one byteswap, like the unfused loads without memcheck
+  // going straight to RAM.
+  const UGeckoInstruction next = js.op[1].inst;
+  if (gqrIsConstant && (gqrValue & 0x7) == QUANTIZE_FLOAT && !w && !indexed && !update &&
+      !jo.memcheck && cpu_info.bSSSE3 && CanMergeNextInstructions(1) && next.OPCD == 56 &&
+      next.RA == a && next.SIMM_12 == offset + 8 && next.I == i && !next.W && next.FS != s)
+  {
+    const int s2 = next.FS;
+    js.downcountAmount += js.op[1].opinfo->numCycles;
+    js.skipInstructions = 1;
+    ++js.numLoadStoreInst;
+
+    gpr.Lock(a);
+    gpr.FlushLockX(RSCRATCH_EXTRA);
+    fpr.Lock(s, s2);
+    fpr.BindToRegister(s, false, true);
+    fpr.BindToRegister(s2, false, true);
+
+    MOV_sum(32, RSCRATCH_EXTRA, gpr.R(a), Imm32((u32)offset));
+    MOVUPS(XMM0, MRegSum(RMEM, RSCRATCH_EXTRA));
+    PSHUFB(XMM0, MConst(pbswapShuffle4x4));
+    CVTPS2PD(fpr.RX(s), R(XMM0));
+    MOVHLPS(XMM0, XMM0);
+    CVTPS2PD(fpr.RX(s2), R(XMM0));
+
+    fpr.UnlockAll();
+    gpr.UnlockAll();
+    gpr.UnlockAllX();
+    return;
+  }
+
   gpr.Lock(a, b);
 
   gpr.FlushLockX(RSCRATCH_EXTRA);
@@ -15,7 +15,16 @@ JitBlockCache::JitBlockCache(JitBase& jit) : JitBaseBlockCache{jit}
 void JitBlockCache::WriteLinkBlock(const JitBlock::LinkData& source, const JitBlock* dest)
 {
   u8* location = source.exitPtrs;
-  const u8* address = dest ? dest->checkedEntry : m_jit.GetAsmRoutines()->dispatcher;
+  const u8* address;
+  if (source.registerBinding)
+  {
+    const bool same_binding = dest && dest->register_binding == source.registerBinding;
+    address = same_binding ? dest->boundEntry : source.fallback;
+  }
+  else
+  {
+    address = dest ? dest->checkedEntry : m_jit.GetAsmRoutines()->dispatcher;
+  }
   Gen::XEmitter emit(location);
   if (*location == 0xE8)
   {
@@ -41,4 +50,9 @@ void JitBlockCache::WriteDestroyBlock(const JitBlock& block)
   emit.INT3();
   Gen::XEmitter emit2(const_cast<u8*>(block.normalEntry));
   emit2.INT3();
+  if (block.boundEntry)
+  {
+    Gen::XEmitter emit3(const_cast<u8*>(block.boundEntry));
+    emit3.INT3();
+  }
 }
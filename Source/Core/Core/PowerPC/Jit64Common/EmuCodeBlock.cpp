@@ -4,6 +4,7 @@
 
 #include "Core/PowerPC/Jit64Common/EmuCodeBlock.h"
 
+#include <cstddef>
 #include <functional>
 #include <limits>
 
@@ -114,6 +115,74 @@ FixupBranch EmuCodeBlock::CheckIfSafeAddress(const OpArg& reg_value, X64Reg reg_
   return J_CC(CC_Z, m_far_code.Enabled());
 }
 
+FixupBranch EmuCodeBlock::AccessThroughHostTLB(const OpArg& reg_value, X64Reg reg_addr,
+                                               int access_size, bool write,
+                                               BitSet32 registers_in_use,
+                                               const std::function<void(const OpArg&)>& access)
+{
+  static_assert(sizeof(PowerPC::HostTLBEntry) == 16, "The lookup scales the index by 16");
+
+  // Two caller saved registers that hold neither the address nor the value
+  std::array<X64Reg, 2> scratch;
+  size_t num_scratch = 0;
+  for (X64Reg reg : {RSCRATCH_EXTRA, RSCRATCH, RSCRATCH2, R8})
+  {
+    if (num_scratch < scratch.size() && reg != reg_addr && !reg_value.IsSimpleReg(reg))
+      scratch[num_scratch++] = reg;
+  }
+  const X64Reg entry = scratch[0];
+  const X64Reg temp = scratch[1];
+
+  BitSet32 saved;
+  for (X64Reg reg : scratch)
+  {
+    if (registers_in_use[reg])
+    {
+      PUSH(reg);
+      saved[reg] = true;
+    }
+  }
+  const auto restore = [this, &scratch, saved] {
+    for (auto it = scratch.rbegin(); it != scratch.rend(); ++it)
+    {
+      if (saved[*it])
+        POP(*it);
+    }
+  };
+
+  // Aligned accesses never cross into the next page
+  FixupBranch unaligned;
+  if (access_size > 8)
+  {
+    TEST(32, R(reg_addr), Imm32(access_size / 8 - 1));
+    unaligned = J_CC(CC_NZ);
+  }
+
+  const PowerPC::HostTLB& tlb = write ? PowerPC::host_write_tlb : PowerPC::host_read_tlb;
+  MOV(32, R(temp), R(reg_addr));
+  SHR(32, R(temp), Imm8(PowerPC::HOST_TLB_PAGE_SHIFT));
+  AND(32, R(temp), Imm32(PowerPC::HOST_TLB_SIZE - 1));
+  SHL(32, R(temp), Imm8(4));
+  MOV(64, R(entry), ImmPtr(tlb.data()));
+  ADD(64, R(entry), R(temp));
+  MOV(32, R(temp), R(reg_addr));
+  AND(32, R(temp), Imm32(~(PowerPC::HOST_TLB_PAGE_SIZE - 1)));
+  CMP(32, R(temp), MDisp(entry, offsetof(PowerPC::HostTLBEntry, tag)));
+  FixupBranch miss = J_CC(CC_NE);
+
+  ADD(32, MDisp(entry, offsetof(PowerPC::HostTLBEntry, hits)), Imm8(1));
+  MOV(64, R(entry), MDisp(entry, offsetof(PowerPC::HostTLBEntry, host_offset)));
+  access(MRegSum(entry, reg_addr));
+  restore();
+  FixupBranch hit = J(true);
+
+  if (access_size > 8)
+    SetJumpTarget(unaligned);
+  SetJumpTarget(miss);
+  restore();
+  return hit;
+}
+
 void EmuCodeBlock::UnsafeLoadRegToReg(X64Reg reg_addr, X64Reg reg_value, int accessSize, s32 offset,
                                       bool signExtend)
 {
@@ -314,7 +383,8 @@ void EmuCodeBlock::MMIOLoadToReg(MMIO::Mapping* mmio, Gen::X64Reg reg_value,
 void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress, int accessSize,
                                  s32 offset, BitSet32 registersInUse, bool signExtend, int flags)
 {
-  bool slowmem = (flags & SAFE_LOADSTORE_FORCE_SLOWMEM) != 0;
+  bool slowmem = (flags & SAFE_LOADSTORE_FORCE_SLOWMEM) != 0 ||
+                 g_jit->js.slowmemAddresses.count(g_jit->js.compilerPC) != 0;
 
   registersInUse[reg_value] = false;
   if (g_jit->jo.fastmem && !(flags & SAFE_LOADSTORE_NO_FASTMEM) && !slowmem)
@@ -364,7 +434,7 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress,
   }
 
   FixupBranch exit;
-  bool dr_set = (flags & SAFE_LOADSTORE_DR_ON) || UReg_MSR(MSR).DR;
+  bool dr_set = (flags & SAFE_LOADSTORE_DR_ON) || g_jit->IsDataTranslationOn();
   bool fast_check_address = !slowmem && dr_set;
   if (fast_check_address)
   {
@@ -377,6 +447,18 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress,
     SetJumpTarget(slow);
   }
 
+  FixupBranch tlb_hit;
+  // Also probed when slowmem is forced, as trampolines and accesses that faulted out of fastmem
+  // are the ones that need it
+  const bool use_host_tlb = dr_set && g_jit->jo.hostTLB;
+  if (use_host_tlb)
+  {
+    tlb_hit = AccessThroughHostTLB(R(reg_value), reg_addr, accessSize, false, registersInUse,
+                                   [&](const OpArg& src) {
+                                     LoadAndSwap(accessSize, reg_value, src, signExtend);
+                                   });
+  }
+
   // Helps external systems know which instruction triggered the read.
   MOV(32, PPCSTATE(pc), Imm32(g_jit->js.compilerPC));
 
@@ -419,20 +501,22 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress,
     }
     SetJumpTarget(exit);
   }
+  if (use_host_tlb)
+    SetJumpTarget(tlb_hit);
 }
 
 void EmuCodeBlock::SafeLoadToRegImmediate(X64Reg reg_value, u32 address, int accessSize,
                                           BitSet32 registersInUse, bool signExtend)
 {
   // If the address is known to be RAM, just load it directly.
-  if (PowerPC::IsOptimizableRAMAddress(address))
+  if (g_jit->IsOptimizableRAMAddress(address))
   {
     UnsafeLoadToReg(reg_value, Imm32(address), accessSize, 0, signExtend);
     return;
   }
 
   // If the address maps to an MMIO register, inline MMIO read code.
-  u32 mmioAddress = PowerPC::IsOptimizableMMIOAccess(address, accessSize);
+  u32 mmioAddress = g_jit->IsOptimizableMMIOAccess(address, accessSize);
   if (accessSize != 64 && mmioAddress)
   {
     MMIOLoadToReg(Memory::mmio_mapping.get(), reg_value, registersInUse, mmioAddress, accessSize,
@@ -478,7 +562,8 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
                                      BitSet32 registersInUse, int flags)
 {
   bool swap = !(flags & SAFE_LOADSTORE_NO_SWAP);
-  bool slowmem = (flags & SAFE_LOADSTORE_FORCE_SLOWMEM) != 0;
+  bool slowmem = (flags & SAFE_LOADSTORE_FORCE_SLOWMEM) != 0 ||
+                 g_jit->js.slowmemAddresses.count(g_jit->js.compilerPC) != 0;
 
   // set the correct immediate format
   reg_value = FixImmediate(accessSize, reg_value);
@@ -526,7 +611,7 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
   }
 
   FixupBranch exit;
-  bool dr_set = (flags & SAFE_LOADSTORE_DR_ON) || UReg_MSR(MSR).DR;
+  bool dr_set = (flags & SAFE_LOADSTORE_DR_ON) || g_jit->IsDataTranslationOn();
   bool fast_check_address = !slowmem && dr_set;
   if (fast_check_address)
   {
@@ -539,6 +624,22 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
     SetJumpTarget(slow);
   }
 
+  FixupBranch tlb_hit;
+  const bool use_host_tlb = dr_set && g_jit->jo.hostTLB;
+  if (use_host_tlb)
+  {
+    tlb_hit = AccessThroughHostTLB(reg_value, reg_addr, accessSize, true, registersInUse,
+                                   [&](const OpArg& dest) {
+                                     if (reg_value.IsImm())
+                                       MOV(accessSize, dest,
+                                           swap ? SwapImmediate(accessSize, reg_value) : reg_value);
+                                     else if (swap)
+                                       SwapAndStore(accessSize, dest, reg_value.GetSimpleReg());
+                                     else
+                                       MOV(accessSize, dest, reg_value);
+                                   });
+  }
+
   // PC is used by memory watchpoints (if enabled) or to print accurate PC locations in debug logs
   MOV(32, PPCSTATE(pc), Imm32(g_jit->js.compilerPC));
 
@@ -585,6 +686,8 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
     }
     SetJumpTarget(exit);
   }
+  if (use_host_tlb)
+    SetJumpTarget(tlb_hit);
 }
 
 void EmuCodeBlock::SafeWriteRegToReg(Gen::X64Reg reg_value, Gen::X64Reg reg_addr, int accessSize,
@@ -605,7 +708,7 @@ bool EmuCodeBlock::WriteToConstAddress(int accessSize, OpArg arg, u32 address,
 
   // If we already know the address through constant folding, we can do some
   // fun tricks...
-  if (g_jit->jo.optimizeGatherPipe && PowerPC::IsOptimizableGatherPipeWrite(address))
+  if (g_jit->jo.optimizeGatherPipe && g_jit->IsOptimizableGatherPipeWrite(address))
   {
     X64Reg arg_reg = RSCRATCH;
 
@@ -625,7 +728,7 @@ bool EmuCodeBlock::WriteToConstAddress(int accessSize, OpArg arg, u32 address,
     g_jit->js.fifoBytesSinceCheck += accessSize >> 3;
     return false;
   }
-  else if (PowerPC::IsOptimizableRAMAddress(address))
+  else if (g_jit->IsOptimizableRAMAddress(address))
   {
     WriteToConstRamAddress(accessSize, arg, address);
     return false;
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <functional>
 #include <unordered_map>
 
 #include "Common/BitSet.h"
@@ -49,6 +50,12 @@ public:
 
   Gen::FixupBranch CheckIfSafeAddress(const Gen::OpArg& reg_value, Gen::X64Reg reg_addr,
                                       BitSet32 registers_in_use);
+  // Looks the address up in PowerPC::host_read_tlb or host_write_tlb. On a hit, the access is
+  // emitted with the host address of the data and the returned branch is taken. Misses leave
+  // all registers as they were.
+  Gen::FixupBranch AccessThroughHostTLB(const Gen::OpArg& reg_value, Gen::X64Reg reg_addr,
+                                        int access_size, bool write, BitSet32 registers_in_use,
+                                        const std::function<void(const Gen::OpArg&)>& access);
   void UnsafeLoadRegToReg(Gen::X64Reg reg_addr, Gen::X64Reg reg_value, int accessSize,
                           s32 offset = 0, bool signExtend = false);
   void UnsafeLoadRegToRegNoSwap(Gen::X64Reg reg_addr, Gen::X64Reg reg_value, int accessSize,
@@ -52,6 +52,8 @@ bool Jitx86Base::BackPatch(u32 emAddress, SContext* ctx)
   }
 
   TrampolineInfo& info = it->second;
+  // Later compiles of the instruction skip straight to the slow path
+  js.slowmemAddresses.insert(info.pc);
 
   u8* exceptionHandler = nullptr;
   if (jo.memcheck)
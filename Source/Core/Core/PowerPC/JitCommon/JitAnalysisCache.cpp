@@ -0,0 +1,306 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/JitCommon/JitAnalysisCache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/PowerPC.h"
+
+// Increment this every time the layout or the meaning of the data changes
+static constexpr u32 CACHE_REVISION = 1;
+
+// Most games run far fewer hot blocks than this, and compiling more only delays the boot.
+static constexpr size_t MAX_SAVED_BLOCKS = 8192;
+// Far more instructions than any game needs to treat specially
+static constexpr size_t MAX_SAVED_ADDRESSES = 1 << 20;
+
+static u64 BlockKey(u32 address, u32 msr_bits)
+{
+  return static_cast<u64>(msr_bits) << 32 | address;
+}
+
+// Whether what is left of the file being read holds the given number of bytes, as a corrupt file
+// could make us read past its end. Stops reading if it doesn't.
+static bool CanRead(PointerWrap& p, size_t bytes, u8* const* ptr, const u8* end)
+{
+  if (p.GetMode() != PointerWrap::MODE_READ || bytes <= static_cast<size_t>(end - *ptr))
+    return true;
+
+  p.SetMode(PointerWrap::MODE_MEASURE);
+  return false;
+}
+
+// Does the element count of a container. Counts read from the file are capped.
+static bool DoCount(PointerWrap& p, u32& count, size_t max_count, size_t element_size,
+                    u8* const* ptr, const u8* end)
+{
+  if (!CanRead(p, sizeof(count), ptr, end))
+    return false;
+
+  p.Do(count);
+  if (p.GetMode() == PointerWrap::MODE_READ && count > max_count)
+  {
+    p.SetMode(PointerWrap::MODE_MEASURE);
+    return false;
+  }
+  return CanRead(p, count * element_size, ptr, end);
+}
+
+static void DoAddresses(PointerWrap& p, std::set<u32>& addresses, u8* const* ptr, const u8* end)
+{
+  u32 count = static_cast<u32>(addresses.size());
+  if (!DoCount(p, count, MAX_SAVED_ADDRESSES, sizeof(u32), ptr, end))
+    return;
+
+  if (p.GetMode() == PointerWrap::MODE_READ)
+  {
+    for (addresses.clear(); count != 0; --count)
+    {
+      u32 address;
+      p.Do(address);
+      addresses.insert(address);
+    }
+  }
+  else
+  {
+    for (u32 address : addresses)
+      p.Do(address);
+  }
+}
+
+static bool IsStore(const PPCAnalyst::CodeOp& op)
+{
+  return op.opinfo->type == OpType::Store || op.opinfo->type == OpType::StoreFP ||
+         op.opinfo->type == OpType::StorePS;
+}
+
+u64 JitAnalysisCache::HashCode(const PPCAnalyst::CodeOp* ops, u32 num_instructions)
+{
+  std::vector<u32> code;
+  code.reserve(num_instructions * 2);
+  for (u32 i = 0; i < num_instructions; i++)
+  {
+    code.push_back(ops[i].address);
+    code.push_back(ops[i].inst.hex);
+  }
+  return GetMurmurHash3(reinterpret_cast<const u8*>(code.data()),
+                        static_cast<u32>(code.size() * sizeof(u32)), 0);
+}
+
+void JitAnalysisCache::Load(const std::string& game_id)
+{
+  Clear();
+  m_filename.clear();
+  if (game_id.empty() || game_id == "00000000")
+    return;
+
+  m_filename = File::GetUserPath(D_CACHE_IDX) + game_id + ".jitcache";
+  File::IOFile f(m_filename, "rb");
+  if (!f)
+    return;
+
+  std::vector<u8> buffer(f.GetSize());
+  if (buffer.empty() || !f.ReadBytes(buffer.data(), buffer.size()))
+    return;
+
+  u8* ptr = buffer.data();
+  PointerWrap p(&ptr, PointerWrap::MODE_READ);
+  DoState(p, &ptr, buffer.size());
+  if (p.GetMode() != PointerWrap::MODE_READ)
+  {
+    WARN_LOG(DYNA_REC, "Ignoring outdated or corrupt JIT analysis cache %s", m_filename.c_str());
+    Clear();
+    return;
+  }
+
+  INFO_LOG(DYNA_REC, "Loaded %zu blocks from the JIT analysis cache", m_blocks.size());
+}
+
+void JitAnalysisCache::Save()
+{
+  if (m_filename.empty() || m_blocks.empty())
+    return;
+
+  if (m_blocks.size() > MAX_SAVED_BLOCKS)
+  {
+    std::vector<Block> hot_blocks = GetHotBlocks();
+    m_blocks.clear();
+    for (size_t i = 0; i < MAX_SAVED_BLOCKS; i++)
+      m_blocks.emplace(BlockKey(hot_blocks[i].address, hot_blocks[i].msr_bits), hot_blocks[i]);
+  }
+
+  u8* ptr = nullptr;
+  PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+  DoState(p, &ptr, 0);
+  const size_t buffer_size = reinterpret_cast<size_t>(ptr);
+
+  std::vector<u8> buffer(buffer_size);
+  ptr = buffer.data();
+  p.SetMode(PointerWrap::MODE_WRITE);
+  DoState(p, &ptr, buffer_size);
+
+  File::CreateFullPath(m_filename);
+  File::IOFile f(m_filename, "wb");
+  if (!f || !f.WriteBytes(buffer.data(), buffer.size()))
+  {
+    ERROR_LOG(DYNA_REC, "Failed to write the JIT analysis cache %s", m_filename.c_str());
+    f.Close();
+    File::Delete(m_filename);
+  }
+}
+
+void JitAnalysisCache::Clear()
+{
+  m_blocks.clear();
+  m_fifo_write_addresses.clear();
+  m_paired_quantize_addresses.clear();
+  m_no_speculative_constants_addresses.clear();
+  m_slowmem_addresses.clear();
+  m_likely_taken_branches.clear();
+  m_gqr.fill(0);
+}
+
+std::vector<JitAnalysisCache::Block> JitAnalysisCache::GetHotBlocks() const
+{
+  std::vector<Block> blocks;
+  blocks.reserve(m_blocks.size());
+  for (const auto& entry : m_blocks)
+    blocks.push_back(entry.second);
+
+  std::stable_sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) {
+    if (a.is_trace != b.is_trace)
+      return a.is_trace;
+    return a.runs > b.runs;
+  });
+  return blocks;
+}
+
+void JitAnalysisCache::Record(JitBase& jit)
+{
+  if (m_filename.empty())
+    return;
+
+  jit.GetBlockCache()->RunOnBlocks([this, &jit](const JitBlock& block) {
+    // Blocks from JITs that don't hash their code can't be recognized again
+    if (!block.code_hash)
+      return;
+
+    const bool is_trace = jit.js.traceAddresses.count(block.effectiveAddress) != 0;
+    u32 runs = 0;
+    if (is_trace)
+      runs = JitBase::TRACE_THRESHOLD;
+    else if (block.trace_countdown)
+      runs = JitBase::TRACE_THRESHOLD - block.trace_countdown;
+
+    Block& entry = m_blocks[BlockKey(block.effectiveAddress, block.msrBits)];
+    if (entry.code_hash != block.code_hash)
+    {
+      entry = {block.effectiveAddress, block.msrBits, block.code_hash, runs, is_trace};
+    }
+    else
+    {
+      entry.runs = std::max(entry.runs, runs);
+      entry.is_trace |= is_trace;
+    }
+  });
+
+  m_fifo_write_addresses.insert(jit.js.fifoWriteAddresses.begin(),
+                                jit.js.fifoWriteAddresses.end());
+  m_paired_quantize_addresses.insert(jit.js.pairedQuantizeAddresses.begin(),
+                                     jit.js.pairedQuantizeAddresses.end());
+  m_no_speculative_constants_addresses.insert(jit.js.noSpeculativeConstantsAddresses.begin(),
+                                              jit.js.noSpeculativeConstantsAddresses.end());
+  m_slowmem_addresses.insert(jit.js.slowmemAddresses.begin(), jit.js.slowmemAddresses.end());
+  m_likely_taken_branches.insert(jit.js.likelyTakenBranches.begin(),
+                                 jit.js.likelyTakenBranches.end());
+
+  for (size_t i = 0; i < m_gqr.size(); i++)
+    m_gqr[i] = GQR(i);
+}
+
+void JitAnalysisCache::ApplyToBlock(JitBase& jit, const PPCAnalyst::CodeBlock& code_block,
+                                    const PPCAnalyst::CodeOp* ops) const
+{
+  if (m_paired_quantize_addresses.count(code_block.m_address))
+    jit.js.pairedQuantizeAddresses.insert(code_block.m_address);
+  if (m_no_speculative_constants_addresses.count(code_block.m_address))
+    jit.js.noSpeculativeConstantsAddresses.insert(code_block.m_address);
+
+  for (u32 i = 0; i < code_block.m_num_instructions; i++)
+  {
+    const PPCAnalyst::CodeOp& op = ops[i];
+    // A FIFO check anywhere but at a store could separate flags from the branch using them
+    if (IsStore(op) && m_fifo_write_addresses.count(op.address))
+      jit.js.fifoWriteAddresses.insert(op.address);
+    if ((op.opinfo->flags & FL_LOADSTORE) && m_slowmem_addresses.count(op.address))
+      jit.js.slowmemAddresses.insert(op.address);
+  }
+}
+
+void JitAnalysisCache::ApplyLikelyTakenBranches(JitBase& jit) const
+{
+  jit.js.likelyTakenBranches.insert(m_likely_taken_branches.begin(),
+                                    m_likely_taken_branches.end());
+}
+
+void JitAnalysisCache::DoState(PointerWrap& p, u8** ptr, u64 size)
+{
+  const u8* const end = *ptr + size;
+  struct
+  {
+    u32 revision;
+    u64 expected_size;
+  } header = {CACHE_REVISION, size};
+  if (!CanRead(p, sizeof(header), ptr, end))
+    return;
+  p.Do(header);
+  if (p.GetMode() == PointerWrap::MODE_READ)
+  {
+    if (header.revision != CACHE_REVISION || header.expected_size != size)
+    {
+      p.SetMode(PointerWrap::MODE_MEASURE);
+      return;
+    }
+  }
+
+  u32 num_blocks = static_cast<u32>(m_blocks.size());
+  if (!DoCount(p, num_blocks, MAX_SAVED_BLOCKS, sizeof(u64) + sizeof(Block), ptr, end))
+    return;
+  if (p.GetMode() == PointerWrap::MODE_READ)
+  {
+    for (m_blocks.clear(); num_blocks != 0; --num_blocks)
+    {
+      std::pair<u64, Block> entry;
+      p.Do(entry);
+      m_blocks.insert(entry);
+    }
+  }
+  else
+  {
+    for (auto& entry : m_blocks)
+    {
+      p.Do(entry.first);
+      p.Do(entry.second);
+    }
+  }
+
+  for (std::set<u32>* addresses :
+       {&m_fifo_write_addresses, &m_paired_quantize_addresses,
+        &m_no_speculative_constants_addresses, &m_slowmem_addresses, &m_likely_taken_branches})
+  {
+    DoAddresses(p, *addresses, ptr, end);
+  }
+  if (CanRead(p, sizeof(m_gqr), ptr, end))
+    p.Do(m_gqr);
+}
@@ -0,0 +1,71 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+
+class JitBase;
+class PointerWrap;
+
+// Keeps what the JIT learned about a game's code across sessions: the blocks that ran and how
+// hot they were, and the instructions that needed extra checks or the slow memory path. Each
+// block is stored with a hash of its code, so that it is only compiled ahead of time when the
+// code at its address is still the same.
+class JitAnalysisCache
+{
+public:
+  struct Block
+  {
+    u32 address;
+    u32 msr_bits;
+    u64 code_hash;
+    // Runs until it turned into a trace, see JitBase::TRACE_THRESHOLD
+    u32 runs;
+    bool is_trace;
+  };
+
+  static u64 HashCode(const PPCAnalyst::CodeOp* ops, u32 num_instructions);
+
+  // Does nothing for code that isn't from a game with an ID.
+  void Load(const std::string& game_id);
+  void Save();
+  void Clear();
+
+  bool HasBlocks() const { return !m_blocks.empty(); }
+  // Hottest first
+  std::vector<Block> GetHotBlocks() const;
+  const std::array<u32, 8>& GetGQRs() const { return m_gqr; }
+
+  // Adds the blocks the JIT currently has, and the instructions it learned to treat specially.
+  void Record(JitBase& jit);
+
+  // Hands the learned instructions of a block whose code hash matched back to the JIT.
+  void ApplyToBlock(JitBase& jit, const PPCAnalyst::CodeBlock& code_block,
+                    const PPCAnalyst::CodeOp* ops) const;
+  // Conditional branches that traces follow are looked up before a trace is analyzed.
+  void ApplyLikelyTakenBranches(JitBase& jit) const;
+
+private:
+  void DoState(PointerWrap& p, u8** ptr, u64 size);
+
+  std::string m_filename;
+
+  // Indexed by MSR bits << 32 | address
+  std::map<u64, Block> m_blocks;
+  std::set<u32> m_fifo_write_addresses;
+  std::set<u32> m_paired_quantize_addresses;
+  std::set<u32> m_no_speculative_constants_addresses;
+  std::set<u32> m_slowmem_addresses;
+  std::set<u32> m_likely_taken_branches;
+  // Blocks are specialized for the GQR values, which most games set once at boot.
+  std::array<u32, 8> m_gqr{};
+};
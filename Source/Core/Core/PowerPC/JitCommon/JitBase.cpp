@@ -4,6 +4,8 @@
 
 #include "Core/PowerPC/JitCommon/JitBase.h"
 
+#include <mutex>
+
 #include "Common/CommonTypes.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/CPU.h"
@@ -14,6 +16,18 @@ JitBase* g_jit;
 
 const u8* JitBase::Dispatch(JitBase& jit)
 {
+  std::unique_lock<std::mutex> lock(jit.m_cache_lock, std::defer_lock);
+  if (jit.m_background_compile)
+  {
+    // Rather than waiting for a background compile to finish, let Jit() handle the miss
+    if (!lock.try_lock())
+      return nullptr;
+  }
+  else
+  {
+    lock.lock();
+  }
+
   return jit.GetBlockCache()->Dispatch();
 }
 
@@ -48,9 +62,42 @@ bool JitBase::CanMergeNextInstructions(int count) const
   return true;
 }
 
+bool JitBase::IsDataTranslationOn() const
+{
+  // Trampolines are generated on the CPU thread, for the block that is running
+  if (js.generatingTrampoline)
+    return UReg_MSR(MSR).DR;
+  return UReg_MSR(js.curBlock->msrBits).DR;
+}
+
+const PowerPC::BatTable& JitBase::GetDataBATs() const
+{
+  if (js.generatingTrampoline || !js.dataBATs)
+    return PowerPC::dbat_table;
+  return *js.dataBATs;
+}
+
+bool JitBase::IsOptimizableRAMAddress(u32 address) const
+{
+  return PowerPC::IsOptimizableRAMAddress(address, IsDataTranslationOn(), GetDataBATs());
+}
+
+u32 JitBase::IsOptimizableMMIOAccess(u32 address, u32 access_size) const
+{
+  return PowerPC::IsOptimizableMMIOAccess(address, access_size, IsDataTranslationOn(),
+                                          GetDataBATs());
+}
+
+bool JitBase::IsOptimizableGatherPipeWrite(u32 address) const
+{
+  return PowerPC::IsOptimizableGatherPipeWrite(address, IsDataTranslationOn(), GetDataBATs());
+}
+
 void JitBase::UpdateMemoryOptions()
 {
   bool any_watchpoints = PowerPC::memchecks.HasAny();
   jo.fastmem = SConfig::GetInstance().bFastmem && (UReg_MSR(MSR).DR || !any_watchpoints);
   jo.memcheck = SConfig::GetInstance().bMMU || any_watchpoints;
+  // Without the MMU, the BAT check in front of the slow path already catches all RAM accesses
+  jo.hostTLB = SConfig::GetInstance().bMMU && !any_watchpoints;
 }
@@ -8,7 +8,9 @@
 //#define JIT_LOG_GPR     // Enables logging of the PPC general purpose regs
 //#define JIT_LOG_FPR     // Enables logging of the PPC floating point regs
 
+#include <array>
 #include <map>
+#include <mutex>
 #include <unordered_set>
 
 #include "Common/CommonTypes.h"
@@ -19,6 +21,7 @@
 #include "Core/PowerPC/JitCommon/JitAsmCommon.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
 #include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PowerPC.h"
 
 // Use these to control the instruction selection
 // #define INSTRUCTION_START FallBackToInterpreter(inst); return;
@@ -52,6 +55,8 @@ protected:
     bool accurateSinglePrecision;
     bool fastmem;
     bool memcheck;
+    // Probe PowerPC::host_read_tlb and host_write_tlb before calling into the MMU
+    bool hostTLB;
   };
   struct JitState
   {
@@ -95,10 +100,30 @@ protected:
     u8* rewriteStart;
 
     JitBlock* curBlock;
+    // The data BAT table the block being compiled was analyzed with, when that happened on
+    // another thread. The CPU thread's dbat_table otherwise.
+    const PowerPC::BatTable* dataBATs = nullptr;
 
     std::unordered_set<u32> fifoWriteAddresses;
     std::unordered_set<u32> pairedQuantizeAddresses;
     std::unordered_set<u32> noSpeculativeConstantsAddresses;
+    // Loads and stores whose fastmem access faulted, which are compiled with the slow path
+    std::unordered_set<u32> slowmemAddresses;
+
+    // Whether the block being compiled counts its runs and profiles its branches
+    bool profileForTrace;
+    // Blocks that turned hot and are compiled as traces
+    std::unordered_set<u32> traceAddresses;
+    // Conditional branches that traces follow to their target
+    std::unordered_set<u32> likelyTakenBranches;
+
+    // GPRs the block being compiled takes over in host registers, see
+    // Jit64::GetRegisterBinding. They stay bound until the block's exits.
+    BitSet32 registerBinding;
+
+    // Register values when the block was analyzed, which speculative constants are based on
+    std::array<u32, 32> entryGpr;
+    std::array<u32, 8> entryGqr;
   };
 
   PPCAnalyst::CodeBlock code_block;
@@ -108,7 +133,16 @@ protected:
 
   void UpdateMemoryOptions();
 
+  const PowerPC::BatTable& GetDataBATs() const;
+
+  std::mutex m_cache_lock;
+  // Whether blocks are compiled on another thread, which holds m_cache_lock meanwhile
+  bool m_background_compile = false;
+
 public:
+  // Number of runs after which a block is recompiled as a trace
+  static constexpr u32 TRACE_THRESHOLD = 4096;
+
   // This should probably be removed from public:
   JitOptions jo{};
   JitState js{};
@@ -121,6 +155,24 @@ public:
 
   virtual void Jit(u32 em_address) = 0;
 
+  // Held while the block cache or the JIT state is used from outside of Jit(). Only contended
+  // when blocks are compiled on another thread.
+  std::mutex& GetCacheLock() { return m_cache_lock; }
+  bool CompilesInBackground() const { return m_background_compile; }
+  // Whether the code being generated runs with data address translation. Taken from the block
+  // rather than from MSR, which belongs to the CPU thread.
+  bool IsDataTranslationOn() const;
+  // PowerPC's IsOptimizable* checks, for the translation the code being generated runs with
+  bool IsOptimizableRAMAddress(u32 address) const;
+  u32 IsOptimizableMMIOAccess(u32 address, u32 access_size) const;
+  bool IsOptimizableGatherPipeWrite(u32 address) const;
+  // Forgets all blocks, but keeps their code, which may still be running.
+  virtual void ClearSafe() { GetBlockCache()->Clear(); }
+  virtual void InvalidateICache(u32 address, u32 length, bool forced)
+  {
+    GetBlockCache()->InvalidateICache(address, length, forced);
+  }
+
   virtual const CommonAsmRoutinesBase* GetAsmRoutines() = 0;
 
   virtual bool HandleFault(uintptr_t access_address, SContext* ctx) = 0;
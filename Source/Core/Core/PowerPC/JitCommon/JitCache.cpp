@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstring>
 #include <functional>
 #include <map>
@@ -64,6 +65,7 @@ void JitBaseBlockCache::Clear()
 #endif
   m_jit.js.fifoWriteAddresses.clear();
   m_jit.js.pairedQuantizeAddresses.clear();
+  m_deferred_links.clear();
   for (auto& e : block_map)
   {
     DestroyBlock(e.second);
@@ -96,11 +98,15 @@ void JitBaseBlockCache::RunOnBlocks(std::function<void(const JitBlock&)> f)
 
 JitBlock* JitBaseBlockCache::AllocateBlock(u32 em_address)
 {
-  u32 physicalAddress = PowerPC::JitCache_TranslateAddress(em_address).address;
-  JitBlock& b = block_map.emplace(physicalAddress, JitBlock())->second;
+  return AllocateBlock(em_address, PowerPC::JitCache_TranslateAddress(em_address).address, MSR);
+}
+
+JitBlock* JitBaseBlockCache::AllocateBlock(u32 em_address, u32 physical_address, u32 msr)
+{
+  JitBlock& b = block_map.emplace(physical_address, JitBlock())->second;
   b.effectiveAddress = em_address;
-  b.physicalAddress = physicalAddress;
-  b.msrBits = MSR & JIT_CACHE_MSR_MASK;
+  b.physicalAddress = physical_address;
+  b.msrBits = msr & JIT_CACHE_MSR_MASK;
   b.linkData.clear();
   b.fast_block_map_index = 0;
   return &b;
@@ -113,6 +119,36 @@ void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
   fast_block_map[index] = &block;
   block.fast_block_map_index = index;
 
+  AddBlock(block, block_link, physical_addresses);
+  if (block_link)
+    LinkBlock(block);
+}
+
+void JitBaseBlockCache::FinalizeBlockWithDeferredLinks(JitBlock& block, bool block_link,
+                                                       const std::set<u32>& physical_addresses)
+{
+  AddBlock(block, block_link, physical_addresses);
+  if (block_link)
+    m_deferred_links.push_back(&block);
+
+  // The assembly dispatcher reads the fast block map without taking any lock, so the block has
+  // to be complete before it shows up there.
+  size_t index = FastLookupIndexForAddress(block.effectiveAddress);
+  block.fast_block_map_index = index;
+  std::atomic_thread_fence(std::memory_order_release);
+  fast_block_map[index] = &block;
+}
+
+void JitBaseBlockCache::LinkDeferredBlocks()
+{
+  for (JitBlock* block : m_deferred_links)
+    LinkBlock(*block);
+  m_deferred_links.clear();
+}
+
+void JitBaseBlockCache::AddBlock(JitBlock& block, bool block_link,
+                                 const std::set<u32>& physical_addresses)
+{
   block.physical_addresses = physical_addresses;
 
   u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
@@ -128,8 +164,6 @@ void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
     {
       links_to.emplace(e.exitAddress, &block);
     }
-
-    LinkBlock(block);
   }
 
   Symbol* symbol = nullptr;
@@ -269,6 +303,12 @@ void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
   }
 }
 
+void JitBaseBlockCache::MarkValid(const std::set<u32>& physical_addresses)
+{
+  for (u32 addr : physical_addresses)
+    valid_block.Set(addr / 32);
+}
+
 u32* JitBaseBlockCache::GetBlockBitSet() const
 {
   return valid_block.m_valid_block.get();
@@ -360,6 +400,9 @@ void JitBaseBlockCache::DestroyBlock(JitBlock& block)
     }
   }
 
+  m_deferred_links.erase(std::remove(m_deferred_links.begin(), m_deferred_links.end(), &block),
+                         m_deferred_links.end());
+
   // Raise an signal if we are going to call this block again
   WriteDestroyBlock(block);
 }
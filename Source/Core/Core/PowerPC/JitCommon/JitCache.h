@@ -33,6 +33,9 @@ struct JitBlock
   const u8* checkedEntry;
   // The normal entry point for the block, returned by Dispatch().
   const u8* normalEntry;
+  // The entry point for linked exits that hand over the GPRs in register_binding in host
+  // registers. Like checkedEntry, it checks the downcount. Only set if the binding isn't empty.
+  const u8* boundEntry;
 
   // The effective address (PC) for the beginning of the block.
   u32 effectiveAddress;
@@ -58,6 +61,10 @@ struct JitBlock
     u32 exitAddress;
     bool linkStatus;  // is it already linked?
     bool call;
+    // The GPRs this exit keeps in host registers. It can only be linked to a block with the
+    // same register_binding, and goes to fallback, which stores them, otherwise.
+    u32 registerBinding = 0;
+    const u8* fallback = nullptr;
   };
   std::vector<LinkData> linkData;
 
@@ -74,6 +81,27 @@ struct JitBlock
     u64 ticStop;
   } profile_data = {};
 
+  // Runs left until the block is recompiled as a trace. Only counted down by blocks that
+  // aren't traces already.
+  u32 trace_countdown;
+
+  // How often each conditional branch of the block was taken, used to pick the path of the
+  // trace. The storage is reserved before the block is compiled, as the code refers to it.
+  struct BranchProfile
+  {
+    u32 address;
+    u32 taken;
+  };
+  std::vector<BranchProfile> branch_profiles;
+
+  // GPRs that the block takes over in host registers when entered through boundEntry. The
+  // meaning of the bits is up to the JIT.
+  u32 register_binding;
+
+  // Hash of the analyzed instructions, which recognizes the block in a later session. Zero if
+  // the JIT doesn't keep an analysis cache.
+  u64 code_hash;
+
   // This tracks the position if this block within the fast block cache.
   // We allow each block to have only one map entry.
   size_t fast_block_map_index;
@@ -134,7 +162,15 @@ public:
   void RunOnBlocks(std::function<void(const JitBlock&)> f);
 
   JitBlock* AllocateBlock(u32 em_address);
+  // For blocks compiled away from the CPU thread, which must not look at the current MSR or
+  // address translation.
+  JitBlock* AllocateBlock(u32 em_address, u32 physical_address, u32 msr);
   void FinalizeBlock(JitBlock& block, bool block_link, const std::set<u32>& physical_addresses);
+  // Makes the block available to the dispatcher, but leaves linking it to the next call of
+  // LinkDeferredBlocks(), as the linked code may be running on the CPU thread meanwhile.
+  void FinalizeBlockWithDeferredLinks(JitBlock& block, bool block_link,
+                                      const std::set<u32>& physical_addresses);
+  void LinkDeferredBlocks();
 
   // Look for the block in the slow but accurate way.
   // This function shall be used if FastLookupIndexForAddress() failed.
@@ -149,6 +185,9 @@ public:
 
   void InvalidateICache(u32 address, u32 length, bool forced);
   void ErasePhysicalRange(u32 address, u32 length);
+  // Makes icache invalidations of these addresses reach InvalidateICache(), for code that has
+  // been translated somewhere other than in this cache.
+  void MarkValid(const std::set<u32>& physical_addresses);
 
   u32* GetBlockBitSet() const;
 
@@ -159,6 +198,7 @@ private:
   virtual void WriteLinkBlock(const JitBlock::LinkData& source, const JitBlock* dest) = 0;
   virtual void WriteDestroyBlock(const JitBlock& block);
 
+  void AddBlock(JitBlock& block, bool block_link, const std::set<u32>& physical_addresses);
   void LinkBlockExits(JitBlock& block);
   void LinkBlock(JitBlock& block);
   void UnlinkBlock(const JitBlock& block);
@@ -190,4 +230,7 @@ private:
   // This array is indexed with the masked PC and likely holds the correct block id.
   // This is used as a fast cache of block_map used in the assembly dispatcher.
   std::array<JitBlock*, FAST_BLOCK_MAP_ELEMENTS> fast_block_map;  // start_addr & mask -> number
+
+  // Blocks finalized without being linked yet.
+  std::vector<JitBlock*> m_deferred_links;
 };
@@ -7,8 +7,10 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstdio>
+#include <mutex>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -42,7 +44,10 @@ namespace JitInterface
 void DoState(PointerWrap& p)
 {
   if (g_jit && p.GetMode() == PointerWrap::MODE_READ)
+  {
+    std::lock_guard<std::mutex> lock(g_jit->GetCacheLock());
     g_jit->ClearCache();
+  }
 }
 CPUCoreBase* InitJitCore(int core)
 {
@@ -116,6 +121,7 @@ void GetProfileResults(ProfileStats* prof_stats)
     Core::SetState(Core::State::Paused);
 
   QueryPerformanceFrequency((LARGE_INTEGER*)&prof_stats->countsPerSec);
+  std::unique_lock<std::mutex> lock(g_jit->GetCacheLock());
   g_jit->GetBlockCache()->RunOnBlocks([&prof_stats](const JitBlock& block) {
     const auto& data = block.profile_data;
     u64 cost = data.downcountCounter;
@@ -127,6 +133,7 @@ void GetProfileResults(ProfileStats* prof_stats)
     prof_stats->cost_sum += cost;
     prof_stats->timecost_sum += timecost;
   });
+  lock.unlock();
 
   sort(prof_stats->block_stats.begin(), prof_stats->block_stats.end());
   if (old_state == Core::State::Running)
@@ -141,6 +148,7 @@ int GetHostCode(u32* address, const u8** code, u32* code_size)
     return 1;
   }
 
+  std::lock_guard<std::mutex> lock(g_jit->GetCacheLock());
   JitBlock* block = g_jit->GetBlockCache()->GetBlockFromStartAddress(*address, MSR);
   if (!block)
   {
@@ -172,6 +180,40 @@ int GetHostCode(u32* address, const u8** code, u32* code_size)
   return 0;
 }
 
+std::vector<u32> GetBlockAddressesFromHostCode(const std::vector<uintptr_t>& host_addresses)
+{
+  std::vector<u32> block_addresses(host_addresses.size());
+  if (!g_jit)
+    return block_addresses;
+
+  struct CodeRange
+  {
+    uintptr_t start;
+    uintptr_t end;
+    u32 address;
+  };
+  std::vector<CodeRange> ranges;
+  {
+    std::lock_guard<std::mutex> lock(g_jit->GetCacheLock());
+    g_jit->GetBlockCache()->RunOnBlocks([&ranges](const JitBlock& block) {
+      const uintptr_t start = reinterpret_cast<uintptr_t>(block.checkedEntry);
+      ranges.push_back({start, start + block.codeSize, block.effectiveAddress});
+    });
+  }
+  std::sort(ranges.begin(), ranges.end(),
+            [](const CodeRange& a, const CodeRange& b) { return a.start < b.start; });
+
+  for (size_t i = 0; i < host_addresses.size(); i++)
+  {
+    auto it = std::upper_bound(
+        ranges.begin(), ranges.end(), host_addresses[i],
+        [](uintptr_t address, const CodeRange& range) { return address < range.start; });
+    if (it != ranges.begin() && host_addresses[i] < (--it)->end)
+      block_addresses[i] = it->address;
+  }
+  return block_addresses;
+}
+
 bool HandleFault(uintptr_t access_address, SContext* ctx)
 {
   // Prevent nullptr dereference on a crash with no JIT present
@@ -180,6 +222,12 @@ bool HandleFault(uintptr_t access_address, SContext* ctx)
     return false;
   }
 
+  // Only the CPU thread runs JIT code. Don't wait for the lock anywhere else, as the fault may
+  // have happened while it was held.
+  std::unique_lock<std::mutex> lock(g_jit->GetCacheLock(), std::defer_lock);
+  if (Core::IsCPUThread())
+    lock.lock();
+
   return g_jit->HandleFault(access_address, ctx);
 }
 
@@ -190,13 +238,17 @@ bool HandleStackFault()
     return false;
   }
 
+  std::lock_guard<std::mutex> lock(g_jit->GetCacheLock());
   return g_jit->HandleStackFault();
 }
 
 void ClearCache()
 {
-  if (g_jit)
-    g_jit->ClearCache();
+  if (!g_jit)
+    return;
+
+  std::lock_guard<std::mutex> lock(g_jit->GetCacheLock());
+  g_jit->ClearCache();
 }
 void ClearSafe()
 {
@@ -204,14 +256,20 @@ void ClearSafe()
   // inside a JIT'ed block: it clears the instruction cache, but not
   // the JIT'ed code.
   // TODO: There's probably a better way to handle this situation.
-  if (g_jit)
-    g_jit->GetBlockCache()->Clear();
+  if (!g_jit)
+    return;
+
+  std::lock_guard<std::mutex> lock(g_jit->GetCacheLock());
+  g_jit->ClearSafe();
 }
 
 void InvalidateICache(u32 address, u32 size, bool forced)
 {
-  if (g_jit)
-    g_jit->GetBlockCache()->InvalidateICache(address, size, forced);
+  if (!g_jit)
+    return;
+
+  std::lock_guard<std::mutex> lock(g_jit->GetCacheLock());
+  g_jit->InvalidateICache(address, size, forced);
 }
 
 void CompileExceptionCheck(ExceptionType type)
@@ -219,6 +277,7 @@ void CompileExceptionCheck(ExceptionType type)
   if (!g_jit)
     return;
 
+  std::lock_guard<std::mutex> lock(g_jit->GetCacheLock());
   std::unordered_set<u32>* exception_addresses = nullptr;
 
   switch (type)
@@ -247,10 +306,34 @@ void CompileExceptionCheck(ExceptionType type)
 
     // Invalidate the JIT block so that it gets recompiled with the external exception check
     // included.
-    g_jit->GetBlockCache()->InvalidateICache(PC, 4, true);
+    g_jit->InvalidateICache(PC, 4, true);
   }
 }
 
+void CompileTrace()
+{
+  if (!g_jit)
+    return;
+
+  std::lock_guard<std::mutex> lock(g_jit->GetCacheLock());
+  JitBlock* block = g_jit->GetBlockCache()->GetBlockFromStartAddress(PC, MSR);
+  if (!block || g_jit->js.traceAddresses.count(PC))
+    return;
+
+  std::vector<u32> likely_taken_branches;
+  for (const JitBlock::BranchProfile& branch : block->branch_profiles)
+  {
+    if (branch.taken >= JitBase::TRACE_THRESHOLD / 2)
+      likely_taken_branches.push_back(branch.address);
+  }
+
+  // Invalidating the code forgets what was learned about it, so that comes first
+  g_jit->InvalidateICache(PC, 4, true);
+  g_jit->js.traceAddresses.insert(PC);
+  g_jit->js.likelyTakenBranches.insert(likely_taken_branches.begin(),
+                                       likely_taken_branches.end());
+}
+
 void Shutdown()
 {
   if (g_jit)
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Core/MachineContext.h"
@@ -31,6 +32,9 @@ CPUCoreBase* GetCore();
 void WriteProfileResults(const std::string& filename);
 void GetProfileResults(ProfileStats* prof_stats);
 int GetHostCode(u32* address, const u8** code, u32* code_size);
+// Looks up the start addresses of the blocks containing the given host code addresses, or 0 for
+// addresses that aren't in a block.
+std::vector<u32> GetBlockAddressesFromHostCode(const std::vector<uintptr_t>& host_addresses);
 
 // Memory Utilities
 bool HandleFault(uintptr_t access_address, SContext* ctx);
@@ -46,5 +50,9 @@ void InvalidateICache(u32 address, u32 size, bool forced);
 
 void CompileExceptionCheck(ExceptionType type);
 
+// Called by a block that ran JitBase::TRACE_THRESHOLD times. The block at PC gets recompiled as
+// a trace that follows the branches it took on at least half of its runs.
+void CompileTrace();
+
 void Shutdown();
 }
@@ -163,6 +163,12 @@ static void EFB_Write(u32 data, u32 addr)
 BatTable ibat_table;
 BatTable dbat_table;
 
+HostTLB host_read_tlb;
+HostTLB host_write_tlb;
+// Hits of the entries that have been replaced since
+static u64 s_host_tlb_hits;
+static u64 s_host_tlb_translations;
+
 static void GenerateDSIException(u32 _EffectiveAddress, bool _bWrite);
 
 template <XCheckTLBFlag flag, typename T, bool never_translate = false>
@@ -632,18 +638,23 @@ std::string HostGetString(u32 address, size_t size)
 }
 
 bool IsOptimizableRAMAddress(const u32 address)
+{
+  return IsOptimizableRAMAddress(address, UReg_MSR(MSR).DR, dbat_table);
+}
+
+bool IsOptimizableRAMAddress(const u32 address, bool dr, const BatTable& dbat)
 {
   if (PowerPC::memchecks.HasAny())
     return false;
 
-  if (!UReg_MSR(MSR).DR)
+  if (!dr)
     return false;
 
   // TODO: This API needs to take an access size
   //
   // We store whether an access can be optimized to an unchecked access
   // in dbat_table.
-  u32 bat_result = dbat_table[address >> BAT_INDEX_SHIFT];
+  u32 bat_result = dbat[address >> BAT_INDEX_SHIFT];
   return (bat_result & BAT_PHYSICAL_BIT) != 0;
 }
 
@@ -783,17 +794,22 @@ void ClearCacheLine(u32 address)
 }
 
 u32 IsOptimizableMMIOAccess(u32 address, u32 accessSize)
+{
+  return IsOptimizableMMIOAccess(address, accessSize, UReg_MSR(MSR).DR, dbat_table);
+}
+
+u32 IsOptimizableMMIOAccess(u32 address, u32 accessSize, bool dr, const BatTable& dbat)
 {
   if (PowerPC::memchecks.HasAny())
     return 0;
 
-  if (!UReg_MSR(MSR).DR)
+  if (!dr)
     return 0;
 
   // Translate address
   // If we also optimize for TLB mappings, we'd have to clear the
   // JitCache on each TLB invalidation.
-  if (!TranslateBatAddess(dbat_table, &address))
+  if (!TranslateBatAddess(dbat, &address))
     return 0;
 
   // Check whether the address is an aligned address of an MMIO register.
@@ -805,17 +821,22 @@ u32 IsOptimizableMMIOAccess(u32 address, u32 accessSize)
 }
 
 bool IsOptimizableGatherPipeWrite(u32 address)
+{
+  return IsOptimizableGatherPipeWrite(address, UReg_MSR(MSR).DR, dbat_table);
+}
+
+bool IsOptimizableGatherPipeWrite(u32 address, bool dr, const BatTable& dbat)
 {
   if (PowerPC::memchecks.HasAny())
     return false;
 
-  if (!UReg_MSR(MSR).DR)
+  if (!dr)
     return false;
 
   // Translate address, only check BAT mapping.
   // If we also optimize for TLB mappings, we'd have to clear the
   // JitCache on each TLB invalidation.
-  if (!TranslateBatAddess(dbat_table, &address))
+  if (!TranslateBatAddess(dbat, &address))
     return false;
 
   // Check whether the translated address equals the address in WPAR.
@@ -959,6 +980,85 @@ static void GenerateISIException(u32 _EffectiveAddress)
   WARN_LOG(POWERPC, "ISI exception at 0x%08x", PC);
 }
 
+static void ClearHostTLBEntry(HostTLBEntry& entry)
+{
+  s_host_tlb_hits += entry.hits;
+  entry = {HostTLBEntry::INVALID_TAG, 0, 0};
+}
+
+static void ClearHostTLB()
+{
+  for (HostTLB* tlb : {&host_read_tlb, &host_write_tlb})
+  {
+    for (HostTLBEntry& entry : *tlb)
+      ClearHostTLBEntry(entry);
+  }
+}
+
+// The same RAM regions ReadFromHardware and WriteToHardware access directly
+static u8* GetHostPage(u32 physical_page)
+{
+  if ((physical_page & 0xF8000000) == 0x00000000)
+    return &Memory::m_pRAM[physical_page & Memory::RAM_MASK];
+  if (Memory::m_pEXRAM && (physical_page >> 28) == 0x1 &&
+      (physical_page & 0x0FFFFFFF) < Memory::EXRAM_SIZE)
+  {
+    return &Memory::m_pEXRAM[physical_page & 0x0FFFFFFF];
+  }
+  if ((physical_page >> 28) == 0xE && physical_page < 0xE0000000 + Memory::L1_CACHE_SIZE)
+    return &Memory::m_pL1Cache[physical_page & 0x0FFFFFFF];
+  if (Memory::m_pFakeVMEM && (physical_page & 0xFE000000) == 0x7E000000)
+    return &Memory::m_pFakeVMEM[physical_page & Memory::RAM_MASK];
+  return nullptr;
+}
+
+static void UpdateHostTLBEntry(HostTLB& tlb, u32 address, u8* host_page)
+{
+  const u32 page = address & ~(HOST_TLB_PAGE_SIZE - 1);
+  HostTLBEntry& entry = tlb[(address >> HOST_TLB_PAGE_SHIFT) & (HOST_TLB_SIZE - 1)];
+  ClearHostTLBEntry(entry);
+  entry.tag = page;
+  entry.host_offset = reinterpret_cast<uintptr_t>(host_page) - page;
+}
+
+template <const XCheckTLBFlag flag>
+static void UpdateHostTLB(u32 address, u32 physical_address)
+{
+  // Watched addresses have to go through the MMU
+  if (PowerPC::memchecks.HasAny())
+    return;
+
+  u8* host_page = GetHostPage(physical_address & ~(HOST_TLB_PAGE_SIZE - 1));
+  if (!host_page)
+    return;
+
+  UpdateHostTLBEntry(host_read_tlb, address, host_page);
+  if (flag == XCheckTLBFlag::Write)
+    UpdateHostTLBEntry(host_write_tlb, address, host_page);
+}
+
+HostTLBStats GetHostTLBStats()
+{
+  HostTLBStats stats{s_host_tlb_hits, s_host_tlb_translations};
+  for (const HostTLB* tlb : {&host_read_tlb, &host_write_tlb})
+  {
+    for (const HostTLBEntry& entry : *tlb)
+      stats.hits += entry.hits;
+  }
+  return stats;
+}
+
+void ResetHostTLBStats()
+{
+  s_host_tlb_hits = 0;
+  s_host_tlb_translations = 0;
+  for (HostTLB* tlb : {&host_read_tlb, &host_write_tlb})
+  {
+    for (HostTLBEntry& entry : *tlb)
+      entry.hits = 0;
+  }
+}
+
 void SDRUpdated()
 {
   u32 htabmask = SDR1_HTABMASK(PowerPC::ppcState.spr[SPR_SDR]);
@@ -973,6 +1073,7 @@ void SDRUpdated()
   }
   PowerPC::ppcState.pagetable_base = htaborg << 16;
   PowerPC::ppcState.pagetable_hashmask = ((htabmask << 10) | 0x3ff);
+  ClearHostTLB();
 }
 
 enum class TLBLookupResult
@@ -1052,6 +1153,13 @@ void InvalidateTLBEntry(u32 address)
 {
   const u32 entry_index = (address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK;
 
+  // tlbie invalidates a whole congruence class, which is spread over the host TLBs
+  for (u32 i = entry_index; i < HOST_TLB_SIZE; i += HW_PAGE_INDEX_MASK + 1)
+  {
+    ClearHostTLBEntry(host_read_tlb[i]);
+    ClearHostTLBEntry(host_write_tlb[i]);
+  }
+
   TLBEntry& tlbe = ppcState.tlb[0][entry_index];
   tlbe.tag[0] = TLBEntry::INVALID_TAG;
   tlbe.tag[1] = TLBEntry::INVALID_TAG;
@@ -1247,6 +1355,7 @@ static void UpdateFakeMMUBat(BatTable& bat_table, u32 start_addr)
 void DBATUpdated()
 {
   dbat_table = {};
+  ClearHostTLB();
   UpdateBATs(dbat_table, SPR_DBAT0U);
   bool extended_bats = SConfig::GetInstance().bWii && HID4.SBE;
   if (extended_bats)
@@ -1289,10 +1398,20 @@ void IBATUpdated()
 template <const XCheckTLBFlag flag>
 static TranslateAddressResult TranslateAddress(u32 address)
 {
-  if (TranslateBatAddess(IsOpcodeFlag(flag) ? ibat_table : dbat_table, &address))
-    return TranslateAddressResult{TranslateAddressResult::BAT_TRANSLATED, address};
+  u32 bat_address = address;
+  TranslateAddressResult result;
+  if (TranslateBatAddess(IsOpcodeFlag(flag) ? ibat_table : dbat_table, &bat_address))
+    result = TranslateAddressResult{TranslateAddressResult::BAT_TRANSLATED, bat_address};
+  else
+    result = TranslatePageAddress(address, flag);
 
-  return TranslatePageAddress(address, flag);
+  if (flag == XCheckTLBFlag::Read || flag == XCheckTLBFlag::Write)
+  {
+    s_host_tlb_translations++;
+    if (result.Success())
+      UpdateHostTLB<flag>(address, result.address);
+  }
+  return result;
 }
 
 }  // namespace
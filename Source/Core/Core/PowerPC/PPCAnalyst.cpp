@@ -38,6 +38,8 @@ constexpr int CODEBUFFER_SIZE = 32000;
 
 // 0 does not perform block merging
 constexpr u32 BRANCH_FOLLOWING_THRESHOLD = 2;
+// Conditional branches a trace follows at most
+constexpr u32 TRACE_FOLLOWING_THRESHOLD = 8;
 
 constexpr u32 INVALID_BRANCH_TARGET = 0xFFFFFFFF;
 
@@ -711,6 +713,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
   bool found_call = false;
   size_t caller = 0;
   u32 numFollows = 0;
+  u32 numTraceFollows = 0;
   u32 num_inst = 0;
 
   for (u32 i = 0; i < blockSize; ++i)
@@ -755,8 +758,8 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
         // Always follow BX instructions.
         // TODO: Loop unrolling might bloat the code size too much.
         //       Enable it carefully.
-        follow = destination != block->m_address;
         destination = SignExt26(inst.LI << 2) + (inst.AA ? 0 : address);
+        follow = destination != block->m_address;
         if (inst.LK)
         {
           found_call = true;
@@ -832,10 +835,31 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
       }
     }
 
+    if (conditional_continue && m_likely_taken_branches && inst.OPCD == 16 && !inst.LK &&
+        blockSize > 1 && numTraceFollows < TRACE_FOLLOWING_THRESHOLD &&
+        m_likely_taken_branches->count(address))
+    {
+      // Continue the trace at the target of a usually taken branch. Targets that are already
+      // part of the block (loops) end the trace, rather than being unrolled.
+      const u32 target = SignExt16(inst.BD << 2) + (inst.AA ? 0 : address);
+      const bool visited = std::any_of(code, code + i, [target](const CodeOp& op) {
+        return op.address == target;
+      });
+      if (!visited && target != address)
+      {
+        follow = true;
+        destination = target;
+        code[i].branchFollowed = true;
+        found_call = false;
+        numTraceFollows++;
+      }
+    }
+
     if (follow)
     {
       // Follow the unconditional branch.
-      numFollows++;
+      if (!code[i].branchFollowed)
+        numFollows++;
       address = destination;
     }
     else
@@ -969,7 +993,88 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
   block->m_gqr_used = gqrUsed;
   block->m_gqr_modified = gqrModified;
   block->m_gpr_inputs = gprBlockInputs;
+
+  if (IsBusyWaitLoop(block, code, block->m_num_instructions))
+    DEBUG_LOG(DYNA_REC, "Busy-wait loop at %08x", block->m_address);
   return address;
 }
 
+// Games poll the VI, DSP and other MMIO registers, or flags in memory that an interrupt handler
+// sets, in loops that do nothing but load and compare. Such a loop can't get anywhere until an
+// event changes what it reads, so the JIT skips ahead to the next event when it loops.
+//
+// The loop has to start at the beginning of the block and may only load, compute and branch,
+// along the path the analyzer followed. Every iteration must compute the same from the same
+// memory, so the registers and CR fields it reads before setting them must not be set in the
+// loop. Loads with update and counting down CTR are rejected by that, and so are delay loops.
+bool PPCAnalyzer::IsBusyWaitLoop(CodeBlock* block, CodeOp* code, u32 instructions) const
+{
+  BitSet32 gpr_read, gpr_written;
+  BitSet8 cr_read, cr_written;
+  for (u32 i = 0; i < instructions; i++)
+  {
+    CodeOp& op = code[i];
+    const UGeckoInstruction inst = op.inst;
+
+    // bx and bcx are in the tables as system instructions
+    const bool is_branch = inst.OPCD == 16 || inst.OPCD == 18 || op.opinfo->type == OpType::Branch;
+    if (is_branch)
+    {
+      // Followed returns don't leave the loop
+      if (op.skip)
+        continue;
+
+      const bool conditional = inst.OPCD != 18 && !(inst.BO & BO_DONT_CHECK_CONDITION);
+      if (inst.OPCD != 18 && !(inst.BO & BO_DONT_DECREMENT_FLAG))
+        return false;
+      if (conditional && !cr_written[inst.BI >> 2])
+        cr_read[inst.BI >> 2] = true;
+
+      u32 target;
+      if (inst.OPCD == 18)
+        target = SignExt26(inst.LI << 2) + (inst.AA ? 0 : op.address);
+      else if (inst.OPCD == 16)
+        target = SignExt16(inst.BD << 2) + (inst.AA ? 0 : op.address);
+      else if (conditional && !inst.LK)
+        continue;  // A conditional bclr or bcctr leaves the loop
+      else
+        return false;
+
+      if (target == block->m_address && !inst.LK)
+      {
+        if ((gpr_read & gpr_written) || (cr_read & cr_written))
+          return false;
+        op.branchIsIdleLoop = true;
+        return true;
+      }
+      // Any other branch was either followed, or leaves the loop. The block ends at branches
+      // that are neither.
+      continue;
+    }
+
+    if (op.opinfo->type == OpType::Load)
+    {
+      // lwarx sets a reservation
+      if (inst.OPCD == 31 && inst.SUBOP10 == 20)
+        return false;
+    }
+    else if (op.opinfo->type != OpType::Integer)
+    {
+      return false;
+    }
+    if (op.opinfo->flags & (FL_READ_CA | FL_SET_OE))
+      return false;
+
+    gpr_read |= op.regsIn & ~gpr_written;
+    gpr_written |= op.regsOut;
+    if (op.outputCR0)
+      cr_written[0] = true;
+    if (op.outputCR1)
+      cr_written[1] = true;
+    if (op.opinfo->flags & FL_SET_CRn)
+      cr_written[inst.CRFD] = true;
+  }
+  return false;
+}
+
 }  // namespace
@@ -9,6 +9,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "Common/BitSet.h"
@@ -44,6 +45,11 @@ struct CodeOp  // 16B
   bool canEndBlock;
   bool skipLRStack;
   bool skip;  // followed BL-s for example
+  // A conditional branch whose target the block continues at. The block is left at the next
+  // instruction when the branch isn't taken.
+  bool branchFollowed;
+  // A branch back to the start of a busy-wait loop, see PPCAnalyzer::IsBusyWaitLoop.
+  bool branchIsIdleLoop;
   // which registers are still needed after this instruction in this block
   BitSet32 fprInUse;
   BitSet32 gprInUse;
@@ -177,9 +183,11 @@ private:
   void ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse, ReorderType type);
   void ReorderInstructions(u32 instructions, CodeOp* code);
   void SetInstructionStats(CodeBlock* block, CodeOp* code, const GekkoOPInfo* opinfo, u32 index);
+  bool IsBusyWaitLoop(CodeBlock* block, CodeOp* code, u32 instructions) const;
 
   // Options
   u32 m_options;
+  const std::unordered_set<u32>* m_likely_taken_branches = nullptr;
 
 public:
   enum AnalystOption
@@ -225,6 +233,13 @@ public:
   void SetOption(AnalystOption option) { m_options |= option; }
   void ClearOption(AnalystOption option) { m_options &= ~(option); }
   bool HasOption(AnalystOption option) const { return !!(m_options & option); }
+  // Conditional branches (by address) that are followed to their target like unconditional
+  // ones, turning the block into a trace along the usual path. Requires
+  // OPTION_CONDITIONAL_CONTINUE and JIT support for CodeOp::branchFollowed.
+  void SetLikelyTakenBranches(const std::unordered_set<u32>* branches)
+  {
+    m_likely_taken_branches = branches;
+  }
   u32 Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32 blockSize);
 };
 
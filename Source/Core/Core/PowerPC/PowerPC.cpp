@@ -4,6 +4,7 @@
 
 #include "Core/PowerPC/PowerPC.h"
 
+#include <cinttypes>
 #include <cstring>
 #include <vector>
 
@@ -23,6 +24,7 @@
 #include "Core/PowerPC/CPUCoreBase.h"
 #include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/SamplingProfiler.h"
 
 namespace PowerPC
 {
@@ -219,6 +221,7 @@ void Init(int cpu_core)
 
   InitializeCPUCore(cpu_core);
   ppcState.iCache.Init();
+  ResetHostTLBStats();
 
   if (SConfig::GetInstance().bEnableDebugging)
     breakpoints.ClearAllTemporary();
@@ -258,6 +261,15 @@ void ScheduleInvalidateCacheThreadSafe(u32 address)
 
 void Shutdown()
 {
+  const HostTLBStats tlb_stats = GetHostTLBStats();
+  if (tlb_stats.hits)
+  {
+    INFO_LOG(POWERPC, "Host TLB: %" PRIu64 " hits, %" PRIu64 " translations (%.1f%% hits)",
+             tlb_stats.hits, tlb_stats.translations,
+             100.0 * tlb_stats.hits / (tlb_stats.hits + tlb_stats.translations));
+  }
+
+  SamplingProfiler::Stop();
   InjectExternalCPUCore(nullptr);
   JitInterface::Shutdown();
   s_interpreter->Shutdown();
@@ -321,6 +321,44 @@ inline bool TranslateBatAddess(const BatTable& bat_table, u32* address)
   return true;
 }
 
+// The IsOptimizable* checks for a given MSR.DR and data BAT table, for code that is compiled
+// away from the CPU thread.
+bool IsOptimizableRAMAddress(u32 address, bool dr, const BatTable& dbat);
+u32 IsOptimizableMMIOAccess(u32 address, u32 accessSize, bool dr, const BatTable& dbat);
+bool IsOptimizableGatherPipeWrite(u32 address, bool dr, const BatTable& dbat);
+
+// Direct-mapped caches of data translations to host memory, one for reads and one for writes,
+// which the JIT probes inline before calling into the MMU. They are filled by the MMU with pages
+// of RAM only, so that a hit never needs more than a host access. Write entries are only added
+// once the page's C bit is set.
+constexpr int HOST_TLB_PAGE_SHIFT = 12;
+constexpr u32 HOST_TLB_PAGE_SIZE = 1 << HOST_TLB_PAGE_SHIFT;
+constexpr u32 HOST_TLB_SIZE = 4096;
+struct HostTLBEntry
+{
+  // No effective page address has its low bits set
+  static constexpr u32 INVALID_TAG = 1;
+
+  // The effective page address
+  u32 tag = INVALID_TAG;
+  // Counted by the JIT
+  u32 hits = 0;
+  // The host address of the page minus its effective address
+  uintptr_t host_offset = 0;
+};
+using HostTLB = std::array<HostTLBEntry, HOST_TLB_SIZE>;
+extern HostTLB host_read_tlb;
+extern HostTLB host_write_tlb;
+
+struct HostTLBStats
+{
+  u64 hits;
+  // Data accesses that went through the MMU instead, whether or not they were cacheable
+  u64 translations;
+};
+HostTLBStats GetHostTLBStats();
+void ResetHostTLBStats();
+
 enum CRBits
 {
   CR_SO = 1,
@@ -0,0 +1,387 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/SamplingProfiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>  // Needed for _POSIX_VERSION
+#endif
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/Swap.h"
+#include "Common/SymbolDB.h"
+#include "Common/Thread.h"
+#include "Core/HW/Memmap.h"
+#include "Core/MachineContext.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
+#include "Core/PowerPC/PowerPC.h"
+
+namespace SamplingProfiler
+{
+namespace
+{
+// Deep enough for the call chains of most games, and what the debugger's call stack shows
+constexpr u32 MAX_STACK_DEPTH = 20;
+// The samples are resolved often enough that this only fills up when the JIT lock is busy
+constexpr u32 SAMPLE_BUFFER_SIZE = 1024;
+constexpr std::chrono::milliseconds PROCESSING_INTERVAL{250};
+
+struct Sample
+{
+  uintptr_t host_pc;
+  u32 pc;
+  u32 lr;
+  u32 depth;
+  std::array<u32, MAX_STACK_DEPTH> return_addresses;
+};
+
+// Written by the CPU thread while it is interrupted, read by whoever holds s_cpu_thread_lock.
+std::array<Sample, SAMPLE_BUFFER_SIZE> s_samples;
+std::atomic<u32> s_write_index{0};
+std::atomic<u32> s_read_index{0};
+std::atomic<u32> s_dropped_samples{0};
+
+std::mutex s_cpu_thread_lock;
+bool s_cpu_thread_registered = false;
+#ifdef _WIN32
+HANDLE s_cpu_thread = nullptr;
+#else
+pthread_t s_cpu_thread;
+#endif
+
+std::thread s_sampler_thread;
+std::condition_variable s_stop_cvar;
+bool s_stop_requested = false;
+
+std::mutex s_results_lock;
+std::map<std::string, u64> s_stacks;
+}  // Anonymous namespace
+
+// Only reads the mirrors of MEM1, where games keep their stacks. Going through the MMU isn't
+// possible while the CPU thread is interrupted.
+static bool ReadStackWord(u32 address, u32* value)
+{
+  if ((address >> 28) != 0x8 && (address >> 28) != 0xC)
+    return false;
+  const u32 offset = address & 0x0FFFFFFF;
+  if ((offset & 3) || offset > Memory::REALRAM_SIZE - 4 || !Memory::m_pRAM)
+    return false;
+
+  u32 word;
+  std::memcpy(&word, Memory::m_pRAM + offset, sizeof(word));
+  *value = Common::swap32(word);
+  return true;
+}
+
+// Runs on the interrupted CPU thread, so it must not lock or allocate. The guest registers are
+// taken from ppcState, which is how the JIT left them at the last flush; r1 may lag behind a
+// block that is setting up a stack frame, which only costs a frame here and there.
+static void CaptureSample(uintptr_t host_pc)
+{
+  const u32 write = s_write_index.load(std::memory_order_relaxed);
+  if (write - s_read_index.load(std::memory_order_acquire) == SAMPLE_BUFFER_SIZE)
+  {
+    s_dropped_samples.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  Sample& sample = s_samples[write % SAMPLE_BUFFER_SIZE];
+  sample.host_pc = host_pc;
+  sample.pc = PowerPC::ppcState.pc;
+  sample.lr = LR;
+  sample.depth = 0;
+
+  // The same walk as Dolphin_Debugger::GetCallstack
+  u32 frame;
+  if (ReadStackWord(PowerPC::ppcState.gpr[1], &frame))
+  {
+    u32 return_address;
+    while (frame && sample.depth < MAX_STACK_DEPTH && ReadStackWord(frame + 4, &return_address))
+    {
+      sample.return_addresses[sample.depth++] = return_address;
+      if (!ReadStackWord(frame, &frame))
+        break;
+    }
+  }
+
+  s_write_index.store(write + 1, std::memory_order_release);
+}
+
+#ifdef _WIN32
+
+static void RequestSample()
+{
+  if (SuspendThread(s_cpu_thread) == static_cast<DWORD>(-1))
+    return;
+
+  CONTEXT context;
+  context.ContextFlags = CONTEXT_CONTROL;
+  if (GetThreadContext(s_cpu_thread, &context))
+    CaptureSample(static_cast<uintptr_t>(context.CTX_RIP));
+  ResumeThread(s_cpu_thread);
+}
+
+static void InstallSignalHandler()
+{
+}
+
+#elif defined(_POSIX_VERSION) && !defined(_M_GENERIC)
+
+static uintptr_t GetHostPC(ucontext_t* context)
+{
+#if defined(__APPLE__)
+  return static_cast<uintptr_t>(context->uc_mcontext->__ss.__rip);
+#elif defined(__OpenBSD__)
+  return static_cast<uintptr_t>(context->CTX_RIP);
+#elif _M_ARM_64
+  return static_cast<uintptr_t>(context->uc_mcontext.CTX_PC);
+#else
+  return static_cast<uintptr_t>(context->uc_mcontext.CTX_RIP);
+#endif
+}
+
+static void SampleSignalHandler(int, siginfo_t*, void* raw_context)
+{
+  const int saved_errno = errno;
+  CaptureSample(GetHostPC(static_cast<ucontext_t*>(raw_context)));
+  errno = saved_errno;
+}
+
+static void RequestSample()
+{
+  pthread_kill(s_cpu_thread, SIGPROF);
+}
+
+// The handler stays installed after the profiler stops, as a signal may still be on its way.
+static void InstallSignalHandler()
+{
+  static std::once_flag s_installed;
+  std::call_once(s_installed, [] {
+    struct sigaction sa;
+    sa.sa_handler = nullptr;
+    sa.sa_sigaction = &SampleSignalHandler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF, &sa, nullptr);
+  });
+}
+
+#else  // _M_GENERIC or unsupported platform
+
+static void RequestSample()
+{
+}
+
+static void InstallSignalHandler()
+{
+}
+
+#endif
+
+static std::string GetFrameName(u32 address)
+{
+  const Symbol* symbol = g_symbolDB.GetSymbolFromAddr(address);
+  if (!symbol)
+    return StringFromFormat("%08x", address);
+
+  // Semicolons separate the frames of a folded stack
+  std::string name = symbol->name;
+  std::replace(name.begin(), name.end(), ';', ':');
+  return name;
+}
+
+// Frames are given innermost first and folded outermost first. Consecutive frames in the same
+// function are merged, as LR and the back chain often point into the same caller.
+static std::string FoldStack(const std::vector<u32>& frames)
+{
+  std::string stack;
+  std::string last_name;
+  for (auto it = frames.rbegin(); it != frames.rend(); ++it)
+  {
+    std::string name = GetFrameName(*it);
+    if (name == last_name)
+      continue;
+    if (!stack.empty())
+      stack += ';';
+    stack += name;
+    last_name = std::move(name);
+  }
+  return stack;
+}
+
+// Requires s_cpu_thread_lock, which keeps the JIT from going away while the host PCs are mapped
+// to its blocks.
+static void ProcessSamples()
+{
+  const u32 read = s_read_index.load(std::memory_order_relaxed);
+  const u32 write = s_write_index.load(std::memory_order_acquire);
+  if (read == write)
+    return;
+
+  std::vector<uintptr_t> host_pcs;
+  host_pcs.reserve(write - read);
+  for (u32 i = read; i != write; i++)
+    host_pcs.push_back(s_samples[i % SAMPLE_BUFFER_SIZE].host_pc);
+  const std::vector<u32> block_addresses = JitInterface::GetBlockAddressesFromHostCode(host_pcs);
+
+  std::vector<u32> frames;
+  std::lock_guard<std::mutex> lock(s_results_lock);
+  for (u32 i = 0; i < write - read; i++)
+  {
+    const Sample& sample = s_samples[(read + i) % SAMPLE_BUFFER_SIZE];
+
+    // Outside of the JIT's blocks, e.g. in the interpreter or HLE, PC is exact
+    frames.clear();
+    frames.push_back(block_addresses[i] ? block_addresses[i] : sample.pc);
+    // Return addresses point past the call
+    if (sample.lr)
+      frames.push_back(sample.lr - 4);
+    for (u32 j = 0; j < sample.depth; j++)
+    {
+      if (sample.return_addresses[j])
+        frames.push_back(sample.return_addresses[j] - 4);
+    }
+    s_stacks[FoldStack(frames)]++;
+  }
+
+  s_read_index.store(write, std::memory_order_release);
+}
+
+static void SamplerThread(std::chrono::microseconds interval)
+{
+  Common::SetCurrentThreadName("Sampling profiler");
+
+  auto next_processing = std::chrono::steady_clock::now() + PROCESSING_INTERVAL;
+  std::unique_lock<std::mutex> lock(s_cpu_thread_lock);
+  while (!s_stop_cvar.wait_for(lock, interval, [] { return s_stop_requested; }))
+  {
+    if (!s_cpu_thread_registered)
+      continue;
+
+    RequestSample();
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= next_processing)
+    {
+      ProcessSamples();
+      next_processing = now + PROCESSING_INTERVAL;
+    }
+  }
+}
+
+void Start(u32 interval_us)
+{
+  if (s_sampler_thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(s_results_lock);
+    s_stacks.clear();
+  }
+  s_read_index.store(s_write_index.load());
+  s_dropped_samples.store(0);
+
+  InstallSignalHandler();
+  s_stop_requested = false;
+  s_sampler_thread = std::thread(SamplerThread, std::chrono::microseconds(interval_us));
+}
+
+void Stop()
+{
+  if (!s_sampler_thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(s_cpu_thread_lock);
+    s_stop_requested = true;
+  }
+  s_stop_cvar.notify_one();
+  s_sampler_thread.join();
+
+  std::lock_guard<std::mutex> lock(s_cpu_thread_lock);
+  if (s_cpu_thread_registered)
+    ProcessSamples();
+
+  const u32 dropped_samples = s_dropped_samples.load();
+  if (dropped_samples)
+    WARN_LOG(POWERPC, "The sampling profiler dropped %u samples", dropped_samples);
+}
+
+bool IsRunning()
+{
+  return s_sampler_thread.joinable();
+}
+
+void WriteResults(const std::string& filename)
+{
+  std::vector<std::pair<std::string, u64>> stacks;
+  {
+    std::lock_guard<std::mutex> lock(s_results_lock);
+    stacks.assign(s_stacks.begin(), s_stacks.end());
+  }
+  std::stable_sort(stacks.begin(), stacks.end(),
+                   [](const auto& a, const auto& b) { return a.second > b.second; });
+
+  File::IOFile f(filename, "w");
+  if (!f)
+  {
+    PanicAlert("Failed to open %s", filename.c_str());
+    return;
+  }
+  for (const auto& stack : stacks)
+    fprintf(f.GetHandle(), "%s %" PRIu64 "\n", stack.first.c_str(), stack.second);
+}
+
+void RegisterCPUThread()
+{
+  std::lock_guard<std::mutex> lock(s_cpu_thread_lock);
+#ifdef _WIN32
+  s_cpu_thread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT, FALSE,
+                            GetCurrentThreadId());
+  s_cpu_thread_registered = s_cpu_thread != nullptr;
+#else
+  s_cpu_thread = pthread_self();
+  s_cpu_thread_registered = true;
+#endif
+}
+
+void UnregisterCPUThread()
+{
+  std::lock_guard<std::mutex> lock(s_cpu_thread_lock);
+  if (!s_cpu_thread_registered)
+    return;
+
+  // The host PCs can only be mapped to blocks while the JIT is still around
+  ProcessSamples();
+  s_cpu_thread_registered = false;
+#ifdef _WIN32
+  CloseHandle(s_cpu_thread);
+  s_cpu_thread = nullptr;
+#endif
+}
+}  // namespace SamplingProfiler
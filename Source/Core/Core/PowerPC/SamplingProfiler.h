@@ -0,0 +1,27 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+// Periodically interrupts the CPU thread to see which guest code it is running, instead of
+// instrumenting the blocks like the block profiler does. The host PC of each sample is mapped
+// back to its JIT block, and the guest call stack is taken from LR and the stack back chain, so
+// the results show which game functions the host CPU time goes to.
+namespace SamplingProfiler
+{
+void Start(u32 interval_us = 1000);
+void Stop();
+bool IsRunning();
+
+// Writes the sampled call stacks in the folded format read by flamegraph.pl, hottest first.
+void WriteResults(const std::string& filename);
+
+// The CPU thread is only sampled while it is running guest code.
+void RegisterCPUThread();
+void UnregisterCPUThread();
+}
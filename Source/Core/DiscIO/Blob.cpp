@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <string>
@@ -16,6 +17,7 @@
 #include "DiscIO/Blob.h"
 #include "DiscIO/CISOBlob.h"
 #include "DiscIO/CompressedBlob.h"
+#include "DiscIO/DCXBlob.h"
 #include "DiscIO/DirectoryBlob.h"
 #include "DiscIO/DriveBlob.h"
 #include "DiscIO/FileBlob.h"
@@ -27,9 +29,13 @@ namespace DiscIO
 void SectorReader::SetSectorSize(int blocksize)
 {
   m_block_size = std::max(blocksize, 0);
+  m_cache.resize(CACHE_LINES);
+  m_cache_index.clear();
+  m_cache_index.reserve(CACHE_LINES);
   for (auto& cache_entry : m_cache)
   {
-    cache_entry.Reset();
+    cache_entry.chunk_idx = 0;
+    cache_entry.num_blocks = 0;
     cache_entry.data.resize(m_chunk_blocks * m_block_size);
   }
 }
@@ -45,53 +51,82 @@ SectorReader::~SectorReader()
 {
 }
 
-const SectorReader::Cache* SectorReader::FindCacheLine(u64 block_num)
+const SectorReader::Cache* SectorReader::FindCacheLine(u64 chunk_idx)
 {
-  auto itr = std::find_if(m_cache.begin(), m_cache.end(),
-                          [&](const Cache& entry) { return entry.Contains(block_num); });
-  if (itr == m_cache.end())
+  auto itr = m_cache_index.find(chunk_idx);
+  if (itr == m_cache_index.end())
     return nullptr;
 
-  itr->MarkUsed();
-  return &*itr;
+  m_cache.splice(m_cache.begin(), m_cache, itr->second);
+  return &*itr->second;
 }
 
 SectorReader::Cache* SectorReader::GetEmptyCacheLine()
 {
-  Cache* oldest = &m_cache[0];
-  // Find the Least Recently Used cache line to replace.
-  std::for_each(m_cache.begin() + 1, m_cache.end(), [&](Cache& line) {
-    if (line.IsLessRecentlyUsedThan(*oldest))
-    {
-      oldest->ShiftLRU();
-      oldest = &line;
-      return;
-    }
-    line.ShiftLRU();
-  });
-  oldest->Reset();
-  return oldest;
+  Cache& oldest = m_cache.back();
+  if (oldest.num_blocks)
+    m_cache_index.erase(oldest.chunk_idx);
+  oldest.chunk_idx = 0;
+  oldest.num_blocks = 0;
+
+  m_cache.splice(m_cache.begin(), m_cache, std::prev(m_cache.end()));
+  return &m_cache.front();
 }
 
 const SectorReader::Cache* SectorReader::GetCacheLine(u64 block_num)
 {
-  if (auto entry = FindCacheLine(block_num))
-    return entry;
-
-  // Cache miss. Fault in the missing entry.
-  Cache* cache = GetEmptyCacheLine();
   // We only read aligned chunks, this avoids duplicate overlapping entries.
-  u64 chunk_idx = block_num / m_chunk_blocks;
-  u32 blocks_read = ReadChunk(cache->data.data(), chunk_idx);
-  if (!blocks_read)
-    return nullptr;
-  cache->Fill(chunk_idx * m_chunk_blocks, blocks_read);
+  const u64 chunk_idx = block_num / m_chunk_blocks;
+  const Cache* cache = FindCacheLine(chunk_idx);
+  if (!cache)
+  {
+    // Cache miss. Fault in the missing entry.
+    Cache* empty = GetEmptyCacheLine();
+    u32 blocks_read = ReadChunk(empty->data.data(), chunk_idx);
+    if (!blocks_read)
+    {
+      // Hand the unused line back so that it is the next one to be reused.
+      m_cache.splice(m_cache.end(), m_cache, m_cache.begin());
+      return nullptr;
+    }
+    empty->chunk_idx = chunk_idx;
+    empty->num_blocks = blocks_read;
+    m_cache_index.emplace(chunk_idx, m_cache.begin());
+    cache = empty;
+  }
 
   // Secondary check for out-of-bounds read.
   // If we got less than m_chunk_blocks, we may still have missed.
   // We do this after the cache fill since the cache line itself is
   // fine, the problem is being asked to read past the end of the disk.
-  return cache->Contains(block_num) ? cache : nullptr;
+  return block_num - chunk_idx * m_chunk_blocks < cache->num_blocks ? cache : nullptr;
+}
+
+u64 SectorReader::ReadUncachedBlocks(u64 block_num, u64 max_blocks, u8* out_ptr)
+{
+  // Partial chunks are left to the cache, which reads the whole chunk anyway.
+  if (block_num % m_chunk_blocks != 0)
+    return 0;
+
+  // The disc size may be unknown for real disks, in which case ReadChunk has to probe it.
+  const u64 data_size = GetDataSize();
+  if (!data_size)
+    return 0;
+  const u64 end_block = (data_size + m_block_size - 1) / m_block_size;
+  if (block_num >= end_block)
+    return 0;
+
+  const u64 first_chunk = block_num / m_chunk_blocks;
+  const u64 max_chunks = std::min(max_blocks, end_block - block_num) / m_chunk_blocks;
+  u64 num_chunks = 0;
+  while (num_chunks < max_chunks && !IsChunkCached(first_chunk + num_chunks))
+    ++num_chunks;
+
+  if (num_chunks < MIN_UNCACHED_READ_CHUNKS)
+    return 0;
+
+  const u64 num_blocks = num_chunks * m_chunk_blocks;
+  return ReadMultipleAlignedBlocks(block_num, num_blocks, out_ptr) ? num_blocks : 0;
 }
 
 bool SectorReader::Read(u64 offset, u64 size, u8* out_ptr)
@@ -104,12 +139,27 @@ bool SectorReader::Read(u64 offset, u64 size, u8* out_ptr)
   {
     block = offset / m_block_size;
 
+    if (position_in_block == 0 && remain >= m_block_size)
+    {
+      const u64 blocks_read = ReadUncachedBlocks(block, remain / m_block_size, out_ptr);
+      if (blocks_read)
+      {
+        const u64 bytes_read = blocks_read * m_block_size;
+        offset += bytes_read;
+        out_ptr += bytes_read;
+        remain -= bytes_read;
+        continue;
+      }
+    }
+
     const Cache* cache = GetCacheLine(block);
     if (!cache)
       return false;
 
     // Cache entries are aligned chunks, we may not want to read from the start
-    u32 read_offset = static_cast<u32>(block - cache->block_idx) * m_block_size + position_in_block;
+    u32 read_offset =
+        static_cast<u32>(block - cache->chunk_idx * m_chunk_blocks) * m_block_size +
+        position_in_block;
     u32 can_read = m_block_size * cache->num_blocks - read_offset;
     u32 was_read = static_cast<u32>(std::min<u64>(can_read, remain));
 
@@ -202,6 +252,8 @@ std::unique_ptr<BlobReader> CreateBlobReader(const std::string& filename)
     return TGCFileReader::Create(std::move(file));
   case WBFS_MAGIC:
     return WbfsFileReader::Create(std::move(file), filename);
+  case DCX_MAGIC:
+    return DCXFileReader::Create(std::move(file), filename);
   default:
     if (auto directory_blob = DirectoryBlobReader::Create(filename))
       return std::move(directory_blob);
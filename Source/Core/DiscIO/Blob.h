@@ -15,9 +15,11 @@
 // automatically do the right thing.
 
 #include <array>
+#include <list>
 #include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -34,7 +36,8 @@ enum class BlobType
   GCZ,
   CISO,
   WBFS,
-  TGC
+  TGC,
+  DCX
 };
 
 class BlobReader
@@ -98,43 +101,20 @@ private:
   struct Cache
   {
     std::vector<u8> data;
-    u64 block_idx = 0;
+    u64 chunk_idx = 0;
+    // Zero if the line does not hold any data
     u32 num_blocks = 0;
-
-    // [Pseudo-] Least Recently Used Shift Register
-    // When an empty cache line is needed, the line with the lowest value
-    // is taken and reset; the LRU register is then shifted down 1 place
-    // on all lines (low bit discarded). When a line is used, the high bit
-    // is set marking it as most recently used.
-    u32 lru_sreg = 0;
-
-    void Reset()
-    {
-      block_idx = 0;
-      num_blocks = 0;
-      lru_sreg = 0;
-    }
-    void Fill(u64 block, u32 count)
-    {
-      block_idx = block;
-      num_blocks = count;
-      // NOTE: Setting only the high bit means the newest line will
-      //   be selected for eviction if every line in the cache was
-      //   touched. This gives MRU behavior which is probably
-      //   desirable in that case.
-      MarkUsed();
-    }
-    bool Contains(u64 block) const { return block >= block_idx && block - block_idx < num_blocks; }
-    void MarkUsed() { lru_sreg |= 0x80000000; }
-    void ShiftLRU() { lru_sreg >>= 1; }
-    bool IsLessRecentlyUsedThan(const Cache& other) const { return lru_sreg < other.lru_sreg; }
   };
+  // Ordered from most to least recently used.
+  using CacheList = std::list<Cache>;
 
-  // Gets the cache line that contains the given block, or nullptr.
+  // Gets the cache line that holds the given chunk and marks it as the most recently used,
+  // or returns nullptr.
   // NOTE: The cache record only lasts until it expires (next GetEmptyCacheLine)
-  const Cache* FindCacheLine(u64 block_num);
+  const Cache* FindCacheLine(u64 chunk_idx);
+  bool IsChunkCached(u64 chunk_idx) const { return m_cache_index.count(chunk_idx) != 0; }
 
-  // Finds the least recently used cache line, resets and returns it.
+  // Evicts the least recently used cache line and returns it as the most recently used one.
   Cache* GetEmptyCacheLine();
 
   // Combines FindCacheLine with GetEmptyCacheLine and ReadChunk.
@@ -142,6 +122,12 @@ private:
   // May return nullptr only if the cache missed and the read failed.
   const Cache* GetCacheLine(u64 block_num);
 
+  // Reads a run of whole chunks that are not in the cache straight into out_ptr with a single
+  // ReadMultipleAlignedBlocks call, so that large reads don't go through the cache one chunk
+  // at a time. Returns the number of blocks read, or zero if the read should go through the
+  // cache instead.
+  u64 ReadUncachedBlocks(u64 block_num, u64 max_blocks, u8* out_ptr);
+
   // Read all bytes from a chunk of blocks into a buffer.
   // Returns the number of blocks read (may be less than m_chunk_blocks
   // if chunk_num is the last chunk on the disk and the disk size is not
@@ -149,9 +135,13 @@ private:
   u32 ReadChunk(u8* buffer, u64 chunk_num);
 
   static constexpr int CACHE_LINES = 32;
+  // Reads covering fewer chunks than this are always served from the cache.
+  static constexpr u64 MIN_UNCACHED_READ_CHUNKS = 2;
   u32 m_block_size = 0;    // Bytes in a sector/block
   u32 m_chunk_blocks = 1;  // Number of sectors/blocks in a chunk
-  std::array<Cache, CACHE_LINES> m_cache;
+  CacheList m_cache;
+  // Maps a chunk index to its line in m_cache
+  std::unordered_map<u64, CacheList::iterator> m_cache_index;
 };
 
 // Factory function - examines the path to choose the right type of BlobReader, and returns one.
@@ -159,9 +149,11 @@ std::unique_ptr<BlobReader> CreateBlobReader(const std::string& filename);
 
 typedef bool (*CompressCB)(const std::string& text, float percent, void* arg);
 
+// If sub_type is 1 (scrub), the used clusters are taken from scrub_bitmap_path when it is set
+// instead of parsing the disc again (see AuditDisc).
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
                         u32 sub_type = 0, int sector_size = 16384, CompressCB callback = nullptr,
-                        void* arg = nullptr);
+                        void* arg = nullptr, const std::string& scrub_bitmap_path = "");
 bool DecompressBlobToFile(const std::string& infile_path, const std::string& outfile_path,
                           CompressCB callback = nullptr, void* arg = nullptr);
 
@@ -47,20 +47,36 @@ u64 CISOFileReader::GetRawSize() const
   return m_size;
 }
 
+bool CISOFileReader::IsBlockUsed(u64 block) const
+{
+  return block < CISO_MAP_SIZE && UNUSED_BLOCK_ID != m_ciso_map[block];
+}
+
 bool CISOFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
 {
   while (nbytes != 0)
   {
     u64 const block = offset / m_block_size;
     u64 const data_offset = offset % m_block_size;
-    u64 const bytes_to_read = std::min(m_block_size - data_offset, nbytes);
+    u64 bytes_to_read = std::min(m_block_size - data_offset, nbytes);
+
+    // Extend the read over the following blocks for as long as they are stored right after
+    // each other (or are all unused), so that large reads only need a few read calls.
+    bool const used = IsBlockUsed(block);
+    u64 last_block = block;
+    while (bytes_to_read < nbytes && IsBlockUsed(last_block + 1) == used &&
+           (!used || m_ciso_map[last_block + 1] == m_ciso_map[last_block] + 1))
+    {
+      ++last_block;
+      bytes_to_read = std::min<u64>(bytes_to_read + m_block_size, nbytes);
+    }
 
-    if (block < CISO_MAP_SIZE && UNUSED_BLOCK_ID != m_ciso_map[block])
+    if (used)
     {
       // calculate the base address
       u64 const file_off = CISO_HEADER_SIZE + m_ciso_map[block] * (u64)m_block_size + data_offset;
 
-      if (!(m_file.Seek(file_off, SEEK_SET) && m_file.ReadArray(out_ptr, bytes_to_read)))
+      if (!m_file.ReadAt(file_off, out_ptr, bytes_to_read))
       {
         m_file.Clear();
         return false;
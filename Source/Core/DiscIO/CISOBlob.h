@@ -47,6 +47,8 @@ public:
 private:
   CISOFileReader(File::IOFile file);
 
+  bool IsBlockUsed(u64 block) const;
+
   typedef u16 MapType;
   static const MapType UNUSED_BLOCK_ID = UINT16_MAX;
 
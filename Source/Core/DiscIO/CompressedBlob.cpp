@@ -8,6 +8,7 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
@@ -24,9 +25,11 @@
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/Timer.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DiscScrubber.h"
+#include "DiscIO/MultithreadedCompressor.h"
 
 namespace DiscIO
 {
@@ -87,7 +90,17 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
 
 bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 {
-  bool uncompressed = false;
+  bool uncompressed;
+  if (!ReadRawBlock(block_num, &m_zlib_buffer, &uncompressed))
+    return false;
+
+  return DecompressRawBlock(block_num, m_zlib_buffer.data(),
+                            (u32)GetBlockCompressedSize(block_num), uncompressed, out_ptr);
+}
+
+bool CompressedBlobReader::ReadRawBlock(u64 block_num, std::vector<u8>* out, bool* uncompressed)
+{
+  *uncompressed = false;
   u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
   u64 offset = m_block_pointers[block_num] + m_data_offset;
 
@@ -95,15 +108,19 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
   {
     if (comp_block_size != m_header.block_size)
       PanicAlert("Uncompressed block with wrong size");
-    uncompressed = true;
+    *uncompressed = true;
     offset &= ~(1ULL << 63);
   }
 
+  // A compressed block is never longer than a decompressed block (see the constructor).
+  if (out->size() < m_header.block_size + 64)
+    out->resize(m_header.block_size + 64);
+
   // clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-  memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
+  std::fill(out->begin() + comp_block_size, out->end(), 0);
 
   m_file.Seek(offset, SEEK_SET);
-  if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
+  if (!m_file.ReadBytes(out->data(), comp_block_size))
   {
     PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
                 m_file_name.c_str());
@@ -111,8 +128,14 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
     return false;
   }
 
+  return true;
+}
+
+bool CompressedBlobReader::DecompressRawBlock(u64 block_num, const u8* in, u32 in_size,
+                                              bool uncompressed, u8* out_ptr) const
+{
   // First, check hash.
-  u32 block_hash = HashAdler32(m_zlib_buffer.data(), comp_block_size);
+  u32 block_hash = HashAdler32(in, in_size);
   if (block_hash != m_hashes[block_num])
     PanicAlertT("The disc image \"%s\" is corrupt.\n"
                 "Hash of block %" PRIu64 " is %08x instead of %08x.",
@@ -120,13 +143,13 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 
   if (uncompressed)
   {
-    std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
+    std::copy(in, in + in_size, out_ptr);
   }
   else
   {
     z_stream z = {};
-    z.next_in = m_zlib_buffer.data();
-    z.avail_in = comp_block_size;
+    z.next_in = const_cast<u8*>(in);
+    z.avail_in = in_size;
     if (z.avail_in > m_header.block_size)
     {
       PanicAlert("We have a problem");
@@ -152,8 +175,63 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
   return true;
 }
 
+namespace
+{
+struct DeflateThreadState
+{
+  DeflateThreadState() = default;
+  DeflateThreadState(const DeflateThreadState&) = delete;
+  DeflateThreadState& operator=(const DeflateThreadState&) = delete;
+  ~DeflateThreadState()
+  {
+    if (initialized)
+      deflateEnd(&z);
+  }
+
+  z_stream z = {};
+  bool initialized = false;
+};
+
+struct UncompressedBlock
+{
+  std::vector<u8> data;
+};
+
+struct CompressedBlock
+{
+  std::vector<u8> data;
+  u32 hash = 0;
+  bool stored = false;
+  bool success = true;
+};
+
+struct RawBlock
+{
+  u64 block_num = 0;
+  std::vector<u8> data;
+  u32 size = 0;
+  bool uncompressed = false;
+};
+
+struct DecompressedBlock
+{
+  std::vector<u8> data;
+  bool success = true;
+};
+
+struct NoThreadState
+{
+};
+
+double GetThroughputMiBs(u64 bytes, u64 elapsed_ms)
+{
+  return elapsed_ms == 0 ? 0.0 : (bytes / (1024.0 * 1024.0)) / (elapsed_ms / 1000.0);
+}
+}  // namespace
+
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
-                        u32 sub_type, int block_size, CompressCB callback, void* arg)
+                        u32 sub_type, int block_size, CompressCB callback, void* arg,
+                        const std::string& scrub_bitmap_path)
 {
   bool scrubbing = false;
 
@@ -183,7 +261,11 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   DiscScrubber disc_scrubber;
   if (sub_type == 1)
   {
-    if (!disc_scrubber.SetupScrub(infile_path, block_size))
+    const bool set_up = scrub_bitmap_path.empty() ?
+                            disc_scrubber.SetupScrub(infile_path, block_size) :
+                            disc_scrubber.SetupScrubFromBitmap(scrub_bitmap_path, infile_path,
+                                                               block_size);
+    if (!set_up)
     {
       PanicAlertT("\"%s\" failed to be scrubbed. Probably the image is corrupt.",
                   infile_path.c_str());
@@ -193,10 +275,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     scrubbing = true;
   }
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
-    return false;
-
   callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
   CompressedBlobHeader header;
@@ -210,8 +288,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   std::vector<u64> offsets(header.num_blocks);
   std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
 
   // seek past the header (we will write it at the end)
   outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -221,20 +297,95 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   infile.Seek(0, SEEK_SET);
 
   // Now we are ready to write compressed data!
-  u64 position = 0;
-  int num_compressed = 0;
-  int num_stored = 0;
-  int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
+  // The blocks are read here, deflated by the workers and written by whichever worker holds
+  // the next block in order, so the output is identical to compressing on a single thread.
+  std::atomic<u64> position{0};
+  std::atomic<u32> blocks_written{0};
+  u32 num_stored = 0;
+  bool write_failed = false;
   bool success = true;
 
+  auto set_up = [](DeflateThreadState* state) {
+    state->initialized = deflateInit(&state->z, 9) == Z_OK;
+    return state->initialized;
+  };
+
+  auto compress = [block_size](UncompressedBlock input, DeflateThreadState* state) {
+    CompressedBlock output;
+    output.data.resize(block_size);
+
+    z_stream& z = state->z;
+    if (deflateReset(&z) != Z_OK)
+    {
+      ERROR_LOG(DISCIO, "Deflate failed");
+      output.success = false;
+      return output;
+    }
+
+    z.next_in = input.data.data();
+    z.avail_in = block_size;
+    z.next_out = output.data.data();
+    z.avail_out = block_size;
+
+    int status = deflate(&z, Z_FINISH);
+    int comp_size = block_size - z.avail_out;
+
+    if ((status != Z_STREAM_END) || (z.avail_out < 10))
+    {
+      // let's store uncompressed
+      output.data = std::move(input.data);
+      output.stored = true;
+    }
+    else
+    {
+      // let's store compressed
+      output.data.resize(comp_size);
+    }
+
+    output.hash = HashAdler32(output.data.data(), output.data.size());
+    return output;
+  };
+
+  auto output = [&](CompressedBlock block) {
+    if (!block.success)
+      return false;
+
+    const u32 i = blocks_written.load();
+    offsets[i] = position.load();
+    if (block.stored)
+    {
+      offsets[i] |= 0x8000000000000000ULL;
+      num_stored++;
+    }
+    hashes[i] = block.hash;
+
+    if (!outfile.WriteBytes(block.data.data(), block.data.size()))
+    {
+      write_failed = true;
+      return false;
+    }
+
+    position += block.data.size();
+    blocks_written++;
+    return true;
+  };
+
+  const size_t num_threads = GetCompressionThreadCount();
+  MultithreadedCompressor<DeflateThreadState, UncompressedBlock, CompressedBlock> compressor(
+      set_up, compress, output, num_threads, "GCZ Compress");
+
+  Common::Timer timer;
+  timer.Start();
+
+  int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
   for (u32 i = 0; i < header.num_blocks; i++)
   {
     if (i % progress_monitor == 0)
     {
-      const u64 inpos = infile.Tell();
+      const u64 done = u64{blocks_written.load()} * header.block_size;
       int ratio = 0;
-      if (inpos != 0)
-        ratio = (int)(100 * position / inpos);
+      if (done != 0)
+        ratio = (int)(100 * position.load() / done);
 
       std::string temp =
           StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
@@ -247,67 +398,37 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
       }
     }
 
-    offsets[i] = position;
+    UncompressedBlock block;
+    block.data.resize(block_size);
 
     size_t read_bytes;
     if (scrubbing)
-      read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
+      read_bytes = disc_scrubber.GetNextBlock(infile, block.data.data());
     else
-      infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
+      infile.ReadArray(block.data.data(), header.block_size, &read_bytes);
     if (read_bytes < header.block_size)
-      std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
-
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
-
-    if (retval != Z_OK)
-    {
-      ERROR_LOG(DISCIO, "Deflate failed");
-      success = false;
-      break;
-    }
-
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
-
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
-    {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-      // let's store uncompressed
-      write_buf = in_buf.data();
-      offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
-    }
-    else
-    {
-      // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
-    }
+      std::fill(block.data.begin() + read_bytes, block.data.begin() + header.block_size, 0);
 
-    if (!outfile.WriteBytes(write_buf, write_size))
+    if (!compressor.CompressAndWrite(std::move(block)))
     {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
       success = false;
       break;
     }
+  }
 
-    position += write_size;
+  if (success)
+    success = compressor.Shutdown();
+  else
+    compressor.Cancel();
 
-    hashes[i] = HashAdler32(write_buf, write_size);
+  if (write_failed)
+  {
+    PanicAlertT("Failed to write the output file \"%s\".\n"
+                "Check that you have enough space available on the target drive.",
+                outfile_path.c_str());
   }
 
-  header.compressed_data_size = position;
+  header.compressed_data_size = position.load();
 
   if (!success)
   {
@@ -322,10 +443,13 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     outfile.WriteArray(&header, 1);
     outfile.WriteArray(offsets.data(), header.num_blocks);
     outfile.WriteArray(hashes.data(), header.num_blocks);
-  }
 
-  // Cleanup
-  deflateEnd(&z);
+    const u64 elapsed_ms = timer.GetTimeElapsed();
+    NOTICE_LOG(DISCIO,
+               "Compressed %s: %u blocks (%u stored) in %" PRIu64 " ms on %zu threads, %.1f MiB/s",
+               infile_path.c_str(), header.num_blocks, num_stored, elapsed_ms, num_threads,
+               GetThroughputMiBs(header.data_size, elapsed_ms));
+  }
 
   if (success)
   {
@@ -366,37 +490,76 @@ bool DecompressBlobToFile(const std::string& infile_path, const std::string& out
   }
 
   const CompressedBlobHeader& header = reader->GetHeader();
-  static const size_t BUFFER_BLOCKS = 32;
-  size_t buffer_size = header.block_size * BUFFER_BLOCKS;
-  size_t last_buffer_size = header.block_size * (header.num_blocks % BUFFER_BLOCKS);
-  std::vector<u8> buffer(buffer_size);
-  u32 num_buffers = (header.num_blocks + BUFFER_BLOCKS - 1) / BUFFER_BLOCKS;
-  int progress_monitor = std::max<int>(1, num_buffers / 100);
+  const CompressedBlobReader* const const_reader = reader.get();
+  bool write_failed = false;
   bool success = true;
 
-  for (u64 i = 0; i < num_buffers; i++)
+  auto set_up = [](NoThreadState*) { return true; };
+
+  auto decompress = [&header, const_reader](RawBlock input, NoThreadState*) {
+    DecompressedBlock output;
+    output.data.resize(header.block_size);
+    output.success = const_reader->DecompressRawBlock(
+        input.block_num, input.data.data(), input.size, input.uncompressed, output.data.data());
+    return output;
+  };
+
+  auto output = [&](DecompressedBlock block) {
+    if (!block.success)
+      return false;
+
+    if (!outfile.WriteBytes(block.data.data(), block.data.size()))
+    {
+      write_failed = true;
+      return false;
+    }
+    return true;
+  };
+
+  const size_t num_threads = GetCompressionThreadCount();
+  MultithreadedCompressor<NoThreadState, RawBlock, DecompressedBlock> decompressor(
+      set_up, decompress, output, num_threads, "GCZ Decompress");
+
+  Common::Timer timer;
+  timer.Start();
+
+  int progress_monitor = std::max<int>(1, header.num_blocks / 100);
+  for (u32 i = 0; i < header.num_blocks; i++)
   {
     if (i % progress_monitor == 0)
     {
-      bool was_cancelled = !callback(GetStringT("Unpacking"), (float)i / (float)num_buffers, arg);
+      bool was_cancelled =
+          !callback(GetStringT("Unpacking"), (float)i / (float)header.num_blocks, arg);
       if (was_cancelled)
       {
         success = false;
         break;
       }
     }
-    const size_t sz = i == num_buffers - 1 ? last_buffer_size : buffer_size;
-    reader->Read(i * buffer_size, sz, buffer.data());
-    if (!outfile.WriteBytes(buffer.data(), sz))
+
+    RawBlock block;
+    block.block_num = i;
+    block.size = (u32)reader->GetBlockCompressedSize(i);
+    if (!reader->ReadRawBlock(i, &block.data, &block.uncompressed) ||
+        !decompressor.CompressAndWrite(std::move(block)))
     {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
       success = false;
       break;
     }
   }
 
+  if (success)
+    success = decompressor.Shutdown();
+  else
+    decompressor.Cancel();
+
+  if (write_failed)
+  {
+    PanicAlertT("Failed to write the output file \"%s\".\n"
+                "Check that you have enough space available on the target drive.",
+                outfile_path.c_str());
+  }
+
   if (!success)
   {
     // Remove the incomplete output file.
@@ -406,6 +569,11 @@ bool DecompressBlobToFile(const std::string& infile_path, const std::string& out
   else
   {
     outfile.Resize(header.data_size);
+
+    const u64 elapsed_ms = timer.GetTimeElapsed();
+    NOTICE_LOG(DISCIO, "Decompressed %s: %u blocks in %" PRIu64 " ms on %zu threads, %.1f MiB/s",
+               infile_path.c_str(), header.num_blocks, elapsed_ms, num_threads,
+               GetThroughputMiBs(header.data_size, elapsed_ms));
   }
 
   return success;
@@ -54,6 +54,13 @@ public:
   u64 GetBlockCompressedSize(u64 block_num) const;
   bool GetBlock(u64 block_num, u8* out_ptr) override;
 
+  // Split versions of GetBlock, used for unpacking on several threads.
+  // ReadRawBlock reads the stored bytes of a block. DecompressRawBlock checks their hash and
+  // decompresses them; it doesn't touch the file, so it may be called from any thread.
+  bool ReadRawBlock(u64 block_num, std::vector<u8>* out, bool* uncompressed);
+  bool DecompressRawBlock(u64 block_num, const u8* in, u32 in_size, bool uncompressed,
+                          u8* out_ptr) const;
+
 private:
   CompressedBlobReader(File::IOFile file, const std::string& filename);
 
@@ -0,0 +1,1002 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/DCXBlob.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <mbedtls/aes.h>
+#include <mbedtls/sha1.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
+#include "Core/IOS/ES/Formats.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/Enums.h"
+#include "DiscIO/MultithreadedCompressor.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeWii.h"
+
+namespace DiscIO
+{
+namespace
+{
+constexpr u32 CLUSTER_SIZE = VolumeWii::BLOCK_TOTAL_SIZE;
+constexpr u32 CLUSTER_HEADER_SIZE = VolumeWii::BLOCK_HEADER_SIZE;
+constexpr u32 CLUSTER_DATA_SIZE = VolumeWii::BLOCK_DATA_SIZE;
+constexpr u32 CLUSTERS_PER_SUBGROUP = 8;
+constexpr u32 CLUSTERS_PER_GROUP = 64;
+constexpr u32 GROUP_SIZE = CLUSTER_SIZE * CLUSTERS_PER_GROUP;
+constexpr u32 GROUP_DATA_SIZE = CLUSTER_DATA_SIZE * CLUSTERS_PER_GROUP;
+constexpr u64 PARTITION_DATA_OFFSET = 0x20000;
+
+// Layout of the decrypted hash block at the start of each cluster.
+// http://wiibrew.org/wiki/Wii_Disc#Encrypted
+constexpr u32 H0_OFFSET = 0x000;
+constexpr u32 H0_COUNT = CLUSTER_DATA_SIZE / 0x400;
+constexpr u32 H1_OFFSET = 0x280;
+constexpr u32 H2_OFFSET = 0x340;
+constexpr u32 IV_OFFSET = 0x3D0;
+constexpr u32 SHA1_SIZE = 20;
+
+using SHA1 = std::array<u8, SHA1_SIZE>;
+
+u32 GetGroupClusterCount(const DCXPartitionEntry& partition, u64 group)
+{
+  const u64 clusters = partition.data_size / CLUSTER_SIZE - group * CLUSTERS_PER_GROUP;
+  return static_cast<u32>(std::min<u64>(clusters, CLUSTERS_PER_GROUP));
+}
+
+// Returns the group of the partition that holds the cluster, if the cluster is in the part
+// of the partition that can be stored decrypted.
+std::optional<u64> GetGroup(const DCXPartitionEntry& partition, u64 cluster_offset)
+{
+  if (cluster_offset < partition.data_offset ||
+      cluster_offset >= partition.data_offset + partition.data_size)
+  {
+    return std::nullopt;
+  }
+
+  const u64 group = (cluster_offset - partition.data_offset) / GROUP_SIZE;
+  if (group >= partition.num_groups)
+    return std::nullopt;
+  return group;
+}
+
+bool IsStoredDecrypted(const DCXPartitionEntry& partition, const std::vector<u8>& group_flags,
+                       u64 cluster_offset)
+{
+  const std::optional<u64> group = GetGroup(partition, cluster_offset);
+  return group && group_flags[partition.first_group + *group];
+}
+
+// Computes where each cluster of a chunk starts in the chunk's payload, given which clusters
+// are stored decrypted. Returns the size of the payload.
+template <typename IsDecrypted>
+u32 GetClusterOffsets(u64 chunk_start, u64 chunk_end, IsDecrypted is_decrypted,
+                      std::vector<u32>* offsets)
+{
+  offsets->clear();
+  u32 position = 0;
+  for (u64 cluster = chunk_start; cluster < chunk_end; cluster += CLUSTER_SIZE)
+  {
+    offsets->push_back(position);
+    if (is_decrypted(cluster))
+      position += CLUSTER_DATA_SIZE;
+    else
+      position += static_cast<u32>(std::min<u64>(CLUSTER_SIZE, chunk_end - cluster));
+  }
+  return position;
+}
+
+// Recomputes the hash blocks of a group from its decrypted data and encrypts it.
+// decrypted holds num_clusters * CLUSTER_DATA_SIZE bytes, out receives
+// num_clusters * CLUSTER_SIZE bytes.
+void EncryptGroup(const u8* decrypted, u32 num_clusters, mbedtls_aes_context* key, u8* out)
+{
+  std::vector<std::array<u8, CLUSTER_HEADER_SIZE>> hash_blocks(num_clusters);
+  std::array<u8, SHA1_SIZE * CLUSTERS_PER_SUBGROUP> h2 = {};
+
+  for (u32 subgroup = 0; subgroup * CLUSTERS_PER_SUBGROUP < num_clusters; ++subgroup)
+  {
+    const u32 first = subgroup * CLUSTERS_PER_SUBGROUP;
+    const u32 last = std::min(first + CLUSTERS_PER_SUBGROUP, num_clusters);
+    std::array<u8, SHA1_SIZE * CLUSTERS_PER_SUBGROUP> h1 = {};
+
+    for (u32 i = first; i < last; ++i)
+    {
+      hash_blocks[i].fill(0);
+      const u8* data = decrypted + static_cast<size_t>(i) * CLUSTER_DATA_SIZE;
+      for (u32 j = 0; j < H0_COUNT; ++j)
+        mbedtls_sha1(data + j * 0x400, 0x400, &hash_blocks[i][H0_OFFSET + j * SHA1_SIZE]);
+      mbedtls_sha1(&hash_blocks[i][H0_OFFSET], H0_COUNT * SHA1_SIZE,
+                   &h1[(i - first) * SHA1_SIZE]);
+    }
+
+    for (u32 i = first; i < last; ++i)
+      std::copy(h1.begin(), h1.end(), &hash_blocks[i][H1_OFFSET]);
+    mbedtls_sha1(h1.data(), h1.size(), &h2[subgroup * SHA1_SIZE]);
+  }
+
+  for (u32 i = 0; i < num_clusters; ++i)
+  {
+    std::copy(h2.begin(), h2.end(), &hash_blocks[i][H2_OFFSET]);
+
+    u8* cluster = out + static_cast<size_t>(i) * CLUSTER_SIZE;
+    u8 iv[16] = {};
+    mbedtls_aes_crypt_cbc(key, MBEDTLS_AES_ENCRYPT, CLUSTER_HEADER_SIZE, iv,
+                          hash_blocks[i].data(), cluster);
+    std::copy_n(cluster + IV_OFFSET, sizeof(iv), iv);
+    mbedtls_aes_crypt_cbc(key, MBEDTLS_AES_ENCRYPT, CLUSTER_DATA_SIZE, iv,
+                          decrypted + static_cast<size_t>(i) * CLUSTER_DATA_SIZE,
+                          cluster + CLUSTER_HEADER_SIZE);
+  }
+}
+
+// Decrypts the data of one cluster, discarding its hash block.
+void DecryptCluster(const u8* encrypted, mbedtls_aes_context* key, u8* out)
+{
+  u8 iv[16];
+  std::copy_n(encrypted + IV_OFFSET, sizeof(iv), iv);
+  mbedtls_aes_crypt_cbc(key, MBEDTLS_AES_DECRYPT, CLUSTER_DATA_SIZE, iv,
+                        encrypted + CLUSTER_HEADER_SIZE, out);
+}
+
+bool InflatePayload(const u8* in, u32 in_size, u8* out, u32 out_size)
+{
+  z_stream z = {};
+  z.next_in = const_cast<u8*>(in);
+  z.avail_in = in_size;
+  z.next_out = out;
+  z.avail_out = out_size;
+  if (inflateInit(&z) != Z_OK)
+    return false;
+  const int status = inflate(&z, Z_FINISH);
+  inflateEnd(&z);
+  return status == Z_STREAM_END && z.avail_out == 0;
+}
+
+double GetThroughputMiBs(u64 bytes, u64 elapsed_ms)
+{
+  return elapsed_ms == 0 ? 0.0 : (bytes / (1024.0 * 1024.0)) / (elapsed_ms / 1000.0);
+}
+}  // namespace
+
+DCXFileReader::DCXFileReader(File::IOFile file, const std::string& filename)
+    : m_file(std::move(file)), m_file_name(filename)
+{
+  m_file_size = m_file.GetSize();
+}
+
+DCXFileReader::~DCXFileReader()
+{
+  for (const std::unique_ptr<Partition>& partition : m_partitions)
+  {
+    mbedtls_aes_free(&partition->encrypt_key);
+    mbedtls_aes_free(&partition->decrypt_key);
+  }
+}
+
+std::unique_ptr<DCXFileReader> DCXFileReader::Create(File::IOFile file,
+                                                     const std::string& filename)
+{
+  std::unique_ptr<DCXFileReader> reader(new DCXFileReader(std::move(file), filename));
+  if (!reader->Initialize())
+    return nullptr;
+  return reader;
+}
+
+bool DCXFileReader::Initialize()
+{
+  if (!m_file.Seek(0, SEEK_SET) || !m_file.ReadArray(&m_header, 1) ||
+      m_header.magic != DCX_MAGIC)
+  {
+    return false;
+  }
+
+  if (m_header.version != DCX_VERSION)
+  {
+    ERROR_LOG(DISCIO, "%s: unsupported DCX version %u", m_file_name.c_str(), m_header.version);
+    return false;
+  }
+
+  if (m_header.chunk_size == 0 || m_header.chunk_size % CLUSTER_SIZE != 0 ||
+      m_header.num_chunks != (m_header.data_size + m_header.chunk_size - 1) / m_header.chunk_size ||
+      (m_header.compression != DCXCompression::None &&
+       m_header.compression != DCXCompression::Zlib))
+  {
+    ERROR_LOG(DISCIO, "%s: invalid DCX header", m_file_name.c_str());
+    return false;
+  }
+
+  std::vector<DCXPartitionEntry> partitions(m_header.num_partitions);
+  m_group_flags.resize(m_header.num_groups);
+  m_chunk_index.resize(m_header.num_chunks);
+  m_stored_chunks.resize(m_header.num_stored_chunks);
+  if (!m_file.Seek(m_header.table_offset, SEEK_SET) ||
+      !m_file.ReadArray(partitions.data(), partitions.size()) ||
+      !m_file.ReadArray(m_group_flags.data(), m_group_flags.size()) ||
+      !m_file.ReadArray(m_chunk_index.data(), m_chunk_index.size()) ||
+      !m_file.ReadArray(m_stored_chunks.data(), m_stored_chunks.size()))
+  {
+    PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
+                m_file_name.c_str());
+    return false;
+  }
+
+  for (u32 stored_index : m_chunk_index)
+  {
+    if (stored_index >= m_header.num_stored_chunks)
+    {
+      ERROR_LOG(DISCIO, "%s: invalid DCX chunk index", m_file_name.c_str());
+      return false;
+    }
+  }
+
+  for (const DCXPartitionEntry& entry : partitions)
+  {
+    if (u64{entry.first_group} + entry.num_groups > m_header.num_groups ||
+        entry.data_offset % CLUSTER_SIZE != 0 || entry.data_size % CLUSTER_SIZE != 0 ||
+        entry.num_groups > (entry.data_size + GROUP_SIZE - 1) / GROUP_SIZE)
+    {
+      ERROR_LOG(DISCIO, "%s: invalid DCX partition entry", m_file_name.c_str());
+      return false;
+    }
+
+    auto partition = std::make_unique<Partition>();
+    partition->entry = entry;
+    mbedtls_aes_init(&partition->encrypt_key);
+    mbedtls_aes_init(&partition->decrypt_key);
+    mbedtls_aes_setkey_enc(&partition->encrypt_key, entry.title_key.data(), 128);
+    mbedtls_aes_setkey_dec(&partition->decrypt_key, entry.title_key.data(), 128);
+    m_partitions.push_back(std::move(partition));
+  }
+
+  return true;
+}
+
+bool DCXFileReader::ReadChunkPayload(u64 chunk_num, std::vector<u8>* payload)
+{
+  const DCXStoredChunk& stored = m_stored_chunks[m_chunk_index[chunk_num]];
+  const bool uncompressed = (stored.offset & (1ULL << 63)) != 0;
+  const u64 offset = stored.offset & ~(1ULL << 63);
+
+  m_compressed_buffer.resize(stored.size);
+  if (!m_file.Seek(offset, SEEK_SET) || !m_file.ReadBytes(m_compressed_buffer.data(), stored.size))
+  {
+    PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
+                m_file_name.c_str());
+    m_file.Clear();
+    return false;
+  }
+
+  const u32 hash = HashAdler32(m_compressed_buffer.data(), stored.size);
+  if (hash != stored.hash)
+  {
+    PanicAlertT("The disc image \"%s\" is corrupt.\n"
+                "Hash of block %" PRIu64 " is %08x instead of %08x.",
+                m_file_name.c_str(), chunk_num, hash, stored.hash);
+  }
+
+  if (uncompressed)
+  {
+    if (stored.size != payload->size())
+    {
+      PanicAlert("Uncompressed block with wrong size");
+      return false;
+    }
+    std::copy(m_compressed_buffer.begin(), m_compressed_buffer.end(), payload->begin());
+    return true;
+  }
+
+  if (!InflatePayload(m_compressed_buffer.data(), stored.size, payload->data(),
+                      static_cast<u32>(payload->size())))
+  {
+    PanicAlert("Failure reading block %" PRIu64 " - out of data and not at end.", chunk_num);
+    return false;
+  }
+  return true;
+}
+
+const DCXFileReader::CachedChunk* DCXFileReader::GetChunk(u64 chunk_num)
+{
+  CachedChunk* line = &m_chunk_cache[0];
+  for (CachedChunk& entry : m_chunk_cache)
+  {
+    if (entry.chunk_num == chunk_num)
+    {
+      entry.last_used = ++m_chunk_cache_counter;
+      return &entry;
+    }
+    if (entry.last_used < line->last_used)
+      line = &entry;
+  }
+
+  const u64 chunk_start = chunk_num * m_header.chunk_size;
+  const u64 chunk_end = std::min(chunk_start + m_header.chunk_size, m_header.data_size);
+  const u32 payload_size = GetClusterOffsets(
+      chunk_start, chunk_end,
+      [this](u64 cluster_offset) {
+        return std::any_of(m_partitions.begin(), m_partitions.end(),
+                           [this, cluster_offset](const std::unique_ptr<Partition>& partition) {
+                             return IsStoredDecrypted(partition->entry, m_group_flags,
+                                                      cluster_offset);
+                           });
+      },
+      &line->cluster_offsets);
+
+  line->chunk_num = UINT64_MAX;
+  line->last_used = 0;
+  line->payload.resize(payload_size);
+  if (!ReadChunkPayload(chunk_num, &line->payload))
+    return nullptr;
+
+  line->chunk_num = chunk_num;
+  line->last_used = ++m_chunk_cache_counter;
+  return line;
+}
+
+bool DCXFileReader::ReadStoredCluster(u64 cluster_offset, u32 offset_in_cluster, u32 size,
+                                      u8* out_ptr)
+{
+  const u64 chunk_num = cluster_offset / m_header.chunk_size;
+  const CachedChunk* chunk = GetChunk(chunk_num);
+  if (!chunk)
+    return false;
+
+  const size_t index = (cluster_offset - chunk_num * m_header.chunk_size) / CLUSTER_SIZE;
+  const size_t start = chunk->cluster_offsets[index] + offset_in_cluster;
+  if (start + size > chunk->payload.size())
+    return false;
+
+  std::copy_n(chunk->payload.begin() + start, size, out_ptr);
+  return true;
+}
+
+const u8* DCXFileReader::GetEncryptedGroup(const Partition& partition, u64 group)
+{
+  if (m_group_cache.partition == &partition && m_group_cache.group == group)
+    return m_group_cache.data.data();
+
+  m_group_cache.partition = nullptr;
+
+  const u64 group_offset = partition.entry.data_offset + group * GROUP_SIZE;
+  const u32 num_clusters = GetGroupClusterCount(partition.entry, group);
+  m_decrypted_group_buffer.resize(GROUP_DATA_SIZE);
+  for (u32 i = 0; i < num_clusters; ++i)
+  {
+    if (!ReadStoredCluster(group_offset + static_cast<u64>(i) * CLUSTER_SIZE, 0,
+                           CLUSTER_DATA_SIZE, &m_decrypted_group_buffer[i * CLUSTER_DATA_SIZE]))
+    {
+      return nullptr;
+    }
+  }
+
+  m_group_cache.data.resize(GROUP_SIZE);
+  EncryptGroup(m_decrypted_group_buffer.data(), num_clusters,
+               const_cast<mbedtls_aes_context*>(&partition.encrypt_key),
+               m_group_cache.data.data());
+  m_group_cache.partition = &partition;
+  m_group_cache.group = group;
+  return m_group_cache.data.data();
+}
+
+bool DCXFileReader::Read(u64 offset, u64 size, u8* out_ptr)
+{
+  if (offset + size > m_header.data_size)
+    return false;
+
+  while (size > 0)
+  {
+    const u64 cluster_offset = offset / CLUSTER_SIZE * CLUSTER_SIZE;
+    const u32 offset_in_cluster = static_cast<u32>(offset - cluster_offset);
+    const u32 read_size = static_cast<u32>(std::min<u64>(size, CLUSTER_SIZE - offset_in_cluster));
+
+    const Partition* partition = nullptr;
+    std::optional<u64> group;
+    for (const std::unique_ptr<Partition>& p : m_partitions)
+    {
+      if (IsStoredDecrypted(p->entry, m_group_flags, cluster_offset))
+      {
+        partition = p.get();
+        group = GetGroup(p->entry, cluster_offset);
+        break;
+      }
+    }
+
+    if (partition)
+    {
+      const u8* group_data = GetEncryptedGroup(*partition, *group);
+      if (!group_data)
+        return false;
+      const u64 group_offset = partition->entry.data_offset + *group * GROUP_SIZE;
+      std::copy_n(group_data + (offset - group_offset), read_size, out_ptr);
+    }
+    else if (!ReadStoredCluster(cluster_offset, offset_in_cluster, read_size, out_ptr))
+    {
+      return false;
+    }
+
+    offset += read_size;
+    out_ptr += read_size;
+    size -= read_size;
+  }
+
+  return true;
+}
+
+bool DCXFileReader::ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_offset)
+{
+  auto it = std::find_if(m_partitions.begin(), m_partitions.end(),
+                         [partition_offset](const std::unique_ptr<Partition>& partition) {
+                           return partition->entry.partition_offset == partition_offset;
+                         });
+  if (it == m_partitions.end())
+    return false;
+  Partition& partition = **it;
+
+  std::vector<u8> encrypted;
+  std::vector<u8> decrypted;
+  while (size > 0)
+  {
+    const u64 cluster_offset =
+        partition.entry.data_offset + offset / CLUSTER_DATA_SIZE * CLUSTER_SIZE;
+    const u32 offset_in_cluster = static_cast<u32>(offset % CLUSTER_DATA_SIZE);
+    const u32 read_size =
+        static_cast<u32>(std::min<u64>(size, CLUSTER_DATA_SIZE - offset_in_cluster));
+
+    if (IsStoredDecrypted(partition.entry, m_group_flags, cluster_offset))
+    {
+      if (!ReadStoredCluster(cluster_offset, offset_in_cluster, read_size, out_ptr))
+        return false;
+    }
+    else
+    {
+      // This cluster is stored encrypted, so decrypt it like VolumeWii would
+      encrypted.resize(CLUSTER_SIZE);
+      decrypted.resize(CLUSTER_DATA_SIZE);
+      if (!Read(cluster_offset, CLUSTER_SIZE, encrypted.data()))
+        return false;
+      DecryptCluster(encrypted.data(), &partition.decrypt_key, decrypted.data());
+      std::copy_n(decrypted.begin() + offset_in_cluster, read_size, out_ptr);
+    }
+
+    offset += read_size;
+    out_ptr += read_size;
+    size -= read_size;
+  }
+
+  return true;
+}
+
+namespace
+{
+struct ConvertPartition
+{
+  DCXPartitionEntry entry;
+  mbedtls_aes_context encrypt_key;
+  mbedtls_aes_context decrypt_key;
+};
+
+struct ConvertThreadState
+{
+  ConvertThreadState() = default;
+  ConvertThreadState(const ConvertThreadState&) = delete;
+  ConvertThreadState& operator=(const ConvertThreadState&) = delete;
+  ~ConvertThreadState()
+  {
+    for (ConvertPartition& partition : partitions)
+    {
+      mbedtls_aes_free(&partition.encrypt_key);
+      mbedtls_aes_free(&partition.decrypt_key);
+    }
+  }
+
+  std::vector<ConvertPartition> partitions;
+  std::vector<u8> decrypted;
+  std::vector<u8> reencrypted;
+};
+
+struct ConvertInput
+{
+  u64 chunk_num = 0;
+  // Raw data of the chunk and of every group that overlaps it
+  u64 raw_offset = 0;
+  std::vector<u8> raw;
+};
+
+struct ConvertOutput
+{
+  u64 chunk_num = 0;
+  std::vector<std::pair<u32, bool>> group_flags;
+  SHA1 payload_hash;
+  std::vector<u8> data;
+  bool compressed = false;
+};
+
+struct DecompressThreadState
+{
+  std::unique_ptr<DCXFileReader> reader;
+};
+
+struct DecompressOutput
+{
+  std::vector<u8> data;
+  bool success = false;
+};
+
+std::vector<DCXPartitionEntry> GetPartitionsToDecrypt(const std::string& infile_path,
+                                                      BlobReader* blob)
+{
+  std::vector<DCXPartitionEntry> entries;
+  const std::unique_ptr<Volume> volume = CreateVolumeFromFilename(infile_path);
+  if (!volume || volume->GetVolumeType() != Platform::WiiDisc)
+    return entries;
+
+  const u64 disc_size = blob->GetDataSize();
+  u32 num_groups = 0;
+  for (const Partition& partition : volume->GetPartitions())
+  {
+    const IOS::ES::TicketReader& ticket = volume->GetTicket(partition);
+    if (!ticket.IsValid())
+      continue;
+
+    DCXPartitionEntry entry = {};
+    entry.partition_offset = partition.offset;
+    entry.data_offset = partition.offset + PARTITION_DATA_OFFSET;
+    entry.title_key = ticket.GetTitleKey();
+
+    // Only store decrypted data if the partition data is where VolumeWii expects it
+    const std::optional<u32> data_offset = blob->ReadSwapped<u32>(partition.offset + 0x2B8);
+    const std::optional<u32> data_size = blob->ReadSwapped<u32>(partition.offset + 0x2BC);
+    if (data_offset && data_size && u64{*data_offset} << 2 == PARTITION_DATA_OFFSET &&
+        entry.data_offset < disc_size)
+    {
+      entry.data_size = std::min(u64{*data_size} << 2, disc_size - entry.data_offset);
+      entry.data_size -= entry.data_size % CLUSTER_SIZE;
+      entry.first_group = num_groups;
+      entry.num_groups = static_cast<u32>((entry.data_size + GROUP_SIZE - 1) / GROUP_SIZE);
+      num_groups += entry.num_groups;
+    }
+
+    entries.push_back(entry);
+  }
+
+  return entries;
+}
+
+// Builds the payload of a chunk. Groups that can be reproduced from their decrypted data
+// are stored decrypted, everything else is stored as-is.
+std::vector<u8> BuildPayload(const ConvertInput& input, u64 chunk_start, u64 chunk_end,
+                             ConvertThreadState* state, ConvertOutput* output)
+{
+  std::map<u32, bool> verified_groups;
+  auto verify_group = [&](ConvertPartition& partition, u64 group) {
+    const u32 global_group = partition.entry.first_group + static_cast<u32>(group);
+    auto it = verified_groups.find(global_group);
+    if (it != verified_groups.end())
+      return it->second;
+
+    const u64 group_offset = partition.entry.data_offset + group * GROUP_SIZE;
+    const u32 num_clusters = GetGroupClusterCount(partition.entry, group);
+    const u8* raw = input.raw.data() + (group_offset - input.raw_offset);
+
+    state->decrypted.resize(GROUP_DATA_SIZE);
+    state->reencrypted.resize(GROUP_SIZE);
+    for (u32 i = 0; i < num_clusters; ++i)
+    {
+      DecryptCluster(raw + static_cast<size_t>(i) * CLUSTER_SIZE, &partition.decrypt_key,
+                     &state->decrypted[i * CLUSTER_DATA_SIZE]);
+    }
+    EncryptGroup(state->decrypted.data(), num_clusters, &partition.encrypt_key,
+                 state->reencrypted.data());
+    const bool reproducible =
+        std::equal(raw, raw + static_cast<size_t>(num_clusters) * CLUSTER_SIZE,
+                   state->reencrypted.begin());
+
+    verified_groups.emplace(global_group, reproducible);
+    output->group_flags.emplace_back(global_group, reproducible);
+    return reproducible;
+  };
+
+  std::vector<u8> payload;
+  payload.reserve(chunk_end - chunk_start);
+  for (u64 cluster = chunk_start; cluster < chunk_end; cluster += CLUSTER_SIZE)
+  {
+    const u8* raw = input.raw.data() + (cluster - input.raw_offset);
+
+    ConvertPartition* partition = nullptr;
+    std::optional<u64> group;
+    for (ConvertPartition& p : state->partitions)
+    {
+      group = GetGroup(p.entry, cluster);
+      if (group)
+      {
+        partition = &p;
+        break;
+      }
+    }
+
+    if (partition && verify_group(*partition, *group))
+    {
+      u8 data[CLUSTER_DATA_SIZE];
+      DecryptCluster(raw, &partition->decrypt_key, data);
+      payload.insert(payload.end(), data, data + CLUSTER_DATA_SIZE);
+    }
+    else
+    {
+      payload.insert(payload.end(), raw, raw + std::min<u64>(CLUSTER_SIZE, chunk_end - cluster));
+    }
+  }
+
+  return payload;
+}
+}  // namespace
+
+bool ConvertToDCX(const std::string& infile_path, const std::string& outfile_path,
+                  DCXCompression compression, int compression_level, u32 chunk_size,
+                  CompressCB callback, void* arg)
+{
+  if (chunk_size == 0 || chunk_size % CLUSTER_SIZE != 0)
+  {
+    PanicAlert("Invalid DCX chunk size %u", chunk_size);
+    return false;
+  }
+
+  std::unique_ptr<BlobReader> blob = CreateBlobReader(infile_path);
+  if (!blob)
+  {
+    PanicAlertT("Failed to open the input file \"%s\".", infile_path.c_str());
+    return false;
+  }
+
+  if (blob->GetBlobType() == BlobType::DCX)
+  {
+    PanicAlertT("\"%s\" is already compressed! Cannot compress it further.", infile_path.c_str());
+    return false;
+  }
+
+  File::IOFile outfile(outfile_path, "wb");
+  if (!outfile)
+  {
+    PanicAlertT("Failed to open the output file \"%s\".\n"
+                "Check that you have permissions to write the target folder and that the media can "
+                "be written.",
+                outfile_path.c_str());
+    return false;
+  }
+
+  if (callback)
+    callback(GetStringT("Files opened, ready to compress."), 0, arg);
+
+  const std::vector<DCXPartitionEntry> partitions = GetPartitionsToDecrypt(infile_path, blob.get());
+
+  DCXHeader header = {};
+  header.magic = DCX_MAGIC;
+  header.version = DCX_VERSION;
+  header.data_size = blob->GetDataSize();
+  header.chunk_size = chunk_size;
+  header.compression = compression;
+  header.num_chunks = static_cast<u32>((header.data_size + chunk_size - 1) / chunk_size);
+  header.num_partitions = static_cast<u32>(partitions.size());
+  for (const DCXPartitionEntry& partition : partitions)
+    header.num_groups += partition.num_groups;
+
+  std::vector<u8> group_flags(header.num_groups);
+  std::vector<u32> chunk_index(header.num_chunks);
+  std::vector<DCXStoredChunk> stored_chunks;
+  std::map<SHA1, u32> stored_chunk_hashes;
+
+  // seek past the header (we will write it at the end)
+  outfile.Seek(sizeof(DCXHeader), SEEK_SET);
+
+  u64 position = sizeof(DCXHeader);
+  bool write_failed = false;
+  bool success = true;
+
+  auto set_up = [&partitions](ConvertThreadState* state) {
+    state->partitions.resize(partitions.size());
+    for (size_t i = 0; i < partitions.size(); ++i)
+    {
+      ConvertPartition& partition = state->partitions[i];
+      partition.entry = partitions[i];
+      mbedtls_aes_init(&partition.encrypt_key);
+      mbedtls_aes_init(&partition.decrypt_key);
+      mbedtls_aes_setkey_enc(&partition.encrypt_key, partition.entry.title_key.data(), 128);
+      mbedtls_aes_setkey_dec(&partition.decrypt_key, partition.entry.title_key.data(), 128);
+    }
+    return true;
+  };
+
+  auto compress = [&header, compression, compression_level](ConvertInput input,
+                                                             ConvertThreadState* state) {
+    ConvertOutput output;
+    output.chunk_num = input.chunk_num;
+
+    const u64 chunk_start = input.chunk_num * header.chunk_size;
+    const u64 chunk_end = std::min(chunk_start + header.chunk_size, header.data_size);
+    std::vector<u8> payload = BuildPayload(input, chunk_start, chunk_end, state, &output);
+    mbedtls_sha1(payload.data(), payload.size(), output.payload_hash.data());
+
+    if (compression == DCXCompression::Zlib)
+    {
+      uLongf compressed_size = compressBound(static_cast<uLong>(payload.size()));
+      output.data.resize(compressed_size);
+      if (compress2(output.data.data(), &compressed_size, payload.data(),
+                    static_cast<uLong>(payload.size()), compression_level) == Z_OK &&
+          compressed_size < payload.size())
+      {
+        output.data.resize(compressed_size);
+        output.compressed = true;
+        return output;
+      }
+    }
+
+    output.data = std::move(payload);
+    return output;
+  };
+
+  auto output = [&](ConvertOutput chunk) {
+    for (const auto& flag : chunk.group_flags)
+      group_flags[flag.first] = flag.second;
+
+    auto it = stored_chunk_hashes.find(chunk.payload_hash);
+    if (it != stored_chunk_hashes.end())
+    {
+      chunk_index[chunk.chunk_num] = it->second;
+      return true;
+    }
+
+    if (!outfile.WriteBytes(chunk.data.data(), chunk.data.size()))
+    {
+      write_failed = true;
+      return false;
+    }
+
+    DCXStoredChunk stored;
+    stored.offset = position | (chunk.compressed ? 0 : 1ULL << 63);
+    stored.size = static_cast<u32>(chunk.data.size());
+    stored.hash = HashAdler32(chunk.data.data(), chunk.data.size());
+
+    const u32 index = static_cast<u32>(stored_chunks.size());
+    stored_chunks.push_back(stored);
+    stored_chunk_hashes.emplace(chunk.payload_hash, index);
+    chunk_index[chunk.chunk_num] = index;
+    position += chunk.data.size();
+    return true;
+  };
+
+  const size_t num_threads = GetCompressionThreadCount();
+  MultithreadedCompressor<ConvertThreadState, ConvertInput, ConvertOutput> compressor(
+      set_up, compress, output, num_threads, "DCX Compress");
+
+  Common::Timer timer;
+  timer.Start();
+
+  const int progress_monitor = std::max<int>(1, header.num_chunks / 1000);
+  for (u32 i = 0; i < header.num_chunks; i++)
+  {
+    if (callback && i % progress_monitor == 0)
+    {
+      std::string temp = StringFromFormat(GetStringT("%i of %i blocks").c_str(), i,
+                                          header.num_chunks);
+      bool was_cancelled = !callback(temp, (float)i / (float)header.num_chunks, arg);
+      if (was_cancelled)
+      {
+        success = false;
+        break;
+      }
+    }
+
+    const u64 chunk_start = u64{i} * chunk_size;
+    const u64 chunk_end = std::min(chunk_start + chunk_size, header.data_size);
+
+    // Verifying a group requires all of it, even the parts outside of this chunk
+    ConvertInput input;
+    input.chunk_num = i;
+    input.raw_offset = chunk_start;
+    u64 raw_end = chunk_end;
+    for (const DCXPartitionEntry& partition : partitions)
+    {
+      const std::optional<u64> first_group =
+          GetGroup(partition, std::max(chunk_start, partition.data_offset));
+      const u64 last_cluster =
+          std::min(chunk_end, partition.data_offset + partition.data_size) - CLUSTER_SIZE;
+      const std::optional<u64> last_group = GetGroup(partition, last_cluster);
+      if (!first_group || !last_group)
+        continue;
+
+      input.raw_offset =
+          std::min(input.raw_offset, partition.data_offset + *first_group * GROUP_SIZE);
+      raw_end = std::max(raw_end, partition.data_offset + *last_group * GROUP_SIZE +
+                                      GetGroupClusterCount(partition, *last_group) * CLUSTER_SIZE);
+    }
+
+    input.raw.resize(raw_end - input.raw_offset);
+    if (!blob->Read(input.raw_offset, input.raw.size(), input.raw.data()))
+    {
+      PanicAlertT("Failed to read from the input file \"%s\".", infile_path.c_str());
+      success = false;
+      break;
+    }
+
+    if (!compressor.CompressAndWrite(std::move(input)))
+    {
+      success = false;
+      break;
+    }
+  }
+
+  if (success)
+    success = compressor.Shutdown();
+  else
+    compressor.Cancel();
+
+  if (write_failed)
+  {
+    PanicAlertT("Failed to write the output file \"%s\".\n"
+                "Check that you have enough space available on the target drive.",
+                outfile_path.c_str());
+  }
+
+  if (success)
+  {
+    header.table_offset = position;
+    header.num_stored_chunks = static_cast<u32>(stored_chunks.size());
+
+    success = outfile.WriteArray(partitions.data(), partitions.size()) &&
+              outfile.WriteArray(group_flags.data(), group_flags.size()) &&
+              outfile.WriteArray(chunk_index.data(), chunk_index.size()) &&
+              outfile.WriteArray(stored_chunks.data(), stored_chunks.size()) &&
+              outfile.Seek(0, SEEK_SET) && outfile.WriteArray(&header, 1);
+  }
+
+  if (!success)
+  {
+    // Remove the incomplete output file.
+    outfile.Close();
+    File::Delete(outfile_path);
+    return false;
+  }
+
+  const u64 elapsed_ms = timer.GetTimeElapsed();
+  const size_t decrypted_groups = std::count(group_flags.begin(), group_flags.end(), 1);
+  NOTICE_LOG(DISCIO,
+             "Converted %s to DCX: %u chunks (%u stored), %zu of %u Wii groups decrypted, "
+             "%" PRIu64 " bytes in %" PRIu64 " ms on %zu threads, %.1f MiB/s",
+             infile_path.c_str(), header.num_chunks, header.num_stored_chunks, decrypted_groups,
+             header.num_groups, position, elapsed_ms, num_threads,
+             GetThroughputMiBs(header.data_size, elapsed_ms));
+
+  if (callback)
+    callback(GetStringT("Done compressing disc image."), 1.0f, arg);
+  return true;
+}
+
+bool DecompressDCXToFile(const std::string& infile_path, const std::string& outfile_path,
+                         CompressCB callback, void* arg)
+{
+  std::unique_ptr<DCXFileReader> reader =
+      DCXFileReader::Create(File::IOFile(infile_path, "rb"), infile_path);
+  if (!reader)
+  {
+    PanicAlertT("Failed to open the input file \"%s\".", infile_path.c_str());
+    return false;
+  }
+
+  File::IOFile outfile(outfile_path, "wb");
+  if (!outfile)
+  {
+    PanicAlertT("Failed to open the output file \"%s\".\n"
+                "Check that you have permissions to write the target folder and that the media can "
+                "be written.",
+                outfile_path.c_str());
+    return false;
+  }
+
+  const DCXHeader header = reader->GetHeader();
+  reader.reset();
+  bool write_failed = false;
+  bool success = true;
+
+  // Every worker has its own reader (and with it, its own file handle and chunk cache)
+  auto set_up = [&infile_path](DecompressThreadState* state) {
+    state->reader = DCXFileReader::Create(File::IOFile(infile_path, "rb"), infile_path);
+    return state->reader != nullptr;
+  };
+
+  auto decompress = [&header](u64 chunk_num, DecompressThreadState* state) {
+    const u64 chunk_start = chunk_num * header.chunk_size;
+    const u64 chunk_end = std::min(chunk_start + header.chunk_size, header.data_size);
+
+    DecompressOutput output;
+    output.data.resize(chunk_end - chunk_start);
+    output.success = state->reader->Read(chunk_start, output.data.size(), output.data.data());
+    return output;
+  };
+
+  auto output = [&](DecompressOutput chunk) {
+    if (!chunk.success)
+      return false;
+
+    if (!outfile.WriteBytes(chunk.data.data(), chunk.data.size()))
+    {
+      write_failed = true;
+      return false;
+    }
+    return true;
+  };
+
+  const size_t num_threads = GetCompressionThreadCount();
+  MultithreadedCompressor<DecompressThreadState, u64, DecompressOutput> decompressor(
+      set_up, decompress, output, num_threads, "DCX Decompress");
+
+  Common::Timer timer;
+  timer.Start();
+
+  const int progress_monitor = std::max<int>(1, header.num_chunks / 100);
+  for (u32 i = 0; i < header.num_chunks; i++)
+  {
+    if (callback && i % progress_monitor == 0)
+    {
+      bool was_cancelled =
+          !callback(GetStringT("Unpacking"), (float)i / (float)header.num_chunks, arg);
+      if (was_cancelled)
+      {
+        success = false;
+        break;
+      }
+    }
+
+    if (!decompressor.CompressAndWrite(i))
+    {
+      success = false;
+      break;
+    }
+  }
+
+  if (success)
+    success = decompressor.Shutdown();
+  else
+    decompressor.Cancel();
+
+  if (write_failed)
+  {
+    PanicAlertT("Failed to write the output file \"%s\".\n"
+                "Check that you have enough space available on the target drive.",
+                outfile_path.c_str());
+  }
+
+  if (!success)
+  {
+    // Remove the incomplete output file.
+    outfile.Close();
+    File::Delete(outfile_path);
+    return false;
+  }
+
+  const u64 elapsed_ms = timer.GetTimeElapsed();
+  NOTICE_LOG(DISCIO, "Decompressed %s: %u chunks in %" PRIu64 " ms on %zu threads, %.1f MiB/s",
+             infile_path.c_str(), header.num_chunks, elapsed_ms, num_threads,
+             GetThroughputMiBs(header.data_size, elapsed_ms));
+  return true;
+}
+
+}  // namespace DiscIO
@@ -0,0 +1,163 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// WARNING Code not big-endian safe.
+
+// DCX is a chunked, deduplicated and compressed disc image format.
+// To create DCX files, use ConvertToDCX. To turn them back into plain images, use
+// DecompressDCXToFile.
+//
+// The disc is split into fixed-size chunks, so the chunk holding any offset is found
+// directly from the index. Identical chunks are only stored once.
+//
+// The encrypted data of Wii partitions barely compresses, so it is stored decrypted without
+// the hash blocks, one group (64 clusters, 2 MiB) at a time. When the encrypted data is
+// requested, the hashes are recomputed and the group is encrypted again. Groups are only
+// stored decrypted if doing this reproduces the original data exactly; all other data
+// (including junk clusters with invalid hashes) is stored as-is, so conversion is lossless.
+// Reading decrypted data through ReadWiiDecrypted skips the crypto completely.
+
+// File format
+// * Header
+// * [Chunk data]
+// * Partition table, group flags, chunk index and stored chunk table (at table_offset)
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mbedtls/aes.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "DiscIO/Blob.h"
+
+namespace DiscIO
+{
+static constexpr u32 DCX_MAGIC = 0x01584344;  // "DCX\x01" (byteswapped to little endian)
+static constexpr u32 DCX_VERSION = 1;
+
+// Chunks must be a multiple of the Wii cluster size.
+static constexpr u32 DCX_DEFAULT_CHUNK_SIZE = 0x200000;
+
+enum class DCXCompression : u32
+{
+  None = 0,
+  Zlib = 1,
+};
+
+struct DCXHeader  // 48 bytes
+{
+  u32 magic;
+  u32 version;
+  u64 data_size;
+  u64 table_offset;
+  u32 chunk_size;
+  DCXCompression compression;
+  u32 num_chunks;
+  u32 num_stored_chunks;
+  u32 num_partitions;
+  u32 num_groups;
+};
+
+struct DCXPartitionEntry  // 56 bytes
+{
+  u64 partition_offset;
+  // Raw position and size of the encrypted partition data
+  u64 data_offset;
+  u64 data_size;
+  std::array<u8, 16> title_key;
+  // Range of this partition's groups in the group flags table.
+  // A group is stored decrypted if its flag is non-zero.
+  u32 first_group;
+  u32 num_groups;
+  u64 reserved;
+};
+
+struct DCXStoredChunk  // 16 bytes
+{
+  // Top bit specifies whether the chunk is stored without compression.
+  u64 offset;
+  u32 size;
+  // Adler-32 of the stored bytes
+  u32 hash;
+};
+
+class DCXFileReader final : public BlobReader
+{
+public:
+  static std::unique_ptr<DCXFileReader> Create(File::IOFile file, const std::string& filename);
+  ~DCXFileReader();
+
+  const DCXHeader& GetHeader() const { return m_header; }
+  BlobType GetBlobType() const override { return BlobType::DCX; }
+  u64 GetDataSize() const override { return m_header.data_size; }
+  u64 GetRawSize() const override { return m_file_size; }
+  bool Read(u64 offset, u64 size, u8* out_ptr) override;
+
+  bool SupportsReadWiiDecrypted() const override { return !m_partitions.empty(); }
+  bool ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_offset) override;
+
+private:
+  struct Partition
+  {
+    DCXPartitionEntry entry;
+    mbedtls_aes_context encrypt_key;
+    mbedtls_aes_context decrypt_key;
+  };
+
+  struct CachedChunk
+  {
+    u64 chunk_num = UINT64_MAX;
+    u64 last_used = 0;
+    std::vector<u8> payload;
+    // Position of each cluster of the chunk in payload
+    std::vector<u32> cluster_offsets;
+  };
+
+  struct CachedGroup
+  {
+    const Partition* partition = nullptr;
+    u64 group = UINT64_MAX;
+    std::vector<u8> data;
+  };
+
+  DCXFileReader(File::IOFile file, const std::string& filename);
+  bool Initialize();
+
+  const CachedChunk* GetChunk(u64 chunk_num);
+  bool ReadChunkPayload(u64 chunk_num, std::vector<u8>* payload);
+  // Copies out the bytes of a cluster exactly as they are stored in its chunk
+  bool ReadStoredCluster(u64 cluster_offset, u32 offset_in_cluster, u32 size, u8* out_ptr);
+  const u8* GetEncryptedGroup(const Partition& partition, u64 group);
+
+  File::IOFile m_file;
+  std::string m_file_name;
+  u64 m_file_size = 0;
+
+  DCXHeader m_header = {};
+  std::vector<std::unique_ptr<Partition>> m_partitions;
+  std::vector<u8> m_group_flags;
+  std::vector<u32> m_chunk_index;
+  std::vector<DCXStoredChunk> m_stored_chunks;
+
+  static constexpr size_t CHUNK_CACHE_SIZE = 8;
+  std::array<CachedChunk, CHUNK_CACHE_SIZE> m_chunk_cache;
+  u64 m_chunk_cache_counter = 0;
+  CachedGroup m_group_cache;
+  std::vector<u8> m_compressed_buffer;
+  std::vector<u8> m_decrypted_group_buffer;
+};
+
+bool ConvertToDCX(const std::string& infile_path, const std::string& outfile_path,
+                  DCXCompression compression = DCXCompression::Zlib, int compression_level = 9,
+                  u32 chunk_size = DCX_DEFAULT_CHUNK_SIZE, CompressCB callback = nullptr,
+                  void* arg = nullptr);
+bool DecompressDCXToFile(const std::string& infile_path, const std::string& outfile_path,
+                         CompressCB callback = nullptr, void* arg = nullptr);
+
+}  // namespace DiscIO
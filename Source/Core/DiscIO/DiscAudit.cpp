@@ -0,0 +1,418 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/DiscAudit.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <mbedtls/aes.h>
+#include <mbedtls/md5.h>
+#include <mbedtls/sha1.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
+#include "Core/IOS/ES/Formats.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/DiscScrubber.h"
+#include "DiscIO/Enums.h"
+#include "DiscIO/MultithreadedCompressor.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeWii.h"
+
+namespace DiscIO
+{
+namespace
+{
+constexpr u32 CLUSTER_SIZE = VolumeWii::BLOCK_TOTAL_SIZE;
+constexpr u32 CLUSTER_HEADER_SIZE = VolumeWii::BLOCK_HEADER_SIZE;
+constexpr u32 CLUSTER_DATA_SIZE = VolumeWii::BLOCK_DATA_SIZE;
+constexpr u32 CLUSTERS_PER_SUBGROUP = 8;
+constexpr u32 CLUSTERS_PER_GROUP = 64;
+constexpr u32 GROUP_SIZE = CLUSTER_SIZE * CLUSTERS_PER_GROUP;
+// Data outside of partitions is read in pieces of the same size as a group
+constexpr u32 READ_SIZE = GROUP_SIZE;
+constexpr u32 H3_TABLE_SIZE = 0x18000;
+
+// Layout of the decrypted hash block at the start of each cluster.
+// http://wiibrew.org/wiki/Wii_Disc#Encrypted
+constexpr u32 H0_OFFSET = 0x000;
+constexpr u32 H0_COUNT = CLUSTER_DATA_SIZE / 0x400;
+constexpr u32 H0_PADDING_OFFSET = 0x26C;
+constexpr u32 H1_OFFSET = 0x280;
+constexpr u32 H2_OFFSET = 0x340;
+constexpr u32 IV_OFFSET = 0x3D0;
+constexpr u32 SHA1_SIZE = 20;
+
+using SHA1 = std::array<u8, SHA1_SIZE>;
+
+struct AuditPartition
+{
+  u64 data_offset;
+  u64 data_end;
+  mbedtls_aes_context key;
+  std::vector<u8> h3_table;
+  PartitionAuditResult result;
+};
+
+struct AuditInput
+{
+  u64 offset;
+  std::vector<u8> data;
+  // Set if data is a group of the partition with this index
+  std::optional<size_t> partition_index;
+  u64 group = 0;
+};
+
+struct AuditOutput
+{
+  AuditInput input;
+  u32 crc32 = 0;
+  PartitionAuditResult partition_result;
+  // Raw offsets of the clusters with hash errors
+  std::vector<u64> bad_clusters;
+};
+
+struct NoThreadState
+{
+};
+
+SHA1 ComputeSHA1(const u8* data, size_t size)
+{
+  SHA1 hash;
+  mbedtls_sha1(data, size, hash.data());
+  return hash;
+}
+
+bool HashMatches(const SHA1& hash, const u8* expected)
+{
+  return std::equal(hash.begin(), hash.end(), expected);
+}
+
+// Checks the hashes of a group of a partition. Works the same way as VolumeWii::CheckIntegrity,
+// but decrypts every cluster only once.
+void VerifyGroup(const AuditPartition& partition, AuditOutput* output)
+{
+  const std::vector<u8>& data = output->input.data;
+  const u32 num_clusters = static_cast<u32>(data.size() / CLUSTER_SIZE);
+  // mbedtls doesn't modify the context when crypting, so it can be shared by all threads
+  mbedtls_aes_context* key = const_cast<mbedtls_aes_context*>(&partition.key);
+
+  PartitionAuditResult& result = output->partition_result;
+  result.num_clusters = num_clusters;
+
+  std::array<u8, CLUSTER_HEADER_SIZE> hashes;
+  std::array<u8, CLUSTER_DATA_SIZE> decrypted;
+  std::optional<SHA1> h2_table_hash;
+  for (u32 i = 0; i < num_clusters; ++i)
+  {
+    const u8* cluster = data.data() + static_cast<size_t>(i) * CLUSTER_SIZE;
+    u8 iv[16] = {};
+    mbedtls_aes_crypt_cbc(key, MBEDTLS_AES_DECRYPT, CLUSTER_HEADER_SIZE, iv, cluster,
+                          hashes.data());
+
+    if (std::any_of(&hashes[H0_PADDING_OFFSET], &hashes[H1_OFFSET], [](u8 x) { return x != 0; }))
+    {
+      ++result.unhashed_clusters;
+      continue;
+    }
+
+    std::copy_n(cluster + IV_OFFSET, sizeof(iv), iv);
+    mbedtls_aes_crypt_cbc(key, MBEDTLS_AES_DECRYPT, CLUSTER_DATA_SIZE, iv,
+                          cluster + CLUSTER_HEADER_SIZE, decrypted.data());
+
+    bool h0_error = false;
+    for (u32 j = 0; j < H0_COUNT && !h0_error; ++j)
+    {
+      h0_error = !HashMatches(ComputeSHA1(&decrypted[j * 0x400], 0x400),
+                              &hashes[H0_OFFSET + j * SHA1_SIZE]);
+    }
+
+    const u32 index_in_subgroup = i % CLUSTERS_PER_SUBGROUP;
+    const u32 subgroup = i / CLUSTERS_PER_SUBGROUP;
+    const bool h1_error = !HashMatches(ComputeSHA1(&hashes[H0_OFFSET], H0_COUNT * SHA1_SIZE),
+                                       &hashes[H1_OFFSET + index_in_subgroup * SHA1_SIZE]);
+    const bool h2_error =
+        !HashMatches(ComputeSHA1(&hashes[H1_OFFSET], CLUSTERS_PER_SUBGROUP * SHA1_SIZE),
+                     &hashes[H2_OFFSET + subgroup * SHA1_SIZE]);
+
+    result.h0_errors += h0_error;
+    result.h1_errors += h1_error;
+    result.h2_errors += h2_error;
+    if (h0_error || h1_error || h2_error)
+      output->bad_clusters.push_back(output->input.offset + static_cast<u64>(i) * CLUSTER_SIZE);
+
+    // All clusters of a group share the same H2 table
+    if (!h2_table_hash)
+      h2_table_hash = ComputeSHA1(&hashes[H2_OFFSET], CLUSTERS_PER_SUBGROUP * SHA1_SIZE);
+  }
+
+  const u64 h3_offset = output->input.group * SHA1_SIZE;
+  if (h2_table_hash && (h3_offset + SHA1_SIZE > partition.h3_table.size() ||
+                        !HashMatches(*h2_table_hash, &partition.h3_table[h3_offset])))
+  {
+    ++result.h3_errors;
+  }
+}
+
+std::vector<std::unique_ptr<AuditPartition>>
+GetPartitionsToVerify(const Volume& volume, BlobReader* blob)
+{
+  std::vector<std::unique_ptr<AuditPartition>> partitions;
+  if (volume.GetVolumeType() != Platform::WiiDisc)
+    return partitions;
+
+  const u64 disc_size = blob->GetDataSize();
+  for (const Partition& partition : volume.GetPartitions())
+  {
+    const IOS::ES::TicketReader& ticket = volume.GetTicket(partition);
+    const std::optional<u32> h3_offset = blob->ReadSwapped<u32>(partition.offset + 0x2B4);
+    const std::optional<u32> data_offset = blob->ReadSwapped<u32>(partition.offset + 0x2B8);
+    const std::optional<u32> data_size = blob->ReadSwapped<u32>(partition.offset + 0x2BC);
+    if (!ticket.IsValid() || !h3_offset || !data_offset || !data_size)
+    {
+      ERROR_LOG(DISCIO, "Could not read the partition at 0x%" PRIx64, partition.offset);
+      continue;
+    }
+
+    auto entry = std::make_unique<AuditPartition>();
+    entry->data_offset = partition.offset + (u64{*data_offset} << 2);
+    if (entry->data_offset >= disc_size)
+      continue;
+    u64 size = std::min(u64{*data_size} << 2, disc_size - entry->data_offset);
+    entry->data_end = entry->data_offset + size - size % CLUSTER_SIZE;
+
+    entry->h3_table.resize(H3_TABLE_SIZE);
+    if (!blob->Read(partition.offset + (u64{*h3_offset} << 2), H3_TABLE_SIZE,
+                    entry->h3_table.data()))
+    {
+      entry->h3_table.clear();
+    }
+
+    mbedtls_aes_init(&entry->key);
+    mbedtls_aes_setkey_dec(&entry->key, ticket.GetTitleKey().data(), 128);
+
+    entry->result.partition_offset = partition.offset;
+    const IOS::ES::TMDReader& tmd = volume.GetTMD(partition);
+    if (tmd.IsValid() && !entry->h3_table.empty())
+    {
+      const std::vector<IOS::ES::Content> contents = tmd.GetContents();
+      entry->result.h3_table_valid =
+          !contents.empty() &&
+          HashMatches(ComputeSHA1(entry->h3_table.data(), H3_TABLE_SIZE), contents[0].sha1.data());
+    }
+
+    partitions.push_back(std::move(entry));
+  }
+
+  std::sort(partitions.begin(), partitions.end(), [](const auto& a, const auto& b) {
+    return a->data_offset < b->data_offset;
+  });
+  return partitions;
+}
+
+double GetThroughputMiBs(u64 bytes, u64 elapsed_ms)
+{
+  return elapsed_ms == 0 ? 0.0 : (bytes / (1024.0 * 1024.0)) / (elapsed_ms / 1000.0);
+}
+}  // namespace
+
+bool AuditDisc(const std::string& infile_path, DiscAuditResult* result,
+               const std::string& scrub_bitmap_path, CompressCB callback, void* arg)
+{
+  *result = DiscAuditResult();
+
+  std::unique_ptr<BlobReader> blob = CreateBlobReader(infile_path);
+  std::unique_ptr<Volume> volume = CreateVolumeFromFilename(infile_path);
+  if (!blob || !volume)
+  {
+    PanicAlertT("Failed to open the input file \"%s\".", infile_path.c_str());
+    return false;
+  }
+
+  result->data_size = blob->GetDataSize();
+  const bool is_wii = volume->GetVolumeType() == Platform::WiiDisc;
+  const std::vector<std::unique_ptr<AuditPartition>> partitions =
+      GetPartitionsToVerify(*volume, blob.get());
+  volume.reset();
+  for (const std::unique_ptr<AuditPartition>& partition : partitions)
+    result->partitions.push_back(partition->result);
+
+  // Finding the used clusters only takes small reads of the file system, so it runs on its own
+  // thread (with its own file handle) while the whole disc is read and hashed.
+  DiscScrubber scrubber;
+  bool scrubbed = false;
+  std::thread scrub_thread;
+  if (is_wii)
+  {
+    scrub_thread = std::thread([&] {
+      Common::SetCurrentThreadName("Disc Audit Scrub");
+      scrubbed = scrubber.SetupScrub(infile_path, CLUSTER_SIZE);
+    });
+  }
+
+  uLong crc = crc32(0, nullptr, 0);
+  mbedtls_md5_context md5;
+  mbedtls_md5_init(&md5);
+  mbedtls_md5_starts(&md5);
+  std::vector<u64> bad_clusters;
+
+  auto set_up = [](NoThreadState*) { return true; };
+
+  auto verify = [&partitions](AuditInput input, NoThreadState*) {
+    AuditOutput output;
+    output.input = std::move(input);
+    const std::vector<u8>& data = output.input.data;
+    output.crc32 = static_cast<u32>(
+        crc32(crc32(0, nullptr, 0), data.data(), static_cast<uInt>(data.size())));
+    if (output.input.partition_index)
+      VerifyGroup(*partitions[*output.input.partition_index], &output);
+    return output;
+  };
+
+  auto output = [&](AuditOutput audited) {
+    const std::vector<u8>& data = audited.input.data;
+    crc = crc32_combine(crc, audited.crc32, static_cast<z_off_t>(data.size()));
+    mbedtls_md5_update(&md5, data.data(), data.size());
+
+    if (audited.input.partition_index)
+    {
+      PartitionAuditResult& partition = result->partitions[*audited.input.partition_index];
+      const PartitionAuditResult& group = audited.partition_result;
+      partition.num_clusters += group.num_clusters;
+      partition.unhashed_clusters += group.unhashed_clusters;
+      partition.h0_errors += group.h0_errors;
+      partition.h1_errors += group.h1_errors;
+      partition.h2_errors += group.h2_errors;
+      partition.h3_errors += group.h3_errors;
+      bad_clusters.insert(bad_clusters.end(), audited.bad_clusters.begin(),
+                          audited.bad_clusters.end());
+    }
+    return true;
+  };
+
+  MultithreadedCompressor<NoThreadState, AuditInput, AuditOutput> verifier(
+      set_up, verify, output, GetCompressionThreadCount(), "Disc Audit");
+
+  Common::Timer timer;
+  timer.Start();
+
+  bool success = true;
+  const u64 data_size = result->data_size;
+  u64 offset = 0;
+  u64 progress_counter = 0;
+  while (offset < data_size)
+  {
+    AuditInput input;
+    input.offset = offset;
+
+    // Partition data is split into whole groups so that each one can be checked on its own
+    u64 end = std::min<u64>(offset + READ_SIZE, data_size);
+    for (size_t i = 0; i < partitions.size(); ++i)
+    {
+      const AuditPartition& partition = *partitions[i];
+      if (offset >= partition.data_offset && offset < partition.data_end)
+      {
+        input.partition_index = i;
+        input.group = (offset - partition.data_offset) / GROUP_SIZE;
+        end = std::min<u64>(partition.data_offset + (input.group + 1) * GROUP_SIZE,
+                            partition.data_end);
+        break;
+      }
+      if (partition.data_offset > offset)
+        end = std::min(end, partition.data_offset);
+    }
+
+    input.data.resize(end - offset);
+    if (!blob->Read(offset, input.data.size(), input.data.data()))
+    {
+      PanicAlertT("Failed to read from the input file \"%s\".", infile_path.c_str());
+      success = false;
+      break;
+    }
+
+    if (callback && progress_counter++ % 16 == 0)
+    {
+      const float percent = static_cast<float>(offset) / static_cast<float>(data_size);
+      const std::string text =
+          StringFromFormat(GetStringT("Verified %i%%").c_str(), static_cast<int>(percent * 100));
+      if (!callback(text, percent, arg))
+      {
+        success = false;
+        break;
+      }
+    }
+
+    offset = end;
+    if (!verifier.CompressAndWrite(std::move(input)))
+    {
+      success = false;
+      break;
+    }
+  }
+
+  if (success)
+    success = verifier.Shutdown();
+  else
+    verifier.Cancel();
+
+  if (scrub_thread.joinable())
+    scrub_thread.join();
+
+  for (const std::unique_ptr<AuditPartition>& partition : partitions)
+    mbedtls_aes_free(&partition->key);
+
+  std::array<u8, 16> md5_hash;
+  mbedtls_md5_finish(&md5, md5_hash.data());
+  mbedtls_md5_free(&md5);
+
+  if (!success)
+    return false;
+
+  result->crc32 = static_cast<u32>(crc);
+  result->md5 = md5_hash;
+
+  if (scrubbed)
+    result->used_clusters = scrubber.GetUsedClusterCount();
+  for (u64 cluster_offset : bad_clusters)
+  {
+    if (!scrubbed || scrubber.IsClusterUsed(cluster_offset))
+    {
+      auto it = std::find_if(result->partitions.rbegin(), result->partitions.rend(),
+                             [cluster_offset](const PartitionAuditResult& partition) {
+                               return partition.partition_offset <= cluster_offset;
+                             });
+      if (it != result->partitions.rend())
+        ++it->errors_in_used_clusters;
+    }
+  }
+
+  if (scrubbed && !scrub_bitmap_path.empty())
+  {
+    result->scrub_bitmap_written = scrubber.SaveScrubBitmap(scrub_bitmap_path);
+    if (!result->scrub_bitmap_written)
+      ERROR_LOG(DISCIO, "Failed to write the scrub bitmap %s", scrub_bitmap_path.c_str());
+  }
+
+  const u64 elapsed = timer.GetTimeElapsed();
+  NOTICE_LOG(DISCIO, "Audited %s in %" PRIu64 " ms on %zu threads (%.1f MiB/s)",
+             infile_path.c_str(), elapsed, GetCompressionThreadCount(),
+             GetThroughputMiBs(data_size, elapsed));
+
+  return true;
+}
+
+}  // namespace DiscIO
@@ -0,0 +1,60 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// AuditDisc reads a whole disc image once and uses every core to check it:
+// * CRC32 and MD5 of the image (as seen by the emulator, so compressed formats work too)
+// * The H0-H3 SHA-1 hashes of every cluster of every Wii partition, and the H3 table against
+//   the TMD
+// * Which clusters are used (Wii only), written out as a scrub bitmap that
+//   CompressFileToBlob can use instead of parsing the disc again
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/Blob.h"
+
+namespace DiscIO
+{
+struct PartitionAuditResult
+{
+  u64 partition_offset = 0;
+  u64 num_clusters = 0;
+  // Clusters whose hash block isn't padded with zeroes. These are usually junk that the game
+  // never reads (holes between files), so their hashes are not checked.
+  u64 unhashed_clusters = 0;
+  // Clusters with at least one data block that doesn't match its H0 hash
+  u64 h0_errors = 0;
+  // Clusters whose H0 table doesn't match its H1 hash
+  u64 h1_errors = 0;
+  // Clusters whose H1 table doesn't match its H2 hash
+  u64 h2_errors = 0;
+  // Groups whose H2 table doesn't match the H3 table
+  u64 h3_errors = 0;
+  // Bad clusters that the game can actually read. Equal to the number of bad clusters if the
+  // used clusters couldn't be determined.
+  u64 errors_in_used_clusters = 0;
+  // Whether the H3 table matches the hash of the partition's first content in the TMD
+  bool h3_table_valid = false;
+};
+
+struct DiscAuditResult
+{
+  u64 data_size = 0;
+  u32 crc32 = 0;
+  std::array<u8, 16> md5{};
+  std::vector<PartitionAuditResult> partitions;
+  bool scrub_bitmap_written = false;
+  u64 used_clusters = 0;
+};
+
+// If scrub_bitmap_path is empty, no scrub bitmap is written.
+bool AuditDisc(const std::string& infile_path, DiscAuditResult* result,
+               const std::string& scrub_bitmap_path = "", CompressCB callback = nullptr,
+               void* arg = nullptr);
+
+}  // namespace DiscIO
@@ -5,6 +5,7 @@
 #include "DiscIO/DiscScrubber.h"
 
 #include <algorithm>
+#include <array>
 #include <cinttypes>
 #include <cstddef>
 #include <cstdio>
@@ -16,7 +17,9 @@
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
 #include "Common/Logging/Log.h"
+#include "Common/Swap.h"
 
+#include "DiscIO/Blob.h"
 #include "DiscIO/DiscExtractor.h"
 #include "DiscIO/Filesystem.h"
 #include "DiscIO/Volume.h"
@@ -24,6 +27,26 @@
 namespace DiscIO
 {
 constexpr size_t CLUSTER_SIZE = 0x8000;
+constexpr size_t PARTITION_HEADER_SIZE = 0x2c0;
+
+constexpr u32 SCRUB_BITMAP_MAGIC = 0x42524353;  // "SCRB" (byteswapped to little endian)
+constexpr u32 SCRUB_BITMAP_VERSION = 1;
+
+struct ScrubBitmapHeader  // 32 bytes
+{
+  u32 magic;
+  u32 version;
+  u64 data_size;
+  // The first 8 bytes of the disc (game ID, maker ID, disc number and revision)
+  std::array<u8, 8> disc_id;
+  u32 cluster_size;
+  u32 num_clusters;
+};
+
+std::string GetScrubBitmapPath(const std::string& image_path)
+{
+  return image_path + ".scrub";
+}
 
 DiscScrubber::DiscScrubber() = default;
 DiscScrubber::~DiscScrubber() = default;
@@ -45,6 +68,8 @@ bool DiscScrubber::SetupScrub(const std::string& filename, int block_size)
     return false;
 
   m_file_size = m_disc->GetSize();
+  if (!m_disc->Read(0, m_disc_id.size(), m_disc_id.data(), PARTITION_NONE))
+    return false;
 
   const size_t num_clusters = static_cast<size_t>(m_file_size / CLUSTER_SIZE);
 
@@ -69,6 +94,90 @@ bool DiscScrubber::SetupScrub(const std::string& filename, int block_size)
   return success;
 }
 
+bool DiscScrubber::SetupScrubFromBitmap(const std::string& bitmap_path,
+                                        const std::string& filename, int block_size)
+{
+  m_filename = filename;
+  m_block_size = block_size;
+  m_is_scrubbing = false;
+
+  if (CLUSTER_SIZE % m_block_size != 0)
+  {
+    ERROR_LOG(DISCIO, "Block size %u is not a factor of 0x8000, scrubbing not possible",
+              m_block_size);
+    return false;
+  }
+
+  const std::unique_ptr<BlobReader> blob = CreateBlobReader(filename);
+  if (!blob || !blob->Read(0, m_disc_id.size(), m_disc_id.data()))
+    return false;
+  m_file_size = blob->GetDataSize();
+
+  File::IOFile file(bitmap_path, "rb");
+  ScrubBitmapHeader header;
+  if (!file.ReadArray(&header, 1) || header.magic != SCRUB_BITMAP_MAGIC ||
+      header.version != SCRUB_BITMAP_VERSION || header.cluster_size != CLUSTER_SIZE)
+  {
+    ERROR_LOG(DISCIO, "%s is not a valid scrub bitmap", bitmap_path.c_str());
+    return false;
+  }
+
+  if (header.data_size != m_file_size || header.disc_id != m_disc_id ||
+      header.num_clusters != m_file_size / CLUSTER_SIZE)
+  {
+    ERROR_LOG(DISCIO, "Scrub bitmap %s does not belong to %s", bitmap_path.c_str(),
+              filename.c_str());
+    return false;
+  }
+
+  std::vector<u8> bits((header.num_clusters + 7) / 8);
+  if (!file.ReadBytes(bits.data(), bits.size()))
+    return false;
+
+  m_free_table.resize(header.num_clusters);
+  for (size_t i = 0; i < m_free_table.size(); ++i)
+    m_free_table[i] = (bits[i / 8] >> (i % 8) & 1) ? 0 : 1;
+
+  m_block_count = 0;
+  m_is_scrubbing = true;
+  return true;
+}
+
+bool DiscScrubber::SaveScrubBitmap(const std::string& bitmap_path) const
+{
+  if (!m_is_scrubbing)
+    return false;
+
+  ScrubBitmapHeader header;
+  header.magic = SCRUB_BITMAP_MAGIC;
+  header.version = SCRUB_BITMAP_VERSION;
+  header.data_size = m_file_size;
+  header.disc_id = m_disc_id;
+  header.cluster_size = CLUSTER_SIZE;
+  header.num_clusters = static_cast<u32>(m_free_table.size());
+
+  std::vector<u8> bits((m_free_table.size() + 7) / 8);
+  for (size_t i = 0; i < m_free_table.size(); ++i)
+  {
+    if (!m_free_table[i])
+      bits[i / 8] |= 1 << (i % 8);
+  }
+
+  File::IOFile file(bitmap_path, "wb");
+  return file.WriteArray(&header, 1) && file.WriteBytes(bits.data(), bits.size());
+}
+
+bool DiscScrubber::IsClusterUsed(u64 offset) const
+{
+  const u64 cluster = offset / CLUSTER_SIZE;
+  return !m_is_scrubbing || cluster >= m_free_table.size() || !m_free_table[cluster];
+}
+
+u64 DiscScrubber::GetUsedClusterCount() const
+{
+  return std::count(m_free_table.begin(), m_free_table.end(), 0);
+}
+
 size_t DiscScrubber::GetNextBlock(File::IOFile& in, u8* buffer)
 {
   const u64 current_offset = m_block_count * m_block_size;
@@ -125,23 +234,6 @@ void DiscScrubber::MarkAsUsedE(u64 partition_data_offset, u64 offset, u64 size)
   MarkAsUsed(first_cluster_start, last_cluster_end - first_cluster_start);
 }
 
-// Helper functions for reading the BE volume
-bool DiscScrubber::ReadFromVolume(u64 offset, u32& buffer, const Partition& partition)
-{
-  std::optional<u32> value = m_disc->ReadSwapped<u32>(offset, partition);
-  if (value)
-    buffer = *value;
-  return value.has_value();
-}
-
-bool DiscScrubber::ReadFromVolume(u64 offset, u64& buffer, const Partition& partition)
-{
-  std::optional<u64> value = m_disc->ReadSwappedAndShifted(offset, partition);
-  if (value)
-    buffer = *value;
-  return value.has_value();
-}
-
 bool DiscScrubber::ParseDisc()
 {
   // Mark the header as used - it's mostly 0s anyways
@@ -149,20 +241,21 @@ bool DiscScrubber::ParseDisc()
 
   for (const DiscIO::Partition& partition : m_disc->GetPartitions())
   {
-    PartitionHeader header;
-
-    if (!ReadFromVolume(partition.offset + 0x2a4, header.tmd_size, PARTITION_NONE) ||
-        !ReadFromVolume(partition.offset + 0x2a8, header.tmd_offset, PARTITION_NONE) ||
-        !ReadFromVolume(partition.offset + 0x2ac, header.cert_chain_size, PARTITION_NONE) ||
-        !ReadFromVolume(partition.offset + 0x2b0, header.cert_chain_offset, PARTITION_NONE) ||
-        !ReadFromVolume(partition.offset + 0x2b4, header.h3_offset, PARTITION_NONE) ||
-        !ReadFromVolume(partition.offset + 0x2b8, header.data_offset, PARTITION_NONE) ||
-        !ReadFromVolume(partition.offset + 0x2bc, header.data_size, PARTITION_NONE))
-    {
+    // Read the whole partition header at once instead of one field at a time
+    std::array<u8, PARTITION_HEADER_SIZE> raw_header;
+    if (!m_disc->Read(partition.offset, raw_header.size(), raw_header.data(), PARTITION_NONE))
       return false;
-    }
 
-    MarkAsUsed(partition.offset, 0x2c0);
+    PartitionHeader header;
+    header.tmd_size = Common::swap32(&raw_header[0x2a4]);
+    header.tmd_offset = u64{Common::swap32(&raw_header[0x2a8])} << 2;
+    header.cert_chain_size = Common::swap32(&raw_header[0x2ac]);
+    header.cert_chain_offset = u64{Common::swap32(&raw_header[0x2b0])} << 2;
+    header.h3_offset = u64{Common::swap32(&raw_header[0x2b4])} << 2;
+    header.data_offset = u64{Common::swap32(&raw_header[0x2b8])} << 2;
+    header.data_size = u64{Common::swap32(&raw_header[0x2bc])} << 2;
+
+    MarkAsUsed(partition.offset, PARTITION_HEADER_SIZE);
 
     MarkAsUsed(partition.offset + header.tmd_offset, header.tmd_size);
     MarkAsUsed(partition.offset + header.cert_chain_offset, header.cert_chain_size);
@@ -192,13 +285,21 @@ bool DiscScrubber::ParsePartitionData(const Partition& partition, PartitionHeade
 
   const u64 partition_data_offset = partition.offset + header->data_offset;
 
+  // The FST location (0x424) and the apploader header (0x2440) are read in a single call,
+  // which decrypts the first cluster of the partition only once.
+  constexpr u64 HEADER_READ_START = 0x420;
+  constexpr u64 HEADER_READ_END = 0x2440 + 0x20;
+  std::array<u8, HEADER_READ_END - HEADER_READ_START> disc_header;
+  if (!m_disc->Read(HEADER_READ_START, disc_header.size(), disc_header.data(), partition))
+    return false;
+  auto read_u32 = [&disc_header](u64 offset) {
+    return Common::swap32(&disc_header[offset - HEADER_READ_START]);
+  };
+
   // Mark things as used which are not in the filesystem
   // Header, Header Information, Apploader
-  if (!ReadFromVolume(0x2440 + 0x14, header->apploader_size, partition) ||
-      !ReadFromVolume(0x2440 + 0x18, header->apploader_size, partition))
-  {
-    return false;
-  }
+  header->apploader_size = read_u32(0x2440 + 0x14);
+  header->apploader_trailer_size = read_u32(0x2440 + 0x18);
   MarkAsUsedE(partition_data_offset, 0,
               0x2440 + header->apploader_size + header->apploader_trailer_size);
 
@@ -214,11 +315,8 @@ bool DiscScrubber::ParsePartitionData(const Partition& partition, PartitionHeade
   MarkAsUsedE(partition_data_offset, header->dol_offset, header->dol_size);
 
   // FST
-  if (!ReadFromVolume(0x424, header->fst_offset, partition) ||
-      !ReadFromVolume(0x428, header->fst_size, partition))
-  {
-    return false;
-  }
+  header->fst_offset = u64{read_u32(0x424)} << 2;
+  header->fst_size = u64{read_u32(0x428)} << 2;
   MarkAsUsedE(partition_data_offset, header->fst_offset, header->fst_size);
 
   // Go through the filesystem and mark entries as used
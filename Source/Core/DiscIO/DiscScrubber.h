@@ -10,6 +10,9 @@
 
 // Note: the technique is inspired by Wiiscrubber, but much simpler - intentionally :)
 
+// The result of a scrub can be saved as a bitmap (one bit per 0x8000 byte cluster, set if the
+// cluster is used) so that later conversions don't have to parse the disc again.
+
 #pragma once
 
 #include <array>
@@ -29,6 +32,9 @@ class FileInfo;
 class Volume;
 struct Partition;
 
+// Where the scrub bitmap of a disc image is kept by default
+std::string GetScrubBitmapPath(const std::string& image_path);
+
 class DiscScrubber final
 {
 public:
@@ -36,8 +42,16 @@ public:
   ~DiscScrubber();
 
   bool SetupScrub(const std::string& filename, int block_size);
+  // Like SetupScrub, but takes the used clusters from a bitmap written by SaveScrubBitmap.
+  // Fails if the bitmap was made for a different disc.
+  bool SetupScrubFromBitmap(const std::string& bitmap_path, const std::string& filename,
+                            int block_size);
   size_t GetNextBlock(File::IOFile& in, u8* buffer);
 
+  bool SaveScrubBitmap(const std::string& bitmap_path) const;
+  bool IsClusterUsed(u64 offset) const;
+  u64 GetUsedClusterCount() const;
+
 private:
   struct PartitionHeader final
   {
@@ -61,8 +75,6 @@ private:
 
   void MarkAsUsed(u64 offset, u64 size);
   void MarkAsUsedE(u64 partition_data_offset, u64 offset, u64 size);
-  bool ReadFromVolume(u64 offset, u32& buffer, const Partition& partition);
-  bool ReadFromVolume(u64 offset, u64& buffer, const Partition& partition);
   bool ParseDisc();
   bool ParsePartitionData(const Partition& partition, PartitionHeader* header);
   void ParseFileSystemData(u64 partition_data_offset, const FileInfo& directory);
@@ -71,6 +83,7 @@ private:
   std::unique_ptr<Volume> m_disc;
 
   std::vector<u8> m_free_table;
+  std::array<u8, 8> m_disc_id{};
   u64 m_file_size = 0;
   u64 m_block_count = 0;
   u32 m_block_size = 0;
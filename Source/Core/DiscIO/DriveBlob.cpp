@@ -148,8 +148,7 @@ bool DriveReader::ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* o
   }
   return bytes_read == GetSectorSize() * num_blocks;
 #else
-  m_file.Seek(GetSectorSize() * block_num, SEEK_SET);
-  if (m_file.ReadBytes(out_ptr, num_blocks * GetSectorSize()))
+  if (m_file.ReadAt(GetSectorSize() * block_num, out_ptr, num_blocks * GetSectorSize()))
     return true;
   m_file.Clear();
   return false;
@@ -0,0 +1,209 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// MultithreadedCompressor runs a compression (or decompression) function on a set of
+// worker threads while keeping the results in submission order.
+//
+// The caller acts as the reader and feeds inputs through CompressAndWrite(). Each worker
+// owns a ThreadState (for example a z_stream) that is set up once and reused for every
+// input it processes. Once an input is processed, the worker waits until all earlier inputs
+// have been handed to the output function, so the output function is always called
+// sequentially and in order, which makes it safe to write to a file from it.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+
+namespace DiscIO
+{
+// The number of worker threads to use when converting disc images.
+inline size_t GetCompressionThreadCount()
+{
+  return static_cast<size_t>(std::max(1, cpu_info.logical_cpu_count));
+}
+
+template <typename ThreadState, typename Input, typename Output>
+class MultithreadedCompressor final
+{
+public:
+  using SetUpFunction = std::function<bool(ThreadState*)>;
+  using CompressFunction = std::function<Output(Input, ThreadState*)>;
+  using OutputFunction = std::function<bool(Output)>;
+
+  MultithreadedCompressor(SetUpFunction set_up, CompressFunction compress, OutputFunction output,
+                          size_t num_threads, const char* thread_name)
+      : m_set_up(std::move(set_up)), m_compress(std::move(compress)),
+        m_output(std::move(output)), m_max_queued(2 * std::max<size_t>(num_threads, 1))
+  {
+    num_threads = std::max<size_t>(num_threads, 1);
+    m_threads.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+      m_threads.emplace_back([this, i, thread_name] {
+        Common::SetCurrentThreadName(StringFromFormat("%s %zu", thread_name, i).c_str());
+        WorkerThread();
+      });
+    }
+  }
+
+  ~MultithreadedCompressor() { Cancel(); }
+  MultithreadedCompressor(const MultithreadedCompressor&) = delete;
+  MultithreadedCompressor& operator=(const MultithreadedCompressor&) = delete;
+
+  // Queues an input. Blocks while the workers are too far behind.
+  // Returns false if processing has failed or was cancelled; the input is dropped in that case.
+  bool CompressAndWrite(Input input)
+  {
+    std::unique_lock<std::mutex> lock(m_queue_mutex);
+    m_space_available.wait(lock, [this] { return m_queue.size() < m_max_queued || m_stopped; });
+    if (m_stopped)
+      return false;
+
+    m_queue.push_back(Job{m_next_input_index++, std::move(input)});
+    lock.unlock();
+    m_work_available.notify_one();
+    return true;
+  }
+
+  // Waits for every queued input to reach the output function, then stops the workers.
+  // Returns false if any set up or output call failed.
+  bool Shutdown()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_queue_mutex);
+      m_finishing = true;
+    }
+    m_work_available.notify_all();
+    JoinThreads();
+    return !m_failed.load();
+  }
+
+  // Stops the workers as soon as possible. Queued inputs are discarded.
+  void Cancel()
+  {
+    Stop();
+    JoinThreads();
+  }
+
+  bool HasFailed() const { return m_failed.load(); }
+
+private:
+  struct Job
+  {
+    u64 index;
+    Input input;
+  };
+
+  void WorkerThread()
+  {
+    ThreadState state;
+    if (!m_set_up(&state))
+    {
+      Fail();
+      return;
+    }
+
+    while (true)
+    {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(m_queue_mutex);
+        m_work_available.wait(lock,
+                              [this] { return !m_queue.empty() || m_finishing || m_stopped; });
+        if (m_stopped || m_queue.empty())
+          return;
+
+        job = std::move(m_queue.front());
+        m_queue.pop_front();
+      }
+      m_space_available.notify_one();
+
+      Output output = m_compress(std::move(job.input), &state);
+
+      std::unique_lock<std::mutex> lock(m_output_mutex);
+      m_output_turn.wait(lock,
+                         [this, &job] { return m_next_output_index == job.index || m_stopped; });
+      if (m_stopped)
+        return;
+
+      const bool success = m_output(std::move(output));
+      ++m_next_output_index;
+      lock.unlock();
+      m_output_turn.notify_all();
+
+      if (!success)
+      {
+        Fail();
+        return;
+      }
+    }
+  }
+
+  void Fail()
+  {
+    m_failed.store(true);
+    Stop();
+  }
+
+  void Stop()
+  {
+    {
+      std::lock_guard<std::mutex> queue_lock(m_queue_mutex);
+      std::lock_guard<std::mutex> output_lock(m_output_mutex);
+      m_stopped = true;
+      m_queue.clear();
+    }
+    m_work_available.notify_all();
+    m_space_available.notify_all();
+    m_output_turn.notify_all();
+  }
+
+  void JoinThreads()
+  {
+    for (std::thread& thread : m_threads)
+    {
+      if (thread.joinable())
+        thread.join();
+    }
+  }
+
+  SetUpFunction m_set_up;
+  CompressFunction m_compress;
+  OutputFunction m_output;
+
+  std::vector<std::thread> m_threads;
+  std::atomic<bool> m_failed{false};
+
+  // Guarded by m_queue_mutex
+  std::mutex m_queue_mutex;
+  std::condition_variable m_work_available;
+  std::condition_variable m_space_available;
+  std::deque<Job> m_queue;
+  const size_t m_max_queued;
+  u64 m_next_input_index = 0;
+  bool m_finishing = false;
+  bool m_stopped = false;
+
+  // Guarded by m_output_mutex
+  std::mutex m_output_mutex;
+  std::condition_variable m_output_turn;
+  u64 m_next_output_index = 0;
+};
+
+}  // namespace DiscIO
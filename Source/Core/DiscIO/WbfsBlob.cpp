@@ -117,15 +117,16 @@ bool WbfsFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
 {
   while (nbytes)
   {
+    u64 file_offset;
     u64 read_size;
-    File::IOFile& data_file = SeekToCluster(offset, &read_size);
-    if (read_size == 0)
+    FileEntry* file_entry = FindClusters(offset, nbytes, &file_offset, &read_size);
+    if (!file_entry)
       return false;
     read_size = std::min(read_size, nbytes);
 
-    if (!data_file.ReadBytes(out_ptr, read_size))
+    if (!file_entry->file.ReadAt(file_offset, out_ptr, read_size))
     {
-      data_file.Clear();
+      file_entry->file.Clear();
       return false;
     }
 
@@ -137,7 +138,8 @@ bool WbfsFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
   return true;
 }
 
-File::IOFile& WbfsFileReader::SeekToCluster(u64 offset, u64* available)
+WbfsFileReader::FileEntry* WbfsFileReader::FindClusters(u64 offset, u64 size, u64* file_offset,
+                                                         u64* available)
 {
   u64 base_cluster = (offset >> m_header.wbfs_sector_shift);
   if (base_cluster < m_blocks_per_disc)
@@ -150,24 +152,27 @@ File::IOFile& WbfsFileReader::SeekToCluster(u64 offset, u64* available)
     {
       if (final_address < (file_entry.base_address + file_entry.size))
       {
-        file_entry.file.Seek(final_address - file_entry.base_address, SEEK_SET);
-        if (available)
+        *file_offset = final_address - file_entry.base_address;
+
+        // Clusters that are stored right after each other can be read in one go.
+        u64 till_end_of_run = m_wbfs_sector_size - cluster_offset;
+        u64 last_cluster = base_cluster;
+        while (till_end_of_run < size && last_cluster + 1 < m_blocks_per_disc &&
+               m_wlba_table[last_cluster + 1] == m_wlba_table[last_cluster] + 1)
         {
-          u64 till_end_of_file = file_entry.size - (final_address - file_entry.base_address);
-          u64 till_end_of_sector = m_wbfs_sector_size - cluster_offset;
-          *available = std::min(till_end_of_file, till_end_of_sector);
+          ++last_cluster;
+          till_end_of_run += m_wbfs_sector_size;
         }
 
-        return file_entry.file;
+        u64 till_end_of_file = file_entry.size - *file_offset;
+        *available = std::min(till_end_of_file, till_end_of_run);
+        return &file_entry;
       }
     }
   }
 
   PanicAlert("Read beyond end of disc");
-  if (available)
-    *available = 0;
-  m_files[0].file.Seek(0, SEEK_SET);
-  return m_files[0].file;
+  return nullptr;
 }
 
 std::unique_ptr<WbfsFileReader> WbfsFileReader::Create(File::IOFile file, const std::string& path)
@@ -39,7 +39,6 @@ private:
   bool AddFileToList(File::IOFile file);
   bool ReadHeader();
 
-  File::IOFile& SeekToCluster(u64 offset, u64* available);
   bool IsGood() { return m_good; }
   struct FileEntry
   {
@@ -53,6 +52,11 @@ private:
     u64 size;
   };
 
+  // Finds the file holding the data at the given disc offset. Returns the position within
+  // that file and how many bytes (up to roughly size) can be read from there in one go,
+  // which covers all following clusters that are stored contiguously.
+  FileEntry* FindClusters(u64 offset, u64 size, u64* file_offset, u64* available);
+
   std::vector<FileEntry> m_files;
 
   u64 m_size;
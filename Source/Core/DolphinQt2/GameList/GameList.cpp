@@ -23,6 +23,7 @@
 #include "Core/HW/WiiSaveCrypted.h"
 #include "Core/WiiUtils.h"
 #include "DiscIO/Blob.h"
+#include "DiscIO/DCXBlob.h"
 #include "DiscIO/Enums.h"
 
 #include "DolphinQt2/Config/PropertiesDialog.h"
@@ -173,7 +174,7 @@ void GameList::ShowContextMenu(const QPoint&)
     AddAction(menu, tr("Set as &default ISO"), this, &GameList::SetDefaultISO);
     const auto blob_type = game->GetBlobType();
 
-    if (blob_type == DiscIO::BlobType::GCZ)
+    if (blob_type == DiscIO::BlobType::GCZ || blob_type == DiscIO::BlobType::DCX)
       AddAction(menu, tr("Decompress ISO..."), this, &GameList::CompressISO);
     else if (blob_type == DiscIO::BlobType::PLAIN)
       AddAction(menu, tr("Compress ISO..."), this, &GameList::CompressISO);
@@ -276,7 +277,8 @@ void GameList::CompressISO()
   auto file = GetSelectedGame();
   const auto original_path = file->GetFilePath();
 
-  const bool compressed = (file->GetBlobType() == DiscIO::BlobType::GCZ);
+  const bool compressed = (file->GetBlobType() == DiscIO::BlobType::GCZ ||
+                           file->GetBlobType() == DiscIO::BlobType::DCX);
 
   if (!compressed && file->GetPlatform() == DiscIO::Platform::WiiDisc)
   {
@@ -311,7 +313,12 @@ void GameList::CompressISO()
 
   bool good;
 
-  if (compressed)
+  if (file->GetBlobType() == DiscIO::BlobType::DCX)
+  {
+    good = DiscIO::DecompressDCXToFile(original_path, dst_path.toStdString(), &CompressCB,
+                                       &progress_dialog);
+  }
+  else if (compressed)
   {
     good = DiscIO::DecompressBlobToFile(original_path, dst_path.toStdString(), &CompressCB,
                                         &progress_dialog);
@@ -39,6 +39,7 @@
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/Profiler.h"
+#include "Core/PowerPC/SamplingProfiler.h"
 #include "Core/PowerPC/SignatureDB/MEGASignatureDB.h"
 #include "Core/PowerPC/SignatureDB/SignatureDB.h"
 
@@ -127,6 +128,22 @@ void CCodeWindow::Save()
   ini.Save(File::GetUserPath(F_DEBUGGERCONFIG_IDX));
 }
 
+static void OpenTextFile(const std::string& filename)
+{
+  wxFileType* filetype = wxTheMimeTypesManager->GetFileTypeFromExtension("txt");
+  if (!filetype)
+  {
+    // From extension failed, trying with MIME type now
+    filetype = wxTheMimeTypesManager->GetFileTypeFromMimeType("text/plain");
+    if (!filetype)
+      // MIME type failed, aborting mission
+      return;
+  }
+  wxString OpenCommand = filetype->GetOpenCommand(StrToWxStr(filename));
+  if (!OpenCommand.IsEmpty())
+    wxExecute(OpenCommand, wxEXEC_SYNC);
+}
+
 void CCodeWindow::OnProfilerMenu(wxCommandEvent& event)
 {
   switch (event.GetId())
@@ -146,21 +163,25 @@ void CCodeWindow::OnProfilerMenu(wxCommandEvent& event)
       std::string filename = File::GetUserPath(D_DUMP_IDX) + "Debug/profiler.txt";
       File::CreateFullPath(filename);
       Profiler::WriteProfileResults(filename);
-
-      wxFileType* filetype = wxTheMimeTypesManager->GetFileTypeFromExtension("txt");
-      if (!filetype)
-      {
-        // From extension failed, trying with MIME type now
-        filetype = wxTheMimeTypesManager->GetFileTypeFromMimeType("text/plain");
-        if (!filetype)
-          // MIME type failed, aborting mission
-          break;
-      }
-      wxString OpenCommand = filetype->GetOpenCommand(StrToWxStr(filename));
-      if (!OpenCommand.IsEmpty())
-        wxExecute(OpenCommand, wxEXEC_SYNC);
+      OpenTextFile(filename);
     }
     break;
+  case IDM_SAMPLE_PROFILE:
+    if (SamplingProfiler::IsRunning())
+      SamplingProfiler::Stop();
+    else
+      SamplingProfiler::Start();
+    GetParentMenuBar()->Check(IDM_SAMPLE_PROFILE, SamplingProfiler::IsRunning());
+    break;
+  case IDM_WRITE_SAMPLE_PROFILE:
+  {
+    // Folded stacks, for flamegraph.pl
+    std::string filename = File::GetUserPath(D_DUMP_IDX) + "Debug/sampled_stacks.txt";
+    File::CreateFullPath(filename);
+    SamplingProfiler::WriteResults(filename);
+    OpenTextFile(filename);
+    break;
+  }
   }
 }
 
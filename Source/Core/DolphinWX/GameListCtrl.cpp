@@ -38,6 +38,7 @@
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
 #include "Common/StringUtil.h"
 #include "Common/SysConf.h"
 #include "Common/Thread.h"
@@ -51,6 +52,9 @@
 #include "Core/TitleDatabase.h"
 #include "Core/WiiUtils.h"
 #include "DiscIO/Blob.h"
+#include "DiscIO/DCXBlob.h"
+#include "DiscIO/DiscAudit.h"
+#include "DiscIO/DiscScrubber.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/Volume.h"
 #include "DolphinWX/Frame.h"
@@ -82,6 +86,15 @@ public:
 
 static bool sorted = false;
 
+// Returns the scrub bitmap written by "Audit ISO..." if there is one
+static std::string GetScrubBitmap(const UICommon::GameFile& iso)
+{
+  const std::string path = DiscIO::GetScrubBitmapPath(iso.GetFilePath());
+  if (iso.GetPlatform() != DiscIO::Platform::WiiDisc || !File::Exists(path))
+    return "";
+  return path;
+}
+
 static int CompareGameListItems(const UICommon::GameFile* iso1, const UICommon::GameFile* iso2,
   long sortData = GameListCtrl::COLUMN_TITLE)
 {
@@ -263,6 +276,8 @@ GameListCtrl::GameListCtrl(bool disable_scanning, wxWindow* parent, const wxWind
   Bind(wxEVT_MENU, &GameListCtrl::OnExportSave, this, IDM_EXPORT_SAVE);
   Bind(wxEVT_MENU, &GameListCtrl::OnSetDefaultISO, this, IDM_SET_DEFAULT_ISO);
   Bind(wxEVT_MENU, &GameListCtrl::OnCompressISO, this, IDM_COMPRESS_ISO);
+  Bind(wxEVT_MENU, &GameListCtrl::OnConvertToDCX, this, IDM_CONVERT_DCX);
+  Bind(wxEVT_MENU, &GameListCtrl::OnAuditISO, this, IDM_AUDIT_ISO);
   Bind(wxEVT_MENU, &GameListCtrl::OnMultiCompressISO, this, IDM_MULTI_COMPRESS_ISO);
   Bind(wxEVT_MENU, &GameListCtrl::OnMultiDecompressISO, this, IDM_MULTI_DECOMPRESS_ISO);
   Bind(wxEVT_MENU, &GameListCtrl::OnDeleteISO, this, IDM_DELETE_ISO);
@@ -982,11 +997,19 @@ void GameListCtrl::OnRightClick(wxMouseEvent& event)
 
       if (platform == DiscIO::Platform::GameCubeDisc || platform == DiscIO::Platform::WiiDisc)
       {
-        if (selected_iso->GetBlobType() == DiscIO::BlobType::GCZ)
+        const DiscIO::BlobType blob_type = selected_iso->GetBlobType();
+        if (blob_type == DiscIO::BlobType::GCZ || blob_type == DiscIO::BlobType::DCX)
           popupMenu.Append(IDM_COMPRESS_ISO, _("Decompress ISO..."));
-        else if (selected_iso->GetBlobType() == DiscIO::BlobType::PLAIN)
+        else if (blob_type == DiscIO::BlobType::PLAIN)
           popupMenu.Append(IDM_COMPRESS_ISO, _("Compress ISO..."));
 
+        if (blob_type != DiscIO::BlobType::DCX && blob_type != DiscIO::BlobType::DIRECTORY &&
+            blob_type != DiscIO::BlobType::DRIVE)
+          popupMenu.Append(IDM_CONVERT_DCX, _("Convert to DCX..."));
+
+        if (blob_type != DiscIO::BlobType::DIRECTORY && blob_type != DiscIO::BlobType::DRIVE)
+          popupMenu.Append(IDM_AUDIT_ISO, _("Audit ISO..."));
+
         wxMenuItem* changeDiscItem = popupMenu.Append(IDM_LIST_CHANGE_DISC, _("Change &Disc"));
         changeDiscItem->Enable(Core::IsRunning());
       }
@@ -1024,6 +1047,7 @@ void GameListCtrl::OnRightClick(wxMouseEvent& event)
     popupMenu.AppendSeparator();
     popupMenu.Append(IDM_MULTI_COMPRESS_ISO, _("Compress selected ISOs..."));
     popupMenu.Append(IDM_MULTI_DECOMPRESS_ISO, _("Decompress selected ISOs..."));
+    popupMenu.Append(IDM_AUDIT_ISO, _("Audit selected ISOs..."));
     PopupMenu(&popupMenu);
   }
 }
@@ -1203,7 +1227,8 @@ void GameListCtrl::CompressSelection(bool _compress)
       iso->GetPlatform() != DiscIO::Platform::WiiDisc)
       continue;
     if (iso->GetBlobType() != DiscIO::BlobType::PLAIN &&
-      iso->GetBlobType() != DiscIO::BlobType::GCZ)
+      iso->GetBlobType() != DiscIO::BlobType::GCZ &&
+      (iso->GetBlobType() != DiscIO::BlobType::DCX || _compress))
       continue;
 
     items_to_compress.push_back(iso);
@@ -1261,9 +1286,9 @@ void GameListCtrl::CompressSelection(bool _compress)
         all_good &=
           DiscIO::CompressFileToBlob(iso->GetFilePath(), OutputFileName,
           (iso->GetPlatform() == DiscIO::Platform::WiiDisc) ? 1 : 0,
-            16384, &MultiCompressCB, &progress);
+            16384, &MultiCompressCB, &progress, GetScrubBitmap(*iso));
       }
-      else if (iso->GetBlobType() == DiscIO::BlobType::GCZ && !_compress)
+      else if (iso->GetBlobType() != DiscIO::BlobType::PLAIN && !_compress)
       {
         std::string FileName;
         SplitPath(iso->GetFilePath(), nullptr, &FileName, nullptr);
@@ -1283,8 +1308,12 @@ void GameListCtrl::CompressSelection(bool _compress)
             _("Confirm File Overwrite"), wxYES_NO) == wxNO)
           continue;
 
-        all_good &= DiscIO::DecompressBlobToFile(iso->GetFilePath().c_str(), OutputFileName.c_str(),
-          &MultiCompressCB, &progress);
+        if (iso->GetBlobType() == DiscIO::BlobType::DCX)
+          all_good &= DiscIO::DecompressDCXToFile(iso->GetFilePath(), OutputFileName,
+            &MultiCompressCB, &progress);
+        else
+          all_good &= DiscIO::DecompressBlobToFile(iso->GetFilePath().c_str(), OutputFileName.c_str(),
+            &MultiCompressCB, &progress);
       }
 
       progress.items_done++;
@@ -1308,7 +1337,8 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
   if (!iso)
     return;
 
-  bool is_compressed = iso->GetBlobType() == DiscIO::BlobType::GCZ;
+  bool is_compressed = iso->GetBlobType() == DiscIO::BlobType::GCZ ||
+    iso->GetBlobType() == DiscIO::BlobType::DCX;
   wxString path;
 
   std::string FileName, FilePath, FileExtension;
@@ -1355,13 +1385,59 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
       wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME |
       wxPD_ESTIMATED_TIME | wxPD_REMAINING_TIME | wxPD_SMOOTH);
 
-    if (is_compressed)
+    if (iso->GetBlobType() == DiscIO::BlobType::DCX)
+      all_good =
+      DiscIO::DecompressDCXToFile(iso->GetFilePath(), WxStrToStr(path), &CompressCB, &dialog);
+    else if (is_compressed)
       all_good =
       DiscIO::DecompressBlobToFile(iso->GetFilePath(), WxStrToStr(path), &CompressCB, &dialog);
     else
       all_good = DiscIO::CompressFileToBlob(
         iso->GetFilePath(), WxStrToStr(path),
-        (iso->GetPlatform() == DiscIO::Platform::WiiDisc) ? 1 : 0, 16384, &CompressCB, &dialog);
+        (iso->GetPlatform() == DiscIO::Platform::WiiDisc) ? 1 : 0, 16384, &CompressCB, &dialog,
+        GetScrubBitmap(*iso));
+  }
+
+  if (!all_good)
+    WxUtils::ShowErrorDialog(_("Dolphin was unable to complete the requested action."));
+
+  m_scan_trigger.Set();
+}
+
+void GameListCtrl::OnConvertToDCX(wxCommandEvent& WXUNUSED(event))
+{
+  const UICommon::GameFile* iso = GetSelectedISO();
+  if (!iso)
+    return;
+
+  std::string FileName, FilePath, FileExtension;
+  SplitPath(iso->GetFilePath(), &FilePath, &FileName, &FileExtension);
+
+  wxString path;
+  do
+  {
+    path = wxFileSelector(_("Save DCX image"), StrToWxStr(FilePath),
+      StrToWxStr(FileName) + ".dcx", wxEmptyString,
+      _("All DCX GC/Wii images (dcx)") +
+      wxString::Format("|*.dcx|%s", wxGetTranslation(wxALL_FILES)),
+      wxFD_SAVE, this);
+    if (!path)
+      return;
+  } while (
+    wxFileExists(path) &&
+    wxMessageBox(wxString::Format(_("The file %s already exists.\nDo you wish to replace it?"),
+      path.c_str()),
+      _("Confirm File Overwrite"), wxYES_NO) == wxNO);
+
+  bool all_good = false;
+
+  {
+    wxProgressDialog dialog(_("Compressing ISO"), _("Working..."), 1000, this,
+      wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME |
+      wxPD_ESTIMATED_TIME | wxPD_REMAINING_TIME | wxPD_SMOOTH);
+
+    all_good = DiscIO::ConvertToDCX(iso->GetFilePath(), WxStrToStr(path),
+      DiscIO::DCXCompression::Zlib, 9, DiscIO::DCX_DEFAULT_CHUNK_SIZE, &CompressCB, &dialog);
   }
 
   if (!all_good)
@@ -1370,6 +1446,85 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
   m_scan_trigger.Set();
 }
 
+void GameListCtrl::OnAuditISO(wxCommandEvent& WXUNUSED(event))
+{
+  std::vector<const UICommon::GameFile*> items_to_audit;
+  for (const UICommon::GameFile* iso : GetAllSelectedISOs())
+  {
+    if (iso->GetPlatform() != DiscIO::Platform::GameCubeDisc &&
+      iso->GetPlatform() != DiscIO::Platform::WiiDisc)
+      continue;
+    if (iso->GetBlobType() == DiscIO::BlobType::DIRECTORY ||
+      iso->GetBlobType() == DiscIO::BlobType::DRIVE)
+      continue;
+
+    items_to_audit.push_back(iso);
+  }
+
+  if (items_to_audit.empty())
+    return;
+
+  bool all_good = true;
+  size_t discs_with_errors = 0;
+
+  {
+    wxProgressDialog progressDialog(
+      _("Auditing ISO"), _("Working..."),
+      1000,  // Arbitrary number that's larger than the dialog's width in pixels
+      this, wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_ESTIMATED_TIME |
+      wxPD_REMAINING_TIME | wxPD_SMOOTH);
+
+    CompressionProgress progress(0, items_to_audit.size(), "", &progressDialog);
+
+    for (const UICommon::GameFile* iso : items_to_audit)
+    {
+      SplitPath(iso->GetFilePath(), nullptr, &progress.current_filename, nullptr);
+
+      // The scrub bitmap is kept next to the image so that compressing it later can use it
+      DiscIO::DiscAuditResult result;
+      if (!DiscIO::AuditDisc(iso->GetFilePath(), &result,
+        DiscIO::GetScrubBitmapPath(iso->GetFilePath()), &MultiCompressCB, &progress))
+      {
+        all_good = false;
+        break;
+      }
+
+      bool has_errors = false;
+      for (const DiscIO::PartitionAuditResult& partition : result.partitions)
+      {
+        has_errors |= partition.errors_in_used_clusters != 0 || partition.h3_errors != 0 ||
+          !partition.h3_table_valid;
+        NOTICE_LOG(DISCIO, "%s: partition 0x%" PRIx64 ": %" PRIu64 " clusters, %" PRIu64
+          " bad (%" PRIu64 " in use), %" PRIu64 " bad groups, H3 table %s",
+          iso->GetFilePath().c_str(), partition.partition_offset, partition.num_clusters,
+          partition.h0_errors + partition.h1_errors + partition.h2_errors,
+          partition.errors_in_used_clusters, partition.h3_errors,
+          partition.h3_table_valid ? "valid" : "invalid");
+      }
+
+      std::string md5;
+      for (u8 n : result.md5)
+        md5 += StringFromFormat("%02x", n);
+      NOTICE_LOG(DISCIO, "%s: CRC32 %08x, MD5 %s%s", iso->GetFilePath().c_str(), result.crc32,
+        md5.c_str(), has_errors ? ", HAS ERRORS" : "");
+
+      discs_with_errors += has_errors;
+      progress.items_done++;
+    }
+  }
+
+  if (!all_good)
+  {
+    WxUtils::ShowErrorDialog(_("Dolphin was unable to complete the requested action."));
+    return;
+  }
+
+  wxMessageBox(wxString::Format(_("Audited %zu disc images. %zu of them have errors.\n"
+    "The hashes of each image are listed in the log."),
+    items_to_audit.size(), discs_with_errors),
+    _("Audit Complete"), wxOK | wxICON_INFORMATION, this);
+}
+
 void GameListCtrl::OnChangeDisc(wxCommandEvent& WXUNUSED(event))
 {
   const UICommon::GameFile* iso = GetSelectedISO();
@@ -106,6 +106,8 @@ private:
   void OnSetDefaultISO(wxCommandEvent& event);
   void OnDeleteISO(wxCommandEvent& event);
   void OnCompressISO(wxCommandEvent& event);
+  void OnConvertToDCX(wxCommandEvent& event);
+  void OnAuditISO(wxCommandEvent& event);
   void OnMultiCompressISO(wxCommandEvent& event);
   void OnMultiDecompressISO(wxCommandEvent& event);
   void OnChangeDisc(wxCommandEvent& event);
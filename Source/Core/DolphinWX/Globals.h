@@ -256,6 +256,8 @@ enum
   // Profiler
   IDM_PROFILE_BLOCKS,
   IDM_WRITE_PROFILE,
+  IDM_SAMPLE_PROFILE,
+  IDM_WRITE_SAMPLE_PROFILE,
   // --------------------------------------------------------------
 
   // --------------------------------------------------------------
@@ -298,6 +300,8 @@ enum
   IDM_SET_DEFAULT_ISO,
   IDM_DELETE_ISO,
   IDM_COMPRESS_ISO,
+  IDM_CONVERT_DCX,
+  IDM_AUDIT_ISO,
   IDM_START_NETPLAY,
   IDM_MULTI_COMPRESS_ISO,
   IDM_MULTI_DECOMPRESS_ISO,
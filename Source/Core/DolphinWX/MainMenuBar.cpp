@@ -515,6 +515,11 @@ wxMenu* MainMenuBar::CreateProfilerMenu() const
   profiler_menu->AppendCheckItem(IDM_PROFILE_BLOCKS, _("&Profile Blocks"));
   profiler_menu->AppendSeparator();
   profiler_menu->Append(IDM_WRITE_PROFILE, _("&Write to profile.txt, Show"));
+  profiler_menu->AppendSeparator();
+  // i18n: "Sample" is used as a verb. The sampling profiler records which game functions
+  // are running at regular intervals.
+  profiler_menu->AppendCheckItem(IDM_SAMPLE_PROFILE, _("&Sample Game Functions"));
+  profiler_menu->Append(IDM_WRITE_SAMPLE_PROFILE, _("Write Sampled &Stacks, Show"));
 
   return profiler_menu;
 }
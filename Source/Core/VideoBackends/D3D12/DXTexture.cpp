@@ -167,7 +167,7 @@ bool DXTexture::Save(const std::string& filename, u32 level)
   }
   else
   {
-    saved = TextureToPng(
+    saved = ImageWriter::QueuePng(
       static_cast<u8*>(readback_texture_map),
       dst_location.PlacedFootprint.Footprint.RowPitch,
       filename,
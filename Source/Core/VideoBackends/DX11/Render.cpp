@@ -1059,7 +1059,6 @@ void  Renderer::DumpFrame(const EFBRectangle& source_rc, u32 xfb_addr,
   AVIDump::Frame state = AVIDump::FetchState(ticks);
   DumpFrameData(reinterpret_cast<const u8*>(map.pData), box_width, box_height,
     map.RowPitch, state);
-  FinishFrameData();
   D3D::context->Unmap(m_frame_dump_staging_texture.get(), 0);
 }
 
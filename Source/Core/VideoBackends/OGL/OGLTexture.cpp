@@ -246,7 +246,7 @@ bool OGLTexture::Save(const std::string& filename, u32 level)
   else
   {
     glGetTexImage(GL_TEXTURE_2D_ARRAY, level, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
-    saved = TextureToPng(data.data(), width * 4, filename, width, height);
+    saved = ImageWriter::QueuePng(data.data(), width * 4, filename, width, height);
   }
   OGLTexture::SetStage();
   return saved;
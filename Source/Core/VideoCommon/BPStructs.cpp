@@ -22,6 +22,7 @@
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/PerfQueryBase.h"
 #include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
@@ -48,10 +49,24 @@ static const float s_gammaLUT[] =
     1.0f
 };
 
+// The registers GetPixelShaderUID reads
+static bool IsPixelShaderUIDRegister(u32 address)
+{
+  return address == BPMEM_GENMODE ||
+         (address >= BPMEM_IND_CMD && address < BPMEM_IND_CMD + 16) ||
+         (address >= BPMEM_IREF && address < BPMEM_TREF + 8) || address == BPMEM_ZMODE ||
+         address == BPMEM_BLENDMODE || address == BPMEM_ZCOMPARE ||
+         (address >= BPMEM_TEV_COLOR_ENV && address < BPMEM_TEV_COLOR_ENV + 2 * 16) ||
+         address == BPMEM_FOGRANGE || address == BPMEM_FOGPARAM3 ||
+         address == BPMEM_ALPHACOMPARE ||
+         (address >= BPMEM_ZTEX2 && address < BPMEM_TEV_KSEL + 8);
+}
+
 void BPInit()
 {
   memset(&bpmem, 0, sizeof(bpmem));
   bpmem.bpMask = 0xFFFFFF;
+  InvalidatePixelShaderUID();
 
   mapTexAddress = 0;
   numWrites = 0;
@@ -120,6 +135,8 @@ void BPWritten(const BPCmd& bp)
   FlushPipeline();
 
   ((u32*)&bpmem)[bp.address] = bp.newvalue;
+  if (IsPixelShaderUIDRegister(bp.address))
+    InvalidatePixelShaderUID();
 
   switch (bp.address)
   {
@@ -2,14 +2,24 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <condition_variable>
+#include <cstring>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "png.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/TaskScheduler.h"
 #include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/VideoConfig.h"
 
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -35,7 +45,7 @@ data      : This is an array of RGBA with 8 bits per channel. 4 bytes for each p
 row_stride: Determines the amount of bytes per row of pixels.
 */
 bool TextureToPng(const u8* data, int row_stride, const std::string& filename, int width,
-  int height, bool saveAlpha, bool frombgra)
+  int height, bool saveAlpha, bool frombgra, int compression_level)
 {
   bool success = false;
 
@@ -84,6 +94,8 @@ bool TextureToPng(const u8* data, int row_stride, const std::string& filename, i
   }
 
   png_init_io(png_ptr, fp.GetHandle());
+  if (compression_level >= 0)
+    png_set_compression_level(png_ptr, compression_level);
 
   // Write header (8 bit color depth)
   png_set_IHDR(png_ptr, info_ptr, width, height, 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
@@ -136,3 +148,91 @@ finalise:
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
+
+namespace ImageWriter
+{
+// Queued images may hold this much memory before QueuePng waits for them
+static constexpr size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+static std::mutex s_lock;
+static std::condition_variable s_image_written;
+static std::unordered_set<std::string> s_reserved_filenames;
+static size_t s_queued_bytes = 0;
+static u32 s_queued_images = 0;
+// Whether QueuePng waited since the queue was last empty
+static bool s_stalled = false;
+
+bool Reserve(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lk(s_lock);
+  return s_reserved_filenames.insert(filename).second;
+}
+
+void Release(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lk(s_lock);
+  s_reserved_filenames.erase(filename);
+}
+
+bool QueuePng(const u8* data, int row_stride, const std::string& filename, int width, int height,
+              bool saveAlpha, bool frombgra)
+{
+  if (!data)
+    return false;
+
+  const size_t row_size = static_cast<size_t>(width) * 4;
+  const size_t size = row_size * height;
+  {
+    std::unique_lock<std::mutex> lk(s_lock);
+    // Entering a new area can dump hundreds of textures at once, faster than they compress
+    if (s_queued_images > 0 && s_queued_bytes + size > MAX_QUEUED_BYTES)
+    {
+      if (!s_stalled)
+        WARN_LOG(VIDEO, "Waiting for %u dumped images to be written", s_queued_images);
+      s_stalled = true;
+      s_image_written.wait(lk, [size] {
+        return s_queued_images == 0 || s_queued_bytes + size <= MAX_QUEUED_BYTES;
+      });
+    }
+    s_queued_bytes += size;
+    s_queued_images++;
+  }
+
+  // The source is usually a mapped readback buffer, which is released as soon as we return
+  auto pixels = std::make_shared<std::vector<u8>>(size);
+  for (int y = 0; y < height; ++y)
+    std::memcpy(pixels->data() + y * row_size, data + y * row_stride, row_size);
+
+  const int compression_level = MathUtil::Clamp(g_ActiveConfig.iDumpPNGCompressionLevel, 0, 9);
+  Common::TaskScheduler::Submit(
+      [pixels, filename, width, height, saveAlpha, frombgra, compression_level, size] {
+        if (!TextureToPng(pixels->data(), width * 4, filename, width, height, saveAlpha,
+                          frombgra, compression_level))
+        {
+          Release(filename);
+        }
+        {
+          std::lock_guard<std::mutex> lk(s_lock);
+          s_queued_bytes -= size;
+          s_queued_images--;
+          s_stalled &= s_queued_images != 0;
+        }
+        s_image_written.notify_all();
+      },
+      Common::TaskPriority::Background);
+  return true;
+}
+
+void Flush()
+{
+  std::unique_lock<std::mutex> lk(s_lock);
+  s_image_written.wait(lk, [] { return s_queued_images == 0; });
+}
+
+void Shutdown()
+{
+  Flush();
+  std::lock_guard<std::mutex> lk(s_lock);
+  s_reserved_filenames.clear();
+}
+}  // namespace ImageWriter
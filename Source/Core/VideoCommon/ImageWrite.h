@@ -9,6 +9,29 @@
 #include "VideoCommon/ImageLoader.h"
 
 bool SaveData(const std::string& filename, const std::string& data);
+// compression_level is the zlib level, or -1 for zlib's default
 bool TextureToPng(const u8* data, int row_stride, const std::string& filename, int width,
-  int height, bool saveAlpha = false, bool frombgra = false);
+  int height, bool saveAlpha = false, bool frombgra = false, int compression_level = -1);
 bool TextureToDDS(const u8* data, int row_stride, const std::string& filename, int width, int height, DDSCompression format = DDSCompression::DDSC_DXT3);
+
+// Writes texture and EFB dumps on the task scheduler's workers, so that compressing them doesn't
+// hold up the GPU thread.
+namespace ImageWriter
+{
+// Returns false if an image was already queued for filename since the last Shutdown. Dumps ask
+// before reading the texture back, so that the same texture is only dumped once.
+bool Reserve(const std::string& filename);
+// Forgets a reservation, for a dump that failed and should be tried again
+void Release(const std::string& filename);
+
+// Copies the image and queues it to be written as a PNG, at the configured compression level.
+// Waits for earlier images to be written when too many are queued.
+bool QueuePng(const u8* data, int row_stride, const std::string& filename, int width, int height,
+              bool saveAlpha = false, bool frombgra = false);
+
+// Returns once every queued image has been written
+void Flush();
+
+// Flushes, and forgets which images were written
+void Shutdown();
+}  // namespace ImageWriter
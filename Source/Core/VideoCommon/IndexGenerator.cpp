@@ -5,6 +5,7 @@
 #include <cstddef>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OpcodeDecoding.h"
@@ -17,8 +18,109 @@ u32 IndexGenerator::base_index;
 
 static void(*primitive_table[8])(u32);
 
+// The triangle primitives are written in groups of 16 triangles. Each group is the previous one
+// plus a per-index step, so writing a group only takes a few vector adds and stores. The scalar
+// loops below write whatever doesn't fill a whole group.
+static constexpr u32 GROUP_TRIANGLES = 16;
+static constexpr u32 GROUP_INDICES = GROUP_TRIANGLES * 3;
+
+struct alignas(16) IndexPattern
+{
+  // The indices of the first group, relative to the first vertex
+  u16 offsets[GROUP_INDICES];
+  u16 steps[GROUP_INDICES];
+};
+
+static IndexPattern s_list_pattern;
+static IndexPattern s_strip_pattern;
+static IndexPattern s_fan_pattern;
+static IndexPattern s_quads_pattern;
+
+static void SetTriangle(IndexPattern* pattern, u32 triangle, u32 index1, u32 index2, u32 index3,
+                        u32 step1, u32 step2, u32 step3)
+{
+  pattern->offsets[triangle * 3 + 0] = index1;
+  pattern->offsets[triangle * 3 + 1] = index2;
+  pattern->offsets[triangle * 3 + 2] = index3;
+  pattern->steps[triangle * 3 + 0] = step1;
+  pattern->steps[triangle * 3 + 1] = step2;
+  pattern->steps[triangle * 3 + 2] = step3;
+}
+
+// The same triangles as the scalar loops
+static void InitPatterns()
+{
+  for (u32 t = 0; t < GROUP_TRIANGLES; t++)
+  {
+    const u32 list_step = GROUP_TRIANGLES * 3;
+    SetTriangle(&s_list_pattern, t, t * 3, t * 3 + 1, t * 3 + 2, list_step, list_step, list_step);
+
+    // Every other triangle of a strip is wound the other way
+    const u32 wind = t & 1;
+    SetTriangle(&s_strip_pattern, t, t, t + 1 + wind, t + 2 - wind, GROUP_TRIANGLES,
+                GROUP_TRIANGLES, GROUP_TRIANGLES);
+
+    // All triangles of a fan share the first vertex
+    SetTriangle(&s_fan_pattern, t, 0, t + 1, t + 2, 0, GROUP_TRIANGLES, GROUP_TRIANGLES);
+
+    // Each quad is split into two triangles
+    const u32 quad = (t / 2) * 4;
+    const u32 second = t & 1;
+    const u32 quads_step = GROUP_TRIANGLES * 2;
+    SetTriangle(&s_quads_pattern, t, quad, quad + 1 + second, quad + 2 + second, quads_step,
+                quads_step, quads_step);
+  }
+}
+
+#ifdef _M_X86
+static u16* WriteGroups(u16* ptr, u32 first, u32 count, const IndexPattern& pattern)
+{
+  constexpr u32 VECTORS = GROUP_INDICES / 8;
+  const __m128i base = _mm_set1_epi16(static_cast<s16>(first));
+  __m128i indices[VECTORS];
+  __m128i steps[VECTORS];
+  for (u32 i = 0; i < VECTORS; i++)
+  {
+    indices[i] = _mm_add_epi16(
+        base, _mm_load_si128(reinterpret_cast<const __m128i*>(pattern.offsets + i * 8)));
+    steps[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern.steps + i * 8));
+  }
+
+  for (u32 group = 0; group < count; group++)
+  {
+    for (u32 i = 0; i < VECTORS; i++)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr + i * 8), indices[i]);
+      indices[i] = _mm_add_epi16(indices[i], steps[i]);
+    }
+    ptr += GROUP_INDICES;
+  }
+  return ptr;
+}
+#else
+static u16* WriteGroups(u16* ptr, u32 first, u32 count, const IndexPattern& pattern)
+{
+  u16 indices[GROUP_INDICES];
+  for (u32 i = 0; i < GROUP_INDICES; i++)
+    indices[i] = first + pattern.offsets[i];
+
+  for (u32 group = 0; group < count; group++)
+  {
+    for (u32 i = 0; i < GROUP_INDICES; i++)
+    {
+      ptr[i] = indices[i];
+      indices[i] += pattern.steps[i];
+    }
+    ptr += GROUP_INDICES;
+  }
+  return ptr;
+}
+#endif
+
 void IndexGenerator::Init()
 {
+  InitPatterns();
+
   primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = IndexGenerator::AddQuads;
 #if defined(_DEBUG) || defined(DEBUGFAST)
   primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = IndexGenerator::AddQuads_nonstandard;
@@ -46,6 +148,17 @@ void IndexGenerator::AddIndices(int primitive, u32 numVerts)
   base_index += numVerts;
 }
 
+void IndexGenerator::AddRemappedIndices(int primitive, u32 numVerts, const u16* remap,
+                                        u32 numLoaded)
+{
+  u16* const first = index_buffer_current;
+  const u32 base = base_index;
+  primitive_table[primitive](numVerts);
+  for (u16* ptr = first; ptr != index_buffer_current; ++ptr)
+    *ptr = static_cast<u16>(base + remap[*ptr - base]);
+  base_index = base + numLoaded;
+}
+
 // Triangles
 __forceinline u16* IndexGenerator::WriteTriangle(u16* ptr, u32 index1, u32 index2, u32 index3)
 {
@@ -60,6 +173,9 @@ void IndexGenerator::AddList(u32 const numVerts)
   u32 i = base_index + 2;
   u32 top = (base_index + numVerts);
   u16* ptr = index_buffer_current;
+  const u32 groups = numVerts / (GROUP_TRIANGLES * 3);
+  ptr = WriteGroups(ptr, base_index, groups, s_list_pattern);
+  i += groups * GROUP_TRIANGLES * 3;
   while (i < top)
   {
     ptr = WriteTriangle(ptr, i - 2, i - 1, i);
@@ -75,6 +191,11 @@ void IndexGenerator::AddStrip(u32 const numVerts)
   u32 a = base_index;
   u32 i = a + 2;
   u32 wind = 1;
+  // A group has an even number of triangles, so the winding of the rest is unchanged
+  const u32 groups = numVerts > 2 ? (numVerts - 2) / GROUP_TRIANGLES : 0;
+  ptr = WriteGroups(ptr, a, groups, s_strip_pattern);
+  a += groups * GROUP_TRIANGLES;
+  i += groups * GROUP_TRIANGLES;
   while (i < top)
   {
     u32 b = i - wind;
@@ -115,6 +236,9 @@ void IndexGenerator::AddFan(u32 numVerts)
   u32 i = base_index + 2;
   u32 top = (base_index + numVerts);
   u16* ptr = index_buffer_current;
+  const u32 groups = numVerts > 2 ? (numVerts - 2) / GROUP_TRIANGLES : 0;
+  ptr = WriteGroups(ptr, base_index, groups, s_fan_pattern);
+  i += groups * GROUP_TRIANGLES;
 
   while (i < top)
   {
@@ -146,6 +270,9 @@ void IndexGenerator::AddQuads(u32 numVerts)
   u32 i = base_index + 3;
   u32 top = (base_index + numVerts);
   u16* ptr = index_buffer_current;
+  const u32 groups = numVerts / (GROUP_TRIANGLES * 2);
+  ptr = WriteGroups(ptr, base_index, groups, s_quads_pattern);
+  i += groups * GROUP_TRIANGLES * 2;
   while (i < top)
   {
     ptr = WriteTriangle(ptr, i - 3, i - 2, i - 1);
@@ -13,6 +13,9 @@ public:
   static void Start(u16 *Indexptr);
 
   static void AddIndices(int primitive, u32 numVertices);
+  // For vertices that were deduplicated before loading: vertex i of the primitive is the loaded
+  // vertex remap[i], and numLoaded vertices were loaded in all
+  static void AddRemappedIndices(int primitive, u32 numVertices, const u16* remap, u32 numLoaded);
 
   // returns numprimitives
   static inline u32 GetNumVerts()
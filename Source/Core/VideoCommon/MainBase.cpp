@@ -17,6 +17,7 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/GeometryShaderManager.h"
+#include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/TessellationShaderManager.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OnScreenDisplay.h"
@@ -238,6 +239,7 @@ void VideoBackendBase::ShutdownShared()
   Fifo::Shutdown();
   GeometryShaderManager::Shutdown();
   TessellationShaderManager::Shutdown();
+  ImageWriter::Shutdown();
 }
 
 void VideoBackendBase::CleanupShared()
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <array>
 #include <assert.h>
 #include <cmath>
 #include <cstring>
@@ -436,8 +437,22 @@ float snoise(float2 v)
 // leak
 //        into this UID; This is really unhelpful if these UIDs ever move from one machine to
 //        another.
-void GetPixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode, u32 components,
-                       const XFMemory& xfr, const BPMemory& bpm)
+namespace
+{
+// The last UID computed from bpmem and xfmem for each render mode. Apart from the registers,
+// it depends on the components and BoundingBox::active, which are compared instead.
+struct CachedPixelShaderUid
+{
+  PixelShaderUid uid;
+  u32 components;
+  bool bounding_box_active;
+  bool valid;
+};
+std::array<CachedPixelShaderUid, PSRM_DEPTH_ONLY + 1> s_cached_uids = {};
+}  // Anonymous namespace
+
+static void ComputePixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode,
+                                  u32 components, const XFMemory& xfr, const BPMemory& bpm)
 {
   out.ClearUID();
   pixel_shader_uid_data& uid_data = out.GetUidData<pixel_shader_uid_data>();
@@ -630,6 +645,34 @@ void GetPixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode
   out.CalculateUIDHash();
 }
 
+void GetPixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode, u32 components,
+                       const XFMemory& xfr, const BPMemory& bpm)
+{
+  // The shader cache precompiles from its own copies of the registers, which aren't tracked
+  if (&xfr != &xfmem || &bpm != &bpmem)
+  {
+    ComputePixelShaderUID(out, render_mode, components, xfr, bpm);
+    return;
+  }
+
+  CachedPixelShaderUid& cached = s_cached_uids[render_mode];
+  if (!cached.valid || cached.components != components ||
+      cached.bounding_box_active != BoundingBox::active)
+  {
+    ComputePixelShaderUID(cached.uid, render_mode, components, xfr, bpm);
+    cached.components = components;
+    cached.bounding_box_active = BoundingBox::active;
+    cached.valid = true;
+  }
+  out = cached.uid;
+}
+
+void InvalidatePixelShaderUID()
+{
+  for (CachedPixelShaderUid& cached : s_cached_uids)
+    cached.valid = false;
+}
+
 void SampleTexture(ShaderCode& out, API_TYPE ApiType, const char* texcoords, const char* texswap,
                    int texmap, bool stereo)
 {
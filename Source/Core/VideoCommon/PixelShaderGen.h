@@ -238,4 +238,7 @@ struct pixel_shader_uid_data
 typedef ShaderUid<pixel_shader_uid_data> PixelShaderUid;
 
 void GetPixelShaderUID(PixelShaderUid& object, PIXEL_SHADER_RENDER_MODE render_mode, u32 components, const XFMemory &xfr, const BPMemory &bpm);
+// The UID for bpmem and xfmem is kept between calls and only recomputed after the registers it
+// is made from have been written. BPStructs and XFStructs report those writes here.
+void InvalidatePixelShaderUID();
 void GeneratePixelShaderCode(ShaderCode& object, const pixel_shader_uid_data& uid_data, const ShaderHostConfig& hostconfig);
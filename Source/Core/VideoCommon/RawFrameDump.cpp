@@ -0,0 +1,149 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/RawFrameDump.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <lzo/lzo1x.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
+
+// The frames go out in large sequential writes, rather than a write per header and frame
+static constexpr size_t WRITE_BUFFER_SIZE = 16 * 1024 * 1024;
+
+static size_t GetMaxCompressedSize(size_t size)
+{
+  // From the LZO FAQ
+  return size + size / 16 + 64 + 3;
+}
+
+bool RawFrameDump::Start(const std::string& filename, bool compress)
+{
+  if (compress && lzo_init() != LZO_E_OK)
+  {
+    ERROR_LOG(VIDEO, "lzo_init() failed, dumping uncompressed frames");
+    compress = false;
+  }
+
+  File::CreateFullPath(filename);
+  if (!m_file.Open(filename, "wb"))
+  {
+    PanicAlert("Failed to open %s", filename.c_str());
+    return false;
+  }
+  std::setvbuf(m_file.GetHandle(), nullptr, _IOFBF, WRITE_BUFFER_SIZE);
+
+  const FileHeader header = {FILE_MAGIC, VERSION};
+  if (!m_file.WriteArray(&header, 1))
+  {
+    PanicAlert("Failed to write to %s", filename.c_str());
+    m_file.Close();
+    return false;
+  }
+
+  m_compress = compress;
+  m_frames_since_keyframe = 0;
+  m_raw_bytes = 0;
+  m_written_bytes = sizeof(header);
+  m_previous_frame.clear();
+  if (m_compress)
+    m_work_memory.resize(LZO1X_1_MEM_COMPRESS);
+  return true;
+}
+
+void RawFrameDump::AddFrame(const u8* data, int width, int height, bool bgra,
+                            const AVIDump::Frame& state)
+{
+  if (!m_file.IsOpen())
+    return;
+
+  const size_t size = static_cast<size_t>(width) * height * 4;
+  FrameHeader header = {};
+  header.magic = FRAME_MAGIC;
+  header.encoding = Encoding::Raw;
+  header.size = static_cast<u32>(size);
+  header.width = width;
+  header.height = height;
+  header.ticks_per_second = state.ticks_per_second;
+  header.ticks = state.ticks;
+  header.savestate_index = state.savestate_index;
+  header.first_frame = state.first_frame;
+  header.format = bgra ? PixelFormat::BGRA8 : PixelFormat::RGBA8;
+
+  if (!m_compress)
+  {
+    WriteFrame(header, data);
+    return;
+  }
+
+  const u8* source = data;
+  header.encoding = Encoding::Compressed;
+  if (m_previous_frame.size() == size && m_frames_since_keyframe + 1 < KEYFRAME_INTERVAL)
+  {
+    m_delta.resize(size);
+    for (size_t i = 0; i < size; i++)
+      m_delta[i] = data[i] - m_previous_frame[i];
+    source = m_delta.data();
+    header.encoding = Encoding::CompressedDelta;
+    m_frames_since_keyframe++;
+  }
+  else
+  {
+    m_frames_since_keyframe = 0;
+  }
+  m_previous_frame.assign(data, data + size);
+
+  m_compressed.resize(GetMaxCompressedSize(size));
+  lzo_uint compressed_size = 0;
+  if (lzo1x_1_compress(source, size, m_compressed.data(), &compressed_size,
+                       m_work_memory.data()) != LZO_E_OK)
+  {
+    // Not fatal, the frame is stored as it is and the next one becomes a keyframe
+    ERROR_LOG(VIDEO, "Failed to compress a dumped frame");
+    header.encoding = Encoding::Raw;
+    m_previous_frame.clear();
+    WriteFrame(header, data);
+    return;
+  }
+
+  header.size = static_cast<u32>(compressed_size);
+  WriteFrame(header, m_compressed.data());
+}
+
+bool RawFrameDump::WriteFrame(const FrameHeader& header, const u8* data)
+{
+  m_raw_bytes += static_cast<u64>(header.width) * header.height * 4;
+  m_written_bytes += sizeof(header) + header.size;
+  if (m_file.WriteArray(&header, 1) && m_file.WriteBytes(data, header.size))
+    return true;
+
+  ERROR_LOG(VIDEO, "Failed to write a dumped frame, stopping the raw frame dump");
+  m_file.Close();
+  return false;
+}
+
+void RawFrameDump::Stop()
+{
+  if (!m_file.IsOpen())
+    return;
+
+  m_file.Close();
+  if (m_compress && m_raw_bytes)
+  {
+    INFO_LOG(VIDEO, "Raw frame dump: %" PRIu64 " MiB of frames written as %" PRIu64 " MiB",
+             m_raw_bytes >> 20, m_written_bytes >> 20);
+  }
+
+  m_previous_frame.clear();
+  m_previous_frame.shrink_to_fit();
+  m_delta.clear();
+  m_delta.shrink_to_fit();
+  m_compressed.clear();
+  m_compressed.shrink_to_fit();
+}
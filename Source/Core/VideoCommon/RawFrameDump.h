@@ -0,0 +1,92 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "VideoCommon/AVIDump.h"
+
+// Writes the dumped frames as they are into a simple container, so that they can be captured at
+// full speed and encoded later, possibly on another machine. Unlike AVIDump, nothing is scaled
+// or encoded, at most compressed with LZO, which is fast enough for internal resolutions above
+// 1080p.
+//
+// The file starts with a FileHeader, followed by each frame as a FrameHeader and its data. All
+// values are little endian. The frames are RGBA8 or BGRA8, as FrameHeader::format says, top-down,
+// with a stride of width * 4 bytes.
+// Frames that aren't keyframes are stored as the bytewise difference to the previous frame,
+// modulo 256, which is mostly zeros for game footage and compresses to almost nothing.
+class RawFrameDump
+{
+public:
+  enum class Encoding : u32
+  {
+    // The frame as it is
+    Raw = 0,
+    // LZO1X-compressed frame
+    Compressed = 1,
+    // LZO1X-compressed difference to the previous frame, which has the same size
+    CompressedDelta = 2,
+  };
+
+  // Frames are stored in the order the backend reads them back in, without swizzling
+  enum class PixelFormat : u32
+  {
+    RGBA8 = 0,
+    BGRA8 = 1,
+  };
+
+  static constexpr u32 FILE_MAGIC = 0x44465244;   // "DRFD"
+  static constexpr u32 FRAME_MAGIC = 0x4D415246;  // "FRAM"
+  static constexpr u32 VERSION = 2;
+
+  struct FileHeader
+  {
+    u32 magic;
+    u32 version;
+  };
+
+  struct FrameHeader
+  {
+    u32 magic;
+    Encoding encoding;
+    // Bytes of data following the header
+    u32 size;
+    u32 width;
+    u32 height;
+    u32 ticks_per_second;
+    // Emulated time of the frame, see AVIDump::Frame
+    u64 ticks;
+    s32 savestate_index;
+    u32 first_frame;
+    PixelFormat format;
+    u32 reserved;
+  };
+
+  bool Start(const std::string& filename, bool compress);
+  void AddFrame(const u8* data, int width, int height, bool bgra, const AVIDump::Frame& state);
+  void Stop();
+
+private:
+  // Every so many frames are stored without a delta, so that tools can seek and a damaged file
+  // can be read from the next keyframe on.
+  static constexpr u32 KEYFRAME_INTERVAL = 60;
+
+  bool WriteFrame(const FrameHeader& header, const u8* data);
+
+  File::IOFile m_file;
+  bool m_compress = false;
+  u32 m_frames_since_keyframe = 0;
+  u64 m_raw_bytes = 0;
+  u64 m_written_bytes = 0;
+
+  std::vector<u8> m_previous_frame;
+  std::vector<u8> m_delta;
+  std::vector<u8> m_compressed;
+  std::vector<u8> m_work_memory;
+};
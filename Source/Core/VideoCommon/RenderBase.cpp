@@ -12,8 +12,10 @@
 // Next frame, that one is scanned out and the other one gets the copy. = double buffering.
 // ---------------------------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -98,8 +100,6 @@ Renderer::Renderer()
 Renderer::~Renderer()
 {
   ShutdownFrameDumping();
-  if (m_frame_dump_thread.joinable())
-    m_frame_dump_thread.join();
 }
 
 void Renderer::RenderToXFB(u32 xfbAddr, const EFBRectangle& sourceRc, u32 fbStride, u32 fbHeight, float Gamma)
@@ -848,52 +848,106 @@ bool Renderer::IsFrameDumping()
   return false;
 }
 
+// Writes out the frames that are still queued.
 void Renderer::ShutdownFrameDumping()
 {
-  if (!m_frame_dump_thread_running.IsSet())
-    return;
+  {
+    std::lock_guard<std::mutex> lk(m_frame_dump_lock);
+    if (!m_frame_dump_thread_running)
+      return;
+    m_frame_dump_thread_running = false;
+  }
+  m_frame_dump_queued.notify_one();
+  m_frame_dump_thread.join();
 
-  FinishFrameData();
-  m_frame_dump_thread_running.Clear();
-  m_frame_dump_start.Set();
+  if (m_frame_dump_stalls)
+  {
+    INFO_LOG(VIDEO, "Frame dumping held up %u of %u frames for %.1f ms in total",
+             m_frame_dump_stalls, m_frame_dump_frames,
+             std::chrono::duration<double, std::milli>(m_frame_dump_stall_time).count());
+  }
+  m_frame_dump_frames = 0;
+  m_frame_dump_stalls = 0;
+  m_frame_dump_stall_time = {};
 }
 
 void Renderer::DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state, bool swap_upside_down, bool bgra)
 {
-  FinishFrameData();
+  FrameDumpConfig config;
+  config.width = w;
+  config.height = h;
+  config.stride = w * 4;
+  config.bgra = bgra;
+  config.state = state;
+  if (m_screenshot_request.TestAndClear())
+  {
+    std::lock_guard<std::mutex> lk(m_screenshot_lock);
+    config.screenshot_name = std::move(m_screenshot_name);
+    m_screenshot_name.clear();
+  }
 
-  m_frame_dump_config = FrameDumpConfig{ data, w, h, stride, swap_upside_down, bgra, state };
+  {
+    std::unique_lock<std::mutex> lk(m_frame_dump_lock);
+    if (!m_frame_dump_thread_running)
+    {
+      m_frame_dump_thread_running = true;
+      m_frame_dump_thread = std::thread(&Renderer::RunFrameDumps, this);
+    }
+
+    // Back-pressure: the readback has to wait for a buffer once the dumping falls behind
+    if (m_frame_dumps_in_flight == MAX_FRAME_DUMPS_IN_FLIGHT)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      m_frame_dump_written.wait(
+          lk, [this] { return m_frame_dumps_in_flight < MAX_FRAME_DUMPS_IN_FLIGHT; });
+      m_frame_dump_stall_time += std::chrono::steady_clock::now() - start;
+      m_frame_dump_stalls++;
+    }
+    m_frame_dumps_in_flight++;
+    m_frame_dump_frames++;
 
-  if (!m_frame_dump_thread_running.IsSet())
+    if (!m_frame_dump_buffers.empty())
+    {
+      config.data = std::move(m_frame_dump_buffers.back());
+      m_frame_dump_buffers.pop_back();
+    }
+  }
+
+  config.data.resize(static_cast<size_t>(config.stride) * h);
+  for (int y = 0; y < h; y++)
   {
-    if (m_frame_dump_thread.joinable())
-      m_frame_dump_thread.join();
-    m_frame_dump_thread_running.Set();
-    m_frame_dump_thread = std::thread(&Renderer::RunFrameDumps, this);
+    const int src_y = swap_upside_down ? h - 1 - y : y;
+    std::memcpy(&config.data[static_cast<size_t>(y) * config.stride],
+                data + static_cast<ptrdiff_t>(src_y) * stride, config.stride);
   }
 
-  m_frame_dump_start.Set();
-  m_frame_dump_frame_running = true;
+  {
+    std::lock_guard<std::mutex> lk(m_frame_dump_lock);
+    m_frame_dump_queue.push_back(std::move(config));
+  }
+  m_frame_dump_queued.notify_one();
 }
 
-void Renderer::FinishFrameData()
+void Renderer::ReleaseFrameDumpBuffer(std::vector<u8> buffer)
 {
-  if (!m_frame_dump_frame_running)
-    return;
-
-  m_frame_dump_done.Wait();
-  m_frame_dump_frame_running = false;
+  {
+    std::lock_guard<std::mutex> lk(m_frame_dump_lock);
+    m_frame_dump_buffers.push_back(std::move(buffer));
+    m_frame_dumps_in_flight--;
+  }
+  m_frame_dump_written.notify_one();
 }
 
 void Renderer::RunFrameDumps()
 {
   Common::SetCurrentThreadName("FrameDumping");
+  const bool dump_to_raw = g_ActiveConfig.bDumpFramesRaw;
   bool dump_to_avi = !g_ActiveConfig.bDumpFramesAsImages;
   bool frame_dump_started = false;
 
   // If Dolphin was compiled without libav, we only support dumping to images.
 #if !defined(HAVE_LIBAV) && !defined(_WIN32)
-  if (dump_to_avi)
+  if (dump_to_avi && !dump_to_raw)
   {
     WARN_LOG(VIDEO, "AVI frame dump requested, but Dolphin was compiled without libav. "
       "Frame dump will be saved as images instead.");
@@ -903,29 +957,23 @@ void Renderer::RunFrameDumps()
 
   while (true)
   {
-    m_frame_dump_start.Wait();
-    if (!m_frame_dump_thread_running.IsSet())
-      break;
-
-    auto config = m_frame_dump_config;
-
-    if (config.upside_down)
+    FrameDumpConfig config;
     {
-      config.data = config.data + (config.height - 1) * config.stride;
-      config.stride = -config.stride;
+      std::unique_lock<std::mutex> lk(m_frame_dump_lock);
+      m_frame_dump_queued.wait(
+          lk, [this] { return !m_frame_dump_queue.empty() || !m_frame_dump_thread_running; });
+      if (m_frame_dump_queue.empty())
+        break;
+      config = std::move(m_frame_dump_queue.front());
+      m_frame_dump_queue.pop_front();
     }
 
     // Save screenshot
-    if (m_screenshot_request.TestAndClear())
+    if (!config.screenshot_name.empty())
     {
-      std::lock_guard<std::mutex> lk(m_screenshot_lock);
-
-      if (TextureToPng(config.data, config.stride, m_screenshot_name, config.width, config.height,
-        false, (g_ActiveConfig.backend_info.APIType & API_D3D9) != 0))
-        OSD::AddMessage("Screenshot saved to " + m_screenshot_name);
-
-      // Reset settings
-      m_screenshot_name.clear();
+      if (TextureToPng(config.data.data(), config.stride, config.screenshot_name, config.width,
+                       config.height, false, config.bgra))
+        OSD::AddMessage("Screenshot saved to " + config.screenshot_name);
       m_screenshot_completed.Set();
     }
 
@@ -933,7 +981,9 @@ void Renderer::RunFrameDumps()
     {
       if (!frame_dump_started)
       {
-        if (dump_to_avi)
+        if (dump_to_raw)
+          frame_dump_started = StartFrameDumpToRaw(config);
+        else if (dump_to_avi)
           frame_dump_started = StartFrameDumpToAVI(config);
         else
           frame_dump_started = StartFrameDumpToImage(config);
@@ -946,22 +996,47 @@ void Renderer::RunFrameDumps()
       // If we failed to start frame dumping, don't write a frame.
       if (frame_dump_started)
       {
-        if (dump_to_avi)
+        if (dump_to_raw)
+        {
+          m_raw_frame_dump.AddFrame(config.data.data(), config.width, config.height, config.bgra,
+                                    config.state);
+        }
+        else if (dump_to_avi)
+        {
           DumpFrameToAVI(config);
+        }
         else
+        {
           DumpFrameToImage(config);
+          continue;
+        }
       }
     }
 
-    m_frame_dump_done.Set();
+    ReleaseFrameDumpBuffer(std::move(config.data));
   }
 
   if (frame_dump_started)
   {
-    // No additional cleanup is needed when dumping to images.
-    if (dump_to_avi)
+    if (dump_to_raw)
+      m_raw_frame_dump.Stop();
+    else if (dump_to_avi)
       StopFrameDumpToAVI();
+    else
+      StopFrameDumpToImage();
+  }
+}
+
+bool Renderer::StartFrameDumpToRaw(const FrameDumpConfig& config)
+{
+  const std::string filename = File::GetUserPath(D_DUMPFRAMES_IDX) + "framedump.dfr";
+  if (!SConfig::GetInstance().m_DumpFramesSilent && File::Exists(filename) &&
+      !AskYesNoT("Frame dump file '%s' already exists. Overwrite?", filename.c_str()))
+  {
+    return false;
   }
+
+  return m_raw_frame_dump.Start(filename, g_ActiveConfig.bDumpFramesRawCompression);
 }
 
 #if defined(HAVE_LIBAV) || defined(_WIN32)
@@ -973,7 +1048,7 @@ bool Renderer::StartFrameDumpToAVI(const FrameDumpConfig& config)
 
 void Renderer::DumpFrameToAVI(const FrameDumpConfig& config)
 {
-  AVIDump::AddFrame(config.data, config.width, config.height, config.stride, config.state);
+  AVIDump::AddFrame(config.data.data(), config.width, config.height, config.stride, config.state);
 }
 
 void Renderer::StopFrameDumpToAVI()
@@ -1007,6 +1082,7 @@ std::string Renderer::GetFrameDumpNextImageFileName() const
 bool Renderer::StartFrameDumpToImage(const FrameDumpConfig& config)
 {
   m_frame_dump_image_counter = 1;
+
   if (!SConfig::GetInstance().m_DumpFramesSilent)
   {
     // Only check for the presence of the first image to confirm overwriting.
@@ -1020,16 +1096,62 @@ bool Renderer::StartFrameDumpToImage(const FrameDumpConfig& config)
     }
   }
 
+  m_frame_dump_image_workers_running = true;
+  const unsigned int num_workers = std::min(
+      std::max(std::thread::hardware_concurrency() / 2, 1u), MAX_FRAME_DUMP_IMAGE_WORKERS);
+  for (unsigned int i = 0; i < num_workers; i++)
+    m_frame_dump_image_workers.emplace_back(&Renderer::RunFrameDumpImageWorker, this);
   return true;
 }
 
-void Renderer::DumpFrameToImage(const FrameDumpConfig& config)
+void Renderer::DumpFrameToImage(FrameDumpConfig& config)
 {
-  std::string filename = GetFrameDumpNextImageFileName();
-  TextureToPng(config.data, config.stride, filename, config.width, config.height, false);
+  // The file names are given out in order, so the images can be compressed and written in any
+  // order
+  {
+    std::lock_guard<std::mutex> lk(m_frame_dump_lock);
+    m_frame_dump_image_queue.push_back({std::move(config), GetFrameDumpNextImageFileName()});
+  }
+  m_frame_dump_image_queued.notify_one();
   m_frame_dump_image_counter++;
 }
 
+void Renderer::StopFrameDumpToImage()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_frame_dump_lock);
+    m_frame_dump_image_workers_running = false;
+  }
+  m_frame_dump_image_queued.notify_all();
+  for (std::thread& worker : m_frame_dump_image_workers)
+    worker.join();
+  m_frame_dump_image_workers.clear();
+}
+
+void Renderer::RunFrameDumpImageWorker()
+{
+  Common::SetCurrentThreadName("FrameDumpImage");
+  while (true)
+  {
+    FrameDumpImage image;
+    {
+      std::unique_lock<std::mutex> lk(m_frame_dump_lock);
+      m_frame_dump_image_queued.wait(lk, [this] {
+        return !m_frame_dump_image_queue.empty() || !m_frame_dump_image_workers_running;
+      });
+      if (m_frame_dump_image_queue.empty())
+        break;
+      image = std::move(m_frame_dump_image_queue.front());
+      m_frame_dump_image_queue.pop_front();
+    }
+
+    const FrameDumpConfig& config = image.config;
+    TextureToPng(config.data.data(), config.stride, image.filename, config.width, config.height,
+                 false);
+    ReleaseFrameDumpBuffer(std::move(image.config.data));
+  }
+}
+
 bool Renderer::UseVertexDepthRange() const
 {
   // We can't compute the depth range in the vertex shader if we don't support depth clamp.
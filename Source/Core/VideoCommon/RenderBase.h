@@ -13,7 +13,9 @@
 // ---------------------------------------------------------------------------------------------
 
 #pragma once
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -29,6 +31,7 @@
 
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/FPSCounter.h"
+#include "VideoCommon/RawFrameDump.h"
 #include "VideoCommon/RenderState.h"
 #include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoCommon.h"
@@ -158,8 +161,9 @@ protected:
   static void RecordVideoMemory();
 
   bool IsFrameDumping();
+  // Copies the frame into a queue that is written out by the frame dumping threads, so the data
+  // doesn't need to stay around afterwards. Only waits if the dumping can't keep up.
   void DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state, bool swap_upside_down = false, bool bgra = false);
-  void FinishFrameData();
 
   Common::Flag m_screenshot_request;
   Common::Event m_screenshot_completed;
@@ -206,31 +210,65 @@ private:
   u32 m_last_window_request_height = 0;
 
   // frame dumping
-  std::thread m_frame_dump_thread;
-  Common::Event m_frame_dump_start;
-  Common::Event m_frame_dump_done;
-  Common::Flag m_frame_dump_thread_running;
-  u32 m_frame_dump_image_counter = 0;
-  bool m_frame_dump_frame_running = false;
+  // Frames that are queued or being written at once. Each holds a copy of the frame.
+  static constexpr size_t MAX_FRAME_DUMPS_IN_FLIGHT = 8;
+  static constexpr unsigned int MAX_FRAME_DUMP_IMAGE_WORKERS = 4;
 
   struct FrameDumpConfig
   {
-    const u8* data;
+    // Top-down, with a stride of width * 4. Taken from and returned to m_frame_dump_buffers.
+    std::vector<u8> data;
     int width;
     int height;
     int stride;
-    bool upside_down;
     bool bgra;
     AVIDump::Frame state;
-  } m_frame_dump_config;
+    // Set if this frame is also saved as a screenshot
+    std::string screenshot_name;
+  };
+
+  struct FrameDumpImage
+  {
+    FrameDumpConfig config;
+    std::string filename;
+  };
+
+  // The frames are taken from m_frame_dump_queue in order by m_frame_dump_thread, which feeds
+  // AVIDump, or hands them to m_frame_dump_image_workers to be compressed in parallel when
+  // dumping to images. All of the queues and the buffer pool are guarded by m_frame_dump_lock.
+  std::thread m_frame_dump_thread;
+  std::vector<std::thread> m_frame_dump_image_workers;
+  std::mutex m_frame_dump_lock;
+  std::condition_variable m_frame_dump_queued;
+  std::condition_variable m_frame_dump_image_queued;
+  std::condition_variable m_frame_dump_written;
+  std::deque<FrameDumpConfig> m_frame_dump_queue;
+  std::deque<FrameDumpImage> m_frame_dump_image_queue;
+  std::vector<std::vector<u8>> m_frame_dump_buffers;
+  size_t m_frame_dumps_in_flight = 0;
+  bool m_frame_dump_thread_running = false;
+  bool m_frame_dump_image_workers_running = false;
+  u32 m_frame_dump_image_counter = 0;
+  RawFrameDump m_raw_frame_dump;
+
+  // Back-pressure statistics, logged when frame dumping stops
+  u32 m_frame_dump_frames = 0;
+  u32 m_frame_dump_stalls = 0;
+  std::chrono::steady_clock::duration m_frame_dump_stall_time{};
+
+  void ReleaseFrameDumpBuffer(std::vector<u8> buffer);
+  void RunFrameDumpImageWorker();
 
   // NOTE: The methods below are called on the framedumping thread.
   bool StartFrameDumpToAVI(const FrameDumpConfig& config);
   void DumpFrameToAVI(const FrameDumpConfig& config);
   void StopFrameDumpToAVI();
+  bool StartFrameDumpToRaw(const FrameDumpConfig& config);
   std::string GetFrameDumpNextImageFileName() const;
   bool StartFrameDumpToImage(const FrameDumpConfig& config);
-  void DumpFrameToImage(const FrameDumpConfig& config);
+  // Takes the frame's buffer, which is released once the image is written
+  void DumpFrameToImage(FrameDumpConfig& config);
+  void StopFrameDumpToImage();
 
 };
 
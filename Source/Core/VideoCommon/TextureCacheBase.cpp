@@ -11,6 +11,7 @@
 #include "Common/FileUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/TaskScheduler.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/FifoPlayer/FifoPlayer.h"
@@ -20,6 +21,7 @@
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/PostProcessing.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/SamplerCommon.h"
@@ -36,6 +38,46 @@ static const u64 MAX_TEXTURE_BINARY_SIZE =
     1024 * 1024 * 4;  // 1024 x 1024 texel times 8 nibbles per texel
 std::unique_ptr<TextureCacheBase> g_texture_cache;
 
+// Textures with fewer texels than this are decoded on the calling thread, as handing them to
+// the task scheduler would cost more than it saves.
+static const u32 PARALLEL_DECODE_MIN_TEXELS = 256 * 256;
+// Smallest number of texel rows a decoding task gets
+static const u32 PARALLEL_DECODE_MIN_ROWS = 32;
+
+// Same as TexDecoder::Decode, but large textures are split into bands of whole block rows that
+// are decoded in parallel. width and height must be multiples of the block size.
+static HostTextureFormat DecodeTexture(u8* dst, const u8* src, u32 width, u32 height,
+                                       u32 texformat, u32 tlutaddr, TlutFormat tlutfmt,
+                                       bool rgba_only, bool compressed_supported)
+{
+  const HostTextureFormat host_format =
+      rgba_only ? PC_TEX_FMT_RGBA32 :
+                  TexDecoder::GetHostTextureFormat(texformat, tlutfmt, compressed_supported);
+  const u32 block_height = TexDecoder::GetBlockHeightInTexels(texformat);
+  const u32 rows_per_band = Common::AlignUp(PARALLEL_DECODE_MIN_ROWS, block_height);
+  // The format overlay would be drawn into every band
+  if (width * height < PARALLEL_DECODE_MIN_TEXELS || height < 2 * rows_per_band ||
+      host_format == PC_TEX_FMT_NONE || g_ActiveConfig.bTexFmtOverlayEnable)
+  {
+    return TexDecoder::Decode(dst, src, width, height, texformat, tlutaddr, tlutfmt, rgba_only,
+                              compressed_supported);
+  }
+
+  const u32 src_band_size = TexDecoder::GetTextureSizeInBytes(width, rows_per_band, texformat);
+  const u32 dst_band_size = TextureUtil::GetTextureSizeInBytes(width, rows_per_band, host_format);
+  const s32 num_bands = static_cast<s32>((height + rows_per_band - 1) / rows_per_band);
+  Common::TaskScheduler::ParallelFor(0, num_bands, 1, [&](s32 first, s32 last) {
+    for (s32 band = first; band < last; ++band)
+    {
+      const u32 y = band * rows_per_band;
+      TexDecoder::Decode(dst + band * dst_band_size, src + band * src_band_size, width,
+                         std::min(rows_per_band, height - y), texformat, tlutaddr, tlutfmt,
+                         rgba_only, compressed_supported);
+    }
+  });
+  return host_format;
+}
+
 TextureCacheBase::TCacheEntry::TCacheEntry(std::unique_ptr<HostTexture> tex, bool material,
                                            bool luma)
 {
@@ -482,8 +524,11 @@ void TextureCacheBase::DumpTexture(TCacheEntry* entry, std::string basename, u32
   std::string filename = szDir + "/" + basename +
                          (TexDecoder::IsCompressed(entry->GetConfig().pcformat) ? ".dds" : ".png");
 
-  if (!File::Exists(filename))
-    entry->texture->Save(filename, level);
+  if (ImageWriter::Reserve(filename) && !File::Exists(filename) &&
+      !entry->texture->Save(filename, level))
+  {
+    ImageWriter::Release(filename);
+  }
 }
 
 // Used by TextureCacheBase::Load
@@ -1016,6 +1061,51 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
       ptr_odd = &texMem[bpmem.tex[stage / 4].texImage2[stage % 4].tmem_odd * TMEM_LINE_SIZE];
     }
 
+    const bool rgba_only = PC_TEX_FMT_RGBA32 == config.pcformat;
+    const bool compressed_supported = config.pcformat >= PC_TEX_FMT_DXT1;
+
+    // When decoding on the CPU, the mip levels are decoded alongside level 0 and each other, each
+    // into its own part of temp. They are still loaded in order further down.
+    std::vector<u8*> decoded_mips(texLevels, nullptr);
+    Common::TaskGroup mip_decodes;
+    if (!decode_on_gpu && texLevels > 1)
+    {
+      // No decoded format takes more than 4 bytes per texel
+      std::vector<size_t> mip_offsets(texLevels);
+      size_t required_size = Common::AlignUp(expandedWidth * expandedHeight * 4, 64);
+      for (u32 level = 1; level != texLevels; ++level)
+      {
+        const u32 expanded_mip_width =
+            Common::AlignUpSizePow2(TextureUtil::CalculateLevelSize(width, level), bsw);
+        const u32 expanded_mip_height =
+            Common::AlignUpSizePow2(TextureUtil::CalculateLevelSize(height, level), bsh);
+        mip_offsets[level] = required_size;
+        required_size += Common::AlignUp(expanded_mip_width * expanded_mip_height * 4, 64);
+      }
+      CheckTempSize(required_size);
+
+      const u8* tmem_mip_src[2] = {ptr_even, ptr_odd};
+      const u8* ram_mip_src = src_data + texture_size;
+      for (u32 level = 1; level != texLevels; ++level)
+      {
+        const u32 expanded_mip_width =
+            Common::AlignUpSizePow2(TextureUtil::CalculateLevelSize(width, level), bsw);
+        const u32 expanded_mip_height =
+            Common::AlignUpSizePow2(TextureUtil::CalculateLevelSize(height, level), bsh);
+        const u8*& mip_src_data = from_tmem ? tmem_mip_src[level % 2] : ram_mip_src;
+        const u8* level_src = mip_src_data;
+        u8* level_dst = TextureCacheBase::temp + mip_offsets[level];
+        decoded_mips[level] = level_dst;
+        mip_decodes.Run([=] {
+          DecodeTexture(level_dst, level_src, expanded_mip_width, expanded_mip_height, texformat,
+                        tlutaddr, static_cast<TlutFormat>(tlutfmt), rgba_only,
+                        compressed_supported);
+        });
+        mip_src_data +=
+            TexDecoder::GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
+      }
+    }
+
     if (decode_on_gpu)
     {
       u32 row_stride = bytes_per_block * (expandedWidth / bsw);
@@ -1038,10 +1128,8 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
       }
       else
       {
-        TexDecoder::Decode(texturedata, src_data, expandedWidth, expandedHeight, texformat,
-                           tlutaddr, static_cast<TlutFormat>(tlutfmt),
-                           PC_TEX_FMT_RGBA32 == config.pcformat,
-                           config.pcformat >= PC_TEX_FMT_DXT1);
+        DecodeTexture(texturedata, src_data, expandedWidth, expandedHeight, texformat, tlutaddr,
+                      static_cast<TlutFormat>(tlutfmt), rgba_only, compressed_supported);
       }
 
       if (full_hash == PRIME2_PIXEL_HASH)
@@ -1067,6 +1155,7 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
       DumpTexture(entry, basename, 0);
     }
     src_data += texture_size;
+    mip_decodes.Wait();
 
     for (u32 level = 1; level != texLevels; ++level)
     {
@@ -1087,14 +1176,18 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
       }
       if (!decode_on_gpu)
       {
-        u8* texturedata = TextureCacheBase::temp;
+        u8* texturedata = decoded_mips[level];
         u32 twidth = mip_width;
         u32 theight = mip_height;
         u32 texpandedWidth = expanded_mip_width;
-        TexDecoder::Decode(texturedata, mip_src_data, expanded_mip_width, expanded_mip_height,
-                           texformat, tlutaddr, static_cast<TlutFormat>(tlutfmt),
-                           PC_TEX_FMT_RGBA32 == config.pcformat,
-                           config.pcformat >= PC_TEX_FMT_DXT1);
+        // Only happens when decoding on the GPU failed for this level
+        if (!texturedata)
+        {
+          texturedata = TextureCacheBase::temp;
+          DecodeTexture(texturedata, mip_src_data, expanded_mip_width, expanded_mip_height,
+                        texformat, tlutaddr, static_cast<TlutFormat>(tlutfmt), rgba_only,
+                        compressed_supported);
+        }
 
         if (full_hash == PRIME2_PIXEL_HASH)
         {
@@ -1106,8 +1199,8 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
         }
         else if (use_scaling)
         {
-          texturedata =
-              reinterpret_cast<u8*>(m_scaler->Scale((u32*)texturedata, expandedWidth, height));
+          texturedata = reinterpret_cast<u8*>(
+              m_scaler->Scale((u32*)texturedata, expanded_mip_width, mip_height));
           twidth *= g_ActiveConfig.iTexScalingFactor;
           theight *= g_ActiveConfig.iTexScalingFactor;
           texpandedWidth *= g_ActiveConfig.iTexScalingFactor;
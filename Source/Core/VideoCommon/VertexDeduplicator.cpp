@@ -0,0 +1,136 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/BitHelpers.h"
+#include "Common/MathUtil.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/VertexDeduplicator.h"
+
+// How many vertices are looked at before deciding whether to go on
+static constexpr u32 GIVE_UP_CHECK = 48;
+
+// A table entry is the key of a vertex, then the stamp of the draw and the index of the vertex
+static constexpr size_t ENTRY_WORDS = 3;
+
+bool VertexDeduplicator::CanDeduplicate(const TVtxDesc& vtx_desc, u32 vertex_size)
+{
+  if (vertex_size > MAX_VERTEX_SIZE || vtx_desc.Position < INDEX8)
+    return false;
+
+  // A direct attribute would make every vertex different, or needs more bytes than we compare
+  for (int i = 0; i < 12; i++)
+  {
+    if (vtx_desc.GetVertexArrayStatus(i) == DIRECT)
+      return false;
+  }
+  return true;
+}
+
+bool VertexDeduplicator::Deduplicate(const u8* src, size_t buf_size, u32 count, u32 vertex_size,
+                                     const TVtxDesc& vtx_desc)
+{
+  // Entries from earlier draws have older stamps, so the table needs no clearing
+  if (++m_stamp == 0)
+  {
+    std::fill(m_table.begin(), m_table.end(), 0);
+    m_stamp = 1;
+  }
+  // Each vertex is stored as a whole key, spilling into the next one or the padding
+  m_vertices.resize(std::max<size_t>(m_vertices.size(), count * vertex_size + 2 * sizeof(u64)));
+  m_remap.resize(std::max<size_t>(m_remap.size(), count));
+
+  // The position index comes after the matrix indices
+  const u32 position_offset = CountSetBits(static_cast<u32>(vtx_desc.Hex & 0x1FF));
+  const u32 position_bytes = vtx_desc.Position == INDEX16 ? 2 : 1;
+  if (vertex_size <= 8)
+    return Deduplicate<1>(src, buf_size, count, vertex_size, position_offset, position_bytes);
+  return Deduplicate<2>(src, buf_size, count, vertex_size, position_offset, position_bytes);
+}
+
+template <int KEY_WORDS>
+bool VertexDeduplicator::Deduplicate(const u8* src, size_t buf_size, u32 count, u32 vertex_size,
+                                     u32 position_offset, u32 position_bytes)
+{
+  // Sized for the vertex count, while a draw worth deduplicating has far fewer distinct vertices,
+  // so they seldom share a slot. When they do, the later one takes it over and the earlier one
+  // isn't found again, which only costs another copy of it.
+  const u32 table_bits = IntLog2(std::max(count, 16u)) + 1;
+  const size_t table_size = (size_t(1) << table_bits) * ENTRY_WORDS;
+  if (m_table.size() < table_size)
+    m_table.resize(table_size);
+
+  // The key is the raw vertex in little endian words, with the bytes past its end cleared
+  const u64 mask0 = vertex_size >= 8 ? ~0ULL : (1ULL << (vertex_size * 8)) - 1;
+  const u64 mask1 = vertex_size >= 16 ? ~0ULL :
+                    vertex_size <= 8 ? 0 : (1ULL << ((vertex_size - 8) * 8)) - 1;
+  // A position index of -1 has all its bits set
+  const u64 skip = (position_bytes == 2 ? 0xFFFFULL : 0xFFULL) << (position_offset % 8 * 8);
+  const u64 skip0 = position_offset < 8 ? skip : 0;
+  const u64 skip1 = position_offset < 8 ? (position_offset == 7 && position_bytes == 2 ? 0xFF : 0) :
+                                          skip;
+
+  // Written without branches, as whether a vertex was seen before is hard to predict. Every
+  // vertex is stored as if it were new, and only counted when it is.
+  u64* const table = m_table.data();
+  u8* const vertices = m_vertices.data();
+  u16* const remap = m_remap.data();
+  const u64 stamp = static_cast<u64>(m_stamp) << 16;
+  u32 num_unique = 0;
+  u32 num_vertices = 0;
+  for (u32 i = 0; i < count; i++)
+  {
+    // Most draws that repeat vertices do so right away, as strips and meshes go back to the
+    // vertices of the previous triangles
+    if (i == GIVE_UP_CHECK && num_unique * 4 > num_vertices * 3)
+      return false;
+
+    const u8* const vertex = src + i * vertex_size;
+    u64 key0, key1;
+    if (i * vertex_size + 2 * sizeof(u64) <= buf_size)
+    {
+      std::memcpy(&key0, vertex, sizeof(u64));
+      std::memcpy(&key1, vertex + sizeof(u64), sizeof(u64));
+    }
+    else
+    {
+      u64 last[2] = {};
+      std::memcpy(last, vertex, vertex_size);
+      key0 = last[0];
+      key1 = last[1];
+    }
+    key0 &= mask0;
+    key1 &= mask1;
+
+    u64 hash = key0;
+    if (KEY_WORDS == 2)
+      hash ^= key1 * 0xC2B2AE3D27D4EB4FULL;
+    u64* const entry =
+        table + ((hash * 0x9E3779B97F4A7C15ULL) >> (64 - table_bits)) * ENTRY_WORDS;
+
+    const u64 tag = entry[2];
+    u64 difference = ((tag ^ stamp) >> 16) | (entry[0] ^ key0);
+    if (KEY_WORDS == 2)
+      difference |= entry[1] ^ key1;
+    const u32 seen = difference == 0;
+    const u32 skipped = ((key0 & skip0) == skip0) & ((key1 & skip1) == skip1);
+    const u32 unique = seen ? static_cast<u32>(tag & 0xFFFF) : num_unique;
+
+    u8* const copy = vertices + num_unique * vertex_size;
+    std::memcpy(copy, &key0, sizeof(u64));
+    std::memcpy(copy + sizeof(u64), &key1, sizeof(u64));
+    entry[0] = key0;
+    entry[1] = key1;
+    entry[2] = skipped ? 0 : stamp | unique;
+    remap[num_vertices] = static_cast<u16>(unique);
+    num_unique += ~seen & ~skipped & 1;
+    num_vertices += !skipped;
+  }
+
+  m_num_unique = num_unique;
+  m_num_vertices = num_vertices;
+  return true;
+}
@@ -0,0 +1,51 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+union TVtxDesc;
+
+// Finds the vertices a draw uses more than once. When every attribute is indexed, a vertex is
+// just a tuple of array indices, and vertices with the same indices load to the same output, so
+// strips, fans and meshes that reuse their vertices only need each one loaded once.
+class VertexDeduplicator
+{
+public:
+  // Raw vertices are compared as two 64 bit words
+  static constexpr u32 MAX_VERTEX_SIZE = 16;
+
+  // Whether the vertices of a format can be told apart by their raw bytes
+  static bool CanDeduplicate(const TVtxDesc& vtx_desc, u32 vertex_size);
+
+  // Copies the distinct vertices among the count at src to GetVertices(). Vertices with a
+  // position index of -1 are dropped like the loaders drop them. Gives up and returns false early
+  // on when the draw doesn't seem to repeat enough vertices to make up for looking.
+  bool Deduplicate(const u8* src, size_t buf_size, u32 count, u32 vertex_size,
+                   const TVtxDesc& vtx_desc);
+
+  u8* GetVertices() { return m_vertices.data(); }
+  u32 GetNumUniqueVertices() const { return m_num_unique; }
+  // Which of the distinct vertices each vertex that wasn't dropped is a copy of
+  const u16* GetRemap() const { return m_remap.data(); }
+  // How many vertices weren't dropped
+  u32 GetNumVertices() const { return m_num_vertices; }
+
+private:
+  template <int KEY_WORDS>
+  bool Deduplicate(const u8* src, size_t buf_size, u32 count, u32 vertex_size, u32 position_offset,
+                  u32 position_bytes);
+
+  // The last distinct vertex with each hash
+  std::vector<u64> m_table;
+  std::vector<u8> m_vertices;
+  std::vector<u16> m_remap;
+  u32 m_num_unique = 0;
+  u32 m_num_vertices = 0;
+  u32 m_stamp = 0;
+};
+
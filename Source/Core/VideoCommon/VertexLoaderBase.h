@@ -76,6 +76,11 @@ public:
   {
     return false;
   }
+  // Whether finding the repeated vertices of a draw is quicker than loading them again
+  virtual bool WantsDeduplication()
+  {
+    return true;
+  }
   virtual s32 RunVertices(const VertexLoaderParameters &parameters) = 0;
 
   virtual bool IsInitialized() = 0;
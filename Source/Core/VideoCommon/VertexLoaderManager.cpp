@@ -14,8 +14,10 @@
 #include "Common/ThreadPool.h"
 #include "Common/StringUtil.h"
 
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexDeduplicator.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -33,6 +35,9 @@ namespace VertexLoaderManager
 static VertexLoaderMap s_vertex_loader_map;
 static NativeVertexFormatMap s_native_vertex_map;
 static NativeVertexFormat* s_current_vtx_fmt;
+static VertexDeduplicator s_deduplicator;
+// Smaller draws, like the quads of sprites and text, hardly ever repeat a vertex
+static constexpr int MIN_DEDUPLICATED_VERTICES = 24;
 u32 g_current_components;
 
 NativeVertexFormat* GetCurrentVertexFormat()
@@ -272,9 +277,32 @@ bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &wri
   VertexShaderManager::SetVertexFormat(loader->m_native_components);
   g_vertex_manager->PrepareForAdditionalData(parameters.primitive, parameters.count, loader->m_native_stride);
   parameters.destination = g_vertex_manager->GetCurrentBufferPointer();
-  s32 finalcount = loader->RunVertices(parameters);
-  writesize = loader->m_native_stride * finalcount;
-  IndexGenerator::AddIndices(parameters.primitive, finalcount);
+  s32 finalcount;
+  // Repeated vertices are loaded once and drawn through the indices, unless the bounding box
+  // is computed on the cpu, which the loaders do one vertex at a time.
+  if (parameters.count >= MIN_DEDUPLICATED_VERTICES && loader->WantsDeduplication() &&
+      VertexDeduplicator::CanDeduplicate(*parameters.VtxDesc, loader->m_VertexSize) &&
+      !(g_ActiveConfig.iBBoxMode == BBoxCPU && BoundingBox::active) &&
+      s_deduplicator.Deduplicate(parameters.source, parameters.buf_size, parameters.count,
+                                 loader->m_VertexSize, *parameters.VtxDesc))
+  {
+    VertexLoaderParameters unique = parameters;
+    unique.source = s_deduplicator.GetVertices();
+    unique.count = s_deduplicator.GetNumUniqueVertices();
+    unique.buf_size = unique.count * loader->m_VertexSize;
+    if (unique.count > 0)
+      loader->RunVertices(unique);
+    finalcount = s_deduplicator.GetNumVertices();
+    writesize = loader->m_native_stride * unique.count;
+    IndexGenerator::AddRemappedIndices(parameters.primitive, finalcount,
+                                       s_deduplicator.GetRemap(), unique.count);
+  }
+  else
+  {
+    finalcount = loader->RunVertices(parameters);
+    writesize = loader->m_native_stride * finalcount;
+    IndexGenerator::AddIndices(parameters.primitive, finalcount);
+  }
   ADDSTAT(stats.thisFrame.numPrims, finalcount);
   INCSTAT(stats.thisFrame.numPrimitiveJoins);
   return true;
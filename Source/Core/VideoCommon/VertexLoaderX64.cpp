@@ -2,6 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <iterator>
+
 #include "Common/BitSet.h"
 #include "Common/Common.h"
 #include "Common/CPUDetect.h"
@@ -33,28 +36,48 @@ static OpArg MPIC(const void* ptr)
   return MDisp(base_reg, PtrOffset(ptr, memory_base_ptr));
 }
 
-static __m128 scale_factors[13] = {
-    _mm_set_ps1(0.0f),
-    _mm_set_ps1(fractionTable[7]),
-    _mm_set_ps1(fractionTable[6]),
-    _mm_set_ps1(fractionTable[15]),
-    _mm_set_ps1(fractionTable[14]),
-    _mm_set_ps1(0.0f),
-    _mm_set_ps1(0.0f),
-    _mm_set_ps1(0.0f),
-    _mm_set_ps1(0.0f),
-    _mm_set_ps1(0.0f),
-    _mm_set_ps1(0.0f),
-    _mm_set_ps1(0.0f),
-    _mm_set_ps1(0.0f)
+// Each scale factor is repeated across 32 bytes, so that the AVX2 loop can scale the attributes
+// of two vertices with one multiplication.
+alignas(32) static float scale_factors[13][8];
+
+static void SetScaleFactor(int index, float factor)
+{
+  std::fill(std::begin(scale_factors[index]), std::end(scale_factors[index]), factor);
+}
+
+// Byteswaps and widens 1-3 components to 32 bits. Both 128-bit lanes hold the same mask, for the
+// same reason.
+#define SHUFFLE_MASK(a, b, c, d) { _mm_set_epi32(a, b, c, d), _mm_set_epi32(a, b, c, d) }
+alignas(32) static const __m128i shuffle_lut[5][3][2] = {
+    { SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF00L),  // 1x u8
+    SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF01L, 0xFFFFFF00L),  // 2x u8
+    SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFF02L, 0xFFFFFF01L, 0xFFFFFF00L) }, // 3x u8
+    { SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00FFFFFFL),  // 1x s8
+    SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL),  // 2x s8
+    SHUFFLE_MASK(0xFFFFFFFFL, 0x02FFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL) }, // 3x s8
+    { SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0001L),  // 1x u16
+    SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0203L, 0xFFFF0001L),  // 2x u16
+    SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFF0405L, 0xFFFF0203L, 0xFFFF0001L) }, // 3x u16
+    { SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x0001FFFFL),  // 1x s16
+    SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0x0203FFFFL, 0x0001FFFFL),  // 2x s16
+    SHUFFLE_MASK(0xFFFFFFFFL, 0x0405FFFFL, 0x0203FFFFL, 0x0001FFFFL) }, // 3x s16
+    { SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00010203L),  // 1x float
+    SHUFFLE_MASK(0xFFFFFFFFL, 0xFFFFFFFFL, 0x04050607L, 0x00010203L),  // 2x float
+    SHUFFLE_MASK(0xFFFFFFFFL, 0x08090A0BL, 0x04050607L, 0x00010203L) }, // 3x float
 };
+#undef SHUFFLE_MASK
 
 VertexLoaderX64::VertexLoaderX64(const TVtxDesc& vtx_desc, const VAT& vtx_att) : VertexLoaderBase(vtx_desc, vtx_att)
 {
   if (!IsInitialized())
     return;
 
-  AllocCodeSpace(1024);
+  SetScaleFactor(1, fractionTable[7]);
+  SetScaleFactor(2, fractionTable[6]);
+  SetScaleFactor(3, fractionTable[15]);
+  SetScaleFactor(4, fractionTable[14]);
+
+  AllocCodeSpace(4096);
   ClearCodeSpace();
   GenerateVertexLoader();
   WriteProtect();
@@ -89,24 +112,6 @@ OpArg VertexLoaderX64::GetVertexAddr(int array, u64 attribute)
 
 int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count_in, int count_out, bool dequantize, AttributeFormat* native_format, X64Reg scaling_register)
 {
-  static const __m128i shuffle_lut[5][3] = {
-      { _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF00L),  // 1x u8
-      _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFF01L, 0xFFFFFF00L),  // 2x u8
-      _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFF02L, 0xFFFFFF01L, 0xFFFFFF00L) }, // 3x u8
-      { _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00FFFFFFL),  // 1x s8
-      _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL),  // 2x s8
-      _mm_set_epi32(0xFFFFFFFFL, 0x02FFFFFFL, 0x01FFFFFFL, 0x00FFFFFFL) }, // 3x s8
-      { _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0001L),  // 1x u16
-      _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFF0203L, 0xFFFF0001L),  // 2x u16
-      _mm_set_epi32(0xFFFFFFFFL, 0xFFFF0405L, 0xFFFF0203L, 0xFFFF0001L) }, // 3x u16
-      { _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x0001FFFFL),  // 1x s16
-      _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x0203FFFFL, 0x0001FFFFL),  // 2x s16
-      _mm_set_epi32(0xFFFFFFFFL, 0x0405FFFFL, 0x0203FFFFL, 0x0001FFFFL) }, // 3x s16
-      { _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x00010203L),  // 1x float
-      _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x04050607L, 0x00010203L),  // 2x float
-      _mm_set_epi32(0xFFFFFFFFL, 0x08090A0BL, 0x04050607L, 0x00010203L) }, // 3x float
-  };
-
   X64Reg coords = XMM0;
   int elem_size = 1 << (format / 2);
   int load_bytes = elem_size * count_in;
@@ -131,7 +136,7 @@ int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count
     else
       MOVD_xmm(coords, data);
 
-    PSHUFB(coords, MPIC(&shuffle_lut[format][count_in - 1]));
+    PSHUFB(coords, MPIC(shuffle_lut[format][count_in - 1]));
 
     // Sign-extend.
     if (format == FORMAT_BYTE)
@@ -380,16 +385,6 @@ void VertexLoaderX64::GenerateVertexLoader()
   MOV(32, R(count_reg), R(ABI_PARAM3));
 
   MOV(64, R(base_reg), R(ABI_PARAM4));
-  // Load Contants into registers outside the main loop to reduce memory overhead
-  if (m_VtxAttr.PosFormat != FORMAT_FLOAT && m_VtxAttr.ByteDequant)
-  {
-    MOVAPD(XMM2, MPIC(&scale_factors[0]));
-  }
-  if (m_VtxDesc.Normal)
-  {
-    MOVAPD(XMM3, MPIC(&scale_factors[m_VtxAttr.NormalFormat + 1]));
-  }
-
   const u64 tc[8] = {
       m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord, m_VtxDesc.Tex3Coord,
       m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord, m_VtxDesc.Tex6Coord, m_VtxDesc.Tex7Coord,
@@ -399,21 +394,49 @@ void VertexLoaderX64::GenerateVertexLoader()
       XMM8, XMM9, XMM10, XMM11,
   };
 
-  if (m_VtxAttr.ByteDequant)
-  {
-    for (int i = 0; i < 8; i++)
+  // With AVX2, the vertices are loaded two at a time by a second loop after this one, which only
+  // comes here for the last odd vertex, or for pairs with a skipped vertex. That loop uses all the
+  // vector registers, so the constants are then loaded every time this one is entered.
+  const bool load_pairs = cpu_info.bAVX2;
+  const auto load_constants = [&] {
+    if (m_VtxAttr.PosFormat != FORMAT_FLOAT && m_VtxAttr.ByteDequant)
     {
-      if (tc[i] && m_VtxAttr.texCoord[i].Format != FORMAT_FLOAT)
+      MOVAPD(XMM2, MPIC(&scale_factors[0]));
+    }
+    if (m_VtxDesc.Normal)
+    {
+      MOVAPD(XMM3, MPIC(&scale_factors[m_VtxAttr.NormalFormat + 1]));
+    }
+
+    if (m_VtxAttr.ByteDequant)
+    {
+      for (int i = 0; i < 8; i++)
       {
-        MOVAPD(treg[i], MPIC(&scale_factors[5 + i]));
+        if (tc[i] && m_VtxAttr.texCoord[i].Format != FORMAT_FLOAT)
+        {
+          MOVAPD(treg[i], MPIC(&scale_factors[5 + i]));
+        }
       }
     }
-  }
+  };
+
+  // Load Contants into registers outside the main loop to reduce memory overhead
+  if (!load_pairs)
+    load_constants();
 
   if (m_VtxDesc.Position & MASKINDEXED)
     XOR(32, R(skipped_reg), R(skipped_reg));
 
+  FixupBranch first_pair;
+  if (load_pairs)
+    first_pair = J(true);
+
   const u8* loop_start = GetCodePtr();
+  if (load_pairs)
+  {
+    VZEROUPPER();
+    load_constants();
+  }
 
   if (m_VtxDesc.PosMatIdx)
   {
@@ -439,7 +462,8 @@ void VertexLoaderX64::GenerateVertexLoader()
   {
     for (int i = 0; i < (m_VtxAttr.NormalElements ? 3 : 1); i++)
     {
-      if (!i || m_VtxAttr.NormalIndex3)
+      // Direct normals are always read in one go, NormalIndex3 only means anything with indices
+      if (!i || (m_VtxAttr.NormalIndex3 && (m_VtxDesc.Normal & MASKINDEXED)))
       {
         data = GetVertexAddr(ARRAY_NORMAL, m_VtxDesc.Normal);
         int elem_size = 1 << (m_VtxAttr.NormalFormat / 2);
@@ -519,6 +543,9 @@ void VertexLoaderX64::GenerateVertexLoader()
   m_native_vtx_decl.posmtx.offset = m_dst_ofs;
   m_native_vtx_decl.posmtx.type = FORMAT_UBYTE;
   m_dst_ofs += sizeof(u32);
+  m_native_stride = m_dst_ofs;
+  m_VertexSize = m_src_ofs;
+  m_native_vtx_decl.stride = m_native_stride;
 
   // Prepare for the next vertex.
 
@@ -527,7 +554,18 @@ void VertexLoaderX64::GenerateVertexLoader()
   ADD(64, R(src_reg), Imm32(m_src_ofs));
 
   SUB(32, R(count_reg), Imm8(1));
-  J_CC(CC_NZ, loop_start);
+  if (load_pairs)
+  {
+    FixupBranch done = J_CC(CC_Z, true);
+    SetJumpTarget(first_pair);
+    GenerateVertexPairLoader(loop_start);
+    SetJumpTarget(done);
+    VZEROUPPER();
+  }
+  else
+  {
+    J_CC(CC_NZ, loop_start);
+  }
 
   // Get the original count.
   POP(32, R(ABI_RETURN));
@@ -541,15 +579,262 @@ void VertexLoaderX64::GenerateVertexLoader()
 
     SetJumpTarget(m_skip_vertex);
     ADD(32, R(skipped_reg), Imm8(1));
-    JMP(cont);
+    JMP(cont, true);
   }
   else
   {
     RET();
   }
-  m_native_stride = m_dst_ofs;
-  m_VertexSize = m_src_ofs;
-  m_native_vtx_decl.stride = m_native_stride;
+}
+
+void VertexLoaderX64::GetVertexPairAddr(int array, u64 attribute, OpArg* first, OpArg* second)
+{
+  OpArg data = MDisp(src_reg, m_src_ofs);
+  *first = data;
+  data.AddMemOffset(m_VertexSize);
+  *second = data;
+  if (attribute & MASKINDEXED)
+  {
+    // Skipped vertices never get here, they are loaded one at a time.
+    int bits = attribute == INDEX8 ? 8 : 16;
+    LoadAndSwap(bits, scratch1, *first);
+    LoadAndSwap(bits, scratch3, *second);
+    m_src_ofs += bits / 8;
+    IMUL(32, scratch1, MPIC(&g_main_cp_state.array_strides[array]));
+    IMUL(32, scratch3, MPIC(&g_main_cp_state.array_strides[array]));
+    MOV(64, R(scratch2), MPIC(&cached_arraybases[array]));
+    *first = MRegSum(scratch1, scratch2);
+    *second = MRegSum(scratch3, scratch2);
+  }
+}
+
+int VertexLoaderX64::ReadVertexPair(OpArg first, OpArg second, u64 attribute, int format, int count_in, int count_out, bool dequantize, int scale_index, const AttributeFormat& native_format, X64Reg coords)
+{
+  int elem_size = 1 << (format / 2);
+  int load_bytes = elem_size * count_in;
+
+  if (attribute == DIRECT)
+    m_src_ofs += load_bytes;
+
+  // The same loads as ReadVertex, with the second vertex in the upper lane.
+  X64Reg temp = XMM15;
+  if (load_bytes > 8)
+  {
+    VMOVDQU(coords, first);
+    VMOVDQU(temp, second);
+  }
+  else if (load_bytes > 4)
+  {
+    VMOVQ_xmm(coords, first);
+    VMOVQ_xmm(temp, second);
+  }
+  else
+  {
+    VMOVD_xmm(coords, first);
+    VMOVD_xmm(temp, second);
+  }
+  VINSERTI128(coords, coords, R(temp), 1);
+  VPSHUFB_ymm(coords, coords, MPIC(shuffle_lut[format][count_in - 1]));
+
+  // Sign-extend.
+  if (format == FORMAT_BYTE)
+    VPSRAD_ymm(coords, coords, 24);
+  if (format == FORMAT_SHORT)
+    VPSRAD_ymm(coords, coords, 16);
+
+  if (format != FORMAT_FLOAT)
+  {
+    VCVTDQ2PS_ymm(coords, R(coords));
+
+    if (dequantize)
+      VMULPS_ymm(coords, coords, MPIC(scale_factors[scale_index]));
+  }
+
+  StoreVertexPair(coords, count_out, native_format, 0);
+  return load_bytes;
+}
+
+void VertexLoaderX64::StoreVertexPair(X64Reg coords, int count_out, const AttributeFormat& native_format, int vertex)
+{
+  OpArg dest = MDisp(dst_reg, native_format.offset + vertex * m_native_stride);
+  if (vertex)
+  {
+    if (count_out == 3)
+    {
+      VEXTRACTI128(dest, coords, 1);
+      return;
+    }
+    VEXTRACTI128(R(XMM15), coords, 1);
+    coords = XMM15;
+  }
+
+  switch (count_out)
+  {
+  case 1: VMOVSS(dest, coords); break;
+  case 2: VMOVLPS(dest, coords); break;
+  case 3: VMOVUPS(dest, coords); break;
+  }
+}
+
+void VertexLoaderX64::GenerateVertexPairLoader(const u8* single_vertex)
+{
+  // Walks the attributes in the same order as GenerateVertexLoader, whose native vertex
+  // declaration gives the offsets to write to. Only VEX-encoded instructions may be used here,
+  // mixing in SSE ones while the upper lanes are in use is slow.
+  m_src_ofs = 0;
+  if (m_VtxDesc.PosMatIdx)
+  {
+    m_src_ofs++;
+  }
+
+  u32 texmatidx_ofs[8];
+  const u64 tm[8] = {
+      m_VtxDesc.Tex0MatIdx, m_VtxDesc.Tex1MatIdx, m_VtxDesc.Tex2MatIdx, m_VtxDesc.Tex3MatIdx,
+      m_VtxDesc.Tex4MatIdx, m_VtxDesc.Tex5MatIdx, m_VtxDesc.Tex6MatIdx, m_VtxDesc.Tex7MatIdx,
+  };
+  for (int i = 0; i < 8; i++)
+  {
+    if (tm[i])
+      texmatidx_ofs[i] = m_src_ofs++;
+  }
+
+  const u8* loop_start = GetCodePtr();
+  CMP(32, R(count_reg), Imm8(2));
+  J_CC(CC_B, single_vertex);
+  if (m_VtxDesc.Position & MASKINDEXED)
+  {
+    int bits = m_VtxDesc.Position == INDEX8 ? 8 : 16;
+    CMP(bits, MDisp(src_reg, m_src_ofs), Imm8(-1));
+    J_CC(CC_E, single_vertex);
+    CMP(bits, MDisp(src_reg, m_src_ofs + m_VertexSize), Imm8(-1));
+    J_CC(CC_E, single_vertex);
+  }
+
+  // The first vertex is written while the attributes of both are read, each of the position,
+  // normals and texture coordinates into its own YMM register. The second vertex is only written
+  // afterwards from the upper lanes, as the stores are much faster when the ones to the same cache
+  // lines follow each other.
+  const int normals = m_VtxDesc.Normal ? (m_VtxAttr.NormalElements ? 3 : 1) : 0;
+  const X64Reg position_reg = YMM0;
+  const X64Reg normal_reg = YMM1;
+  const X64Reg texcoord_reg = (X64Reg)(YMM1 + normals);
+
+  OpArg first, second;
+  GetVertexPairAddr(ARRAY_POSITION, m_VtxDesc.Position, &first, &second);
+  ReadVertexPair(first, second, m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements + 2, 3,
+    m_VtxAttr.ByteDequant, 0, m_native_vtx_decl.position, position_reg);
+
+  for (int i = 0; i < normals; i++)
+  {
+    if (!i || (m_VtxAttr.NormalIndex3 && (m_VtxDesc.Normal & MASKINDEXED)))
+    {
+      GetVertexPairAddr(ARRAY_NORMAL, m_VtxDesc.Normal, &first, &second);
+      int elem_size = 1 << (m_VtxAttr.NormalFormat / 2);
+      first.AddMemOffset(i * elem_size * 3);
+      second.AddMemOffset(i * elem_size * 3);
+    }
+    int load_bytes = ReadVertexPair(first, second, m_VtxDesc.Normal, m_VtxAttr.NormalFormat, 3, 3,
+      true, m_VtxAttr.NormalFormat + 1, m_native_vtx_decl.normals[i], (X64Reg)(normal_reg + i));
+    first.AddMemOffset(load_bytes);
+    second.AddMemOffset(load_bytes);
+  }
+
+  // Colors don't touch the vector registers, so they are read one vertex at a time.
+  const u64 col[2] = { m_VtxDesc.Color0, m_VtxDesc.Color1 };
+  u32 color_ofs[2];
+  for (int i = 0; i < 2; i++)
+  {
+    if (col[i])
+    {
+      color_ofs[i] = m_src_ofs;
+      m_dst_ofs = m_native_vtx_decl.colors[i].offset;
+      OpArg data = GetVertexAddr(ARRAY_COLOR + i, col[i]);
+      ReadColor(data, col[i], m_VtxAttr.color[i].Comp);
+    }
+  }
+
+  const u64 tc[8] = {
+      m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord, m_VtxDesc.Tex3Coord,
+      m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord, m_VtxDesc.Tex6Coord, m_VtxDesc.Tex7Coord,
+  };
+  const auto write_texmtx = [&](int i, int vertex) {
+    u32 dst_ofs = m_native_vtx_decl.texcoords[i].offset + vertex * m_native_stride;
+    MOVZX(64, 8, scratch1, MDisp(src_reg, texmatidx_ofs[i] + vertex * m_VertexSize));
+    VCVTSI2SS(XMM15, XMM15, R(scratch1));
+    if (!tc[i])
+    {
+      MOV(32, MDisp(dst_reg, dst_ofs), Imm32(0));
+      MOV(32, MDisp(dst_reg, dst_ofs + sizeof(float)), Imm32(0));
+    }
+    VMOVSS(MDisp(dst_reg, dst_ofs + sizeof(float) * 2), XMM15);
+  };
+  X64Reg reg = texcoord_reg;
+  for (int i = 0; i < 8; i++)
+  {
+    int elements = m_VtxAttr.texCoord[i].Elements + 1;
+    if (tc[i])
+    {
+      GetVertexPairAddr(ARRAY_TEXCOORD0 + i, tc[i], &first, &second);
+      ReadVertexPair(first, second, tc[i], m_VtxAttr.texCoord[i].Format, elements, tm[i] ? 2 : elements,
+        m_VtxAttr.ByteDequant, 5 + i, m_native_vtx_decl.texcoords[i], reg);
+      reg = (X64Reg)(reg + 1);
+    }
+    if (tm[i])
+      write_texmtx(i, 0);
+  }
+
+  const auto write_posmtx = [&](int vertex) {
+    if (m_VtxDesc.PosMatIdx)
+    {
+      MOVZX(32, 8, scratch1, MDisp(src_reg, vertex * m_VertexSize));
+    }
+    else
+    {
+      MOV(32, R(scratch1), MPIC(&g_main_cp_state.matrix_index_a));
+    }
+    AND(32, R(scratch1), Imm8(0x3F));
+    MOV(32, MDisp(dst_reg, m_native_vtx_decl.posmtx.offset + vertex * m_native_stride), R(scratch1));
+  };
+  write_posmtx(0);
+
+  // And now the second vertex, from the top.
+  StoreVertexPair(position_reg, 3, m_native_vtx_decl.position, 1);
+  for (int i = 0; i < normals; i++)
+    StoreVertexPair((X64Reg)(normal_reg + i), 3, m_native_vtx_decl.normals[i], 1);
+
+  u32 src_ofs = m_src_ofs;
+  for (int i = 0; i < 2; i++)
+  {
+    if (col[i])
+    {
+      m_src_ofs = color_ofs[i] + m_VertexSize;
+      m_dst_ofs = m_native_vtx_decl.colors[i].offset + m_native_stride;
+      OpArg data = GetVertexAddr(ARRAY_COLOR + i, col[i]);
+      ReadColor(data, col[i], m_VtxAttr.color[i].Comp);
+    }
+  }
+  m_src_ofs = src_ofs;
+
+  reg = texcoord_reg;
+  for (int i = 0; i < 8; i++)
+  {
+    int elements = m_VtxAttr.texCoord[i].Elements + 1;
+    if (tc[i])
+    {
+      StoreVertexPair(reg, tm[i] ? 2 : elements, m_native_vtx_decl.texcoords[i], 1);
+      reg = (X64Reg)(reg + 1);
+    }
+    if (tm[i])
+      write_texmtx(i, 1);
+  }
+
+  write_posmtx(1);
+
+  ADD(64, R(dst_reg), Imm32(m_native_stride * 2));
+  ADD(64, R(src_reg), Imm32(m_VertexSize * 2));
+
+  SUB(32, R(count_reg), Imm8(2));
+  J_CC(CC_NZ, loop_start);
 }
 
 bool VertexLoaderX64::EnvironmentIsSupported()
@@ -560,17 +845,17 @@ bool VertexLoaderX64::EnvironmentIsSupported()
 int VertexLoaderX64::RunVertices(const VertexLoaderParameters &parameters)
 {
   const VAT &vat = *parameters.VtxAttr;
-  scale_factors[0] = _mm_set_ps1(fractionTable[vat.g0.PosFrac]);
+  SetScaleFactor(0, fractionTable[vat.g0.PosFrac]);
   if (m_native_components & VB_HAS_UVALL)
   {
-    scale_factors[5] = _mm_set_ps1(fractionTable[vat.g0.Tex0Frac]);
-    scale_factors[6] = _mm_set_ps1(fractionTable[vat.g1.Tex1Frac]);
-    scale_factors[7] = _mm_set_ps1(fractionTable[vat.g1.Tex2Frac]);
-    scale_factors[8] = _mm_set_ps1(fractionTable[vat.g1.Tex3Frac]);
-    scale_factors[9] = _mm_set_ps1(fractionTable[vat.g2.Tex4Frac]);
-    scale_factors[10] = _mm_set_ps1(fractionTable[vat.g2.Tex5Frac]);
-    scale_factors[11] = _mm_set_ps1(fractionTable[vat.g2.Tex6Frac]);
-    scale_factors[12] = _mm_set_ps1(fractionTable[vat.g2.Tex7Frac]);
+    SetScaleFactor(5, fractionTable[vat.g0.Tex0Frac]);
+    SetScaleFactor(6, fractionTable[vat.g1.Tex1Frac]);
+    SetScaleFactor(7, fractionTable[vat.g1.Tex2Frac]);
+    SetScaleFactor(8, fractionTable[vat.g1.Tex3Frac]);
+    SetScaleFactor(9, fractionTable[vat.g2.Tex4Frac]);
+    SetScaleFactor(10, fractionTable[vat.g2.Tex5Frac]);
+    SetScaleFactor(11, fractionTable[vat.g2.Tex6Frac]);
+    SetScaleFactor(12, fractionTable[vat.g2.Tex7Frac]);
   }
   m_numLoadedVertices += parameters.count;
   return ((int(*)(const u8* src, u8* dst, int count, const void*))region)(parameters.source, parameters.destination, parameters.count, memory_base_ptr);
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "Common/x64Emitter.h"
 #include "VideoCommon/VertexLoaderBase.h"
 
@@ -13,6 +15,11 @@ protected:
   }
   int RunVertices(const VertexLoaderParameters &parameters) override;
   bool EnvironmentIsSupported() override;
+  // Loads a vertex in about the time it takes to look one up
+  bool WantsDeduplication() override
+  {
+    return false;
+  }
 private:
   u32 m_src_ofs = 0;
   u32 m_dst_ofs = 0;
@@ -21,4 +28,10 @@ private:
   int ReadVertex(Gen::OpArg data, u64 attribute, int format, int count_in, int count_out, bool dequantize, AttributeFormat* native_format, Gen::X64Reg scaling_register);
   void ReadColor(Gen::OpArg data, u64 attribute, int format);
   void GenerateVertexLoader();
+
+  // AVX2: two vertices per iteration, in the upper and lower lanes of the YMM registers
+  void GetVertexPairAddr(int array, u64 attribute, Gen::OpArg* first, Gen::OpArg* second);
+  int ReadVertexPair(Gen::OpArg first, Gen::OpArg second, u64 attribute, int format, int count_in, int count_out, bool dequantize, int scale_index, const AttributeFormat& native_format, Gen::X64Reg coords);
+  void StoreVertexPair(Gen::X64Reg coords, int count_out, const AttributeFormat& native_format, int vertex);
+  void GenerateVertexPairLoader(const u8* single_vertex);
 };
@@ -19,8 +19,12 @@
 
 static const char* texOffsetMemberSelector[] = {"x", "y", "z", "w"};
 
-void GetVertexShaderUID(VertexShaderUid& out, u32 components, const XFMemory& xfr,
-                        const BPMemory& bpm)
+// The last UID computed from xfmem, see GetVertexShaderUID
+static VertexShaderUid s_cached_uid;
+static u32 s_cached_uid_components;
+static bool s_cached_uid_valid = false;
+
+static void ComputeVertexShaderUID(VertexShaderUid& out, u32 components, const XFMemory& xfr)
 {
   out.ClearUID();
   vertex_shader_uid_data& uid_data = out.GetUidData<vertex_shader_uid_data>();
@@ -85,6 +89,30 @@ void GetVertexShaderUID(VertexShaderUid& out, u32 components, const XFMemory& xf
   out.CalculateUIDHash();
 }
 
+void GetVertexShaderUID(VertexShaderUid& out, u32 components, const XFMemory& xfr,
+                        const BPMemory& bpm)
+{
+  // The shader cache precompiles from its own copy of the registers, which isn't tracked
+  if (&xfr != &xfmem)
+  {
+    ComputeVertexShaderUID(out, components, xfr);
+    return;
+  }
+
+  if (!s_cached_uid_valid || s_cached_uid_components != components)
+  {
+    ComputeVertexShaderUID(s_cached_uid, components, xfr);
+    s_cached_uid_components = components;
+    s_cached_uid_valid = true;
+  }
+  out = s_cached_uid;
+}
+
+void InvalidateVertexShaderUID()
+{
+  s_cached_uid_valid = false;
+}
+
 inline void GenerateVertexShader(ShaderCode& out, API_TYPE api_type,
                                  const vertex_shader_uid_data& uid_data, bool use_integer_math,
                                  const ShaderHostConfig& hostconfig)
@@ -132,5 +132,7 @@ struct vertex_shader_uid_data
 typedef ShaderUid<vertex_shader_uid_data> VertexShaderUid;
 
 void GetVertexShaderUID(VertexShaderUid& object, u32 components, const XFMemory &xfr, const BPMemory &bpm);
+// Like InvalidatePixelShaderUID, for the XF registers the vertex shader UID is made from.
+void InvalidateVertexShaderUID();
 
 void GenerateVertexShaderCode(ShaderCode& object, const vertex_shader_uid_data& uid_data, const ShaderHostConfig& hostconfig);
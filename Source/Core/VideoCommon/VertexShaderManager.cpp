@@ -2,8 +2,12 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 #include <cmath>
+#include <cstring>
 #include <sstream>
 #include <float.h>
+#ifdef _M_X86
+#include <emmintrin.h>
+#endif
 
 #include "Common/Common.h"
 #include "Common/MathUtil.h"
@@ -191,6 +195,7 @@ void VertexShaderManager::Init()
   Dirty();
   m_buffer.Clear();
   memset(&xfmem, 0, sizeof(xfmem));
+  InvalidateVertexShaderUID();
   ResetView();
 
   // TODO: should these go inside ResetView()?
@@ -251,6 +256,76 @@ void VertexShaderManager::Dirty()
   memset(s_lights_phong, 0, sizeof(s_lights_phong));
 }
 
+// Writes the constants with SSE2. The fourth lane of the 3-component values is loaded from
+// whatever follows them in xfmem and masked off. Everything they are loaded from is followed by
+// more of xfmem, so the loads never leave it.
+#ifdef _M_X86
+static const __m128i s_xyz_mask = _mm_set_epi32(0, -1, -1, -1);
+
+static inline void WriteVec3(float* dst, const float* src)
+{
+  _mm_storeu_ps(dst, _mm_and_ps(_mm_loadu_ps(src), _mm_castsi128_ps(s_xyz_mask)));
+}
+
+// The bytes of the u32 in reverse order, as floats
+static inline void WriteColor(float* dst, u32 color)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i c = _mm_unpacklo_epi8(_mm_cvtsi32_si128(color), zero);
+  c = _mm_unpacklo_epi16(c, zero);
+  c = _mm_shuffle_epi32(c, _MM_SHUFFLE(0, 1, 2, 3));
+  _mm_storeu_ps(dst, _mm_cvtepi32_ps(c));
+}
+#else
+static inline void WriteVec3(float* dst, const float* src)
+{
+  dst[0] = src[0];
+  dst[1] = src[1];
+  dst[2] = src[2];
+  dst[3] = 0.0f;
+}
+
+static inline void WriteColor(float* dst, u32 color)
+{
+  dst[0] = float((color >> 24) & 0xFF);
+  dst[1] = float((color >> 16) & 0xFF);
+  dst[2] = float((color >> 8) & 0xFF);
+  dst[3] = float(color & 0xFF);
+}
+#endif
+
+static void WriteLight(float* dst, const Light& light)
+{
+  // xfmem.light.color is packed as abgr in u8[4], so we have to swap the order
+  u32 color;
+  std::memcpy(&color, light.color, sizeof(color));
+  WriteColor(dst, color);
+  WriteVec3(dst + 4, light.cosatt);
+  WriteVec3(dst + 8, light.distatt);
+  // dist attenuation, make sure not equal to 0!!!
+  if (fabs(light.distatt[0]) < 0.00001f && fabs(light.distatt[1]) < 0.00001f &&
+      fabs(light.distatt[2]) < 0.00001f)
+  {
+    dst[8] = 0.00001f;
+  }
+  WriteVec3(dst + 12, light.dpos);
+
+  double norm = double(light.ddir[0]) * double(light.ddir[0]) +
+    double(light.ddir[1]) * double(light.ddir[1]) +
+    double(light.ddir[2]) * double(light.ddir[2]);
+  norm = 1.0 / sqrt(norm);
+  const float norm_float = static_cast<float>(norm);
+#ifdef _M_X86
+  const __m128 ddir = _mm_and_ps(_mm_loadu_ps(light.ddir), _mm_castsi128_ps(s_xyz_mask));
+  _mm_storeu_ps(dst + 16, _mm_mul_ps(ddir, _mm_set1_ps(norm_float)));
+#else
+  dst[16] = light.ddir[0] * norm_float;
+  dst[17] = light.ddir[1] * norm_float;
+  dst[18] = light.ddir[2] * norm_float;
+  dst[19] = 0.0f;
+#endif
+}
+
 // Syncs the shader constant buffers with xfmem
 // TODO: A cleaner way to control the matrices without making a mess in the parameters field
 void VertexShaderManager::SetConstants()
@@ -300,7 +375,9 @@ void VertexShaderManager::SetConstants()
     int startn = s_normal_matrices_changed[0] / 3;
     int endn = (s_normal_matrices_changed[1] + 2) / 3;
     const float* pnstart = &xfmem.normalMatrices[3 * startn];
-    m_buffer.SetMultiConstant3v(C_NORMALMATRICES + startn, endn - startn, pnstart);
+    float* dst = m_buffer.GetBufferToUpdate<float>(C_NORMALMATRICES + startn, endn - startn);
+    for (int i = 0; i < endn - startn; ++i)
+      WriteVec3(dst + 4 * i, pnstart + 3 * i);
     s_normal_matrices_changed[0] = s_normal_matrices_changed[1] = -1;
   }
 
@@ -319,35 +396,10 @@ void VertexShaderManager::SetConstants()
     int istart = s_lights_changed[0] / 0x10;
     int iend = (s_lights_changed[1] + 15) / 0x10;
 
+    // All of the changed lights go out as one region, 5 constants each
+    float* dst = m_buffer.GetBufferToUpdate<float>(C_LIGHTS + 5 * istart, 5 * (iend - istart));
     for (int i = istart; i < iend; ++i)
-    {
-      const Light& light = xfmem.lights[i];
-      // xfmem.light.color is packed as abgr in u8[4], so we have to swap the order
-      m_buffer.SetConstant4<float>(C_LIGHTS + 5 * i,
-        float(light.color[3]),
-        float(light.color[2]),
-        float(light.color[1]),
-        float(light.color[0]));
-      m_buffer.SetConstant3v(C_LIGHTS + 5 * i + 1, light.cosatt);
-      if (fabs(light.distatt[0]) < 0.00001f &&
-        fabs(light.distatt[1]) < 0.00001f &&
-        fabs(light.distatt[2]) < 0.00001f)
-      {
-        // dist attenuation, make sure not equal to 0!!!
-        m_buffer.SetConstant4(C_LIGHTS + 5 * i + 2, 0.00001f, light.distatt[1], light.distatt[2], 0.0f);
-      }
-      else
-      {
-        m_buffer.SetConstant3v(C_LIGHTS + 5 * i + 2, light.distatt);
-      }
-      m_buffer.SetConstant3v(C_LIGHTS + 5 * i + 3, light.dpos);
-      double norm = double(light.ddir[0]) * double(light.ddir[0]) +
-        double(light.ddir[1]) * double(light.ddir[1]) +
-        double(light.ddir[2]) * double(light.ddir[2]);
-      norm = 1.0 / sqrt(norm);
-      float norm_float = static_cast<float>(norm);
-      m_buffer.SetConstant4(C_LIGHTS + 5 * i + 4, light.ddir[0] * norm_float, light.ddir[1] * norm_float, light.ddir[2] * norm_float, 0.0f);
-    }
+      WriteLight(dst + 20 * (i - istart), xfmem.lights[i]);
 
     s_lights_changed[0] = s_lights_changed[1] = -1;
   }
@@ -358,12 +410,7 @@ void VertexShaderManager::SetConstants()
     {
       if (s_materials_changed & (1 << i))
       {
-        u32 data = xfmem.ambColor[i];
-        m_buffer.SetConstant4<float>(C_MATERIALS + i,
-          float((data >> 24) & 0xFF),
-          float((data >> 16) & 0xFF),
-          float((data >> 8) & 0xFF),
-          float(data & 0xFF));
+        WriteColor(m_buffer.GetBufferToUpdate<float>(C_MATERIALS + i, 1), xfmem.ambColor[i]);
       }
     }
 
@@ -371,12 +418,7 @@ void VertexShaderManager::SetConstants()
     {
       if (s_materials_changed & (1 << (i + 2)))
       {
-        u32 data = xfmem.matColor[i];
-        m_buffer.SetConstant4<float>(C_MATERIALS + i + 2,
-          float((data >> 24) & 0xFF),
-          float((data >> 16) & 0xFF),
-          float((data >> 8) & 0xFF),
-          float(data & 0xFF));
+        WriteColor(m_buffer.GetBufferToUpdate<float>(C_MATERIALS + i + 2, 1), xfmem.matColor[i]);
       }
     }
 
@@ -13,7 +13,9 @@
 #include "Core/Core.h"
 #include "Core/Movie.h"
 #include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -28,6 +30,10 @@ void UpdateActiveConfig()
     Movie::SetGraphicsConfig();
   std::unique_lock<std::mutex> config_lock(config_mutex);
   g_ActiveConfig = g_Config;
+
+  // The shader UIDs depend on some of the settings
+  InvalidatePixelShaderUID();
+  InvalidateVertexShaderUID();
 }
 void VideoConfig::ClearFormats()
 {
@@ -103,7 +109,10 @@ void VideoConfig::Refresh()
   bCacheHiresTextures = Config::Get(Config::GFX_CACHE_HIRES_TEXTURES);
   bWaitForCacheHiresTextures = Config::Get(Config::GFX_WAIT_CACHE_HIRES_TEXTURES);
   bDumpEFBTarget = Config::Get(Config::GFX_DUMP_EFB_TARGET);
+  iDumpPNGCompressionLevel = Config::Get(Config::GFX_DUMP_PNG_COMPRESSION_LEVEL);
   bDumpFramesAsImages = Config::Get(Config::GFX_DUMP_FRAMES_AS_IMAGES);
+  bDumpFramesRaw = Config::Get(Config::GFX_DUMP_FRAMES_RAW);
+  bDumpFramesRawCompression = Config::Get(Config::GFX_DUMP_FRAMES_RAW_COMPRESSION);
   bFreeLook = Config::Get(Config::GFX_FREE_LOOK);
   bCompileShaderOnStartup = Config::Get(Config::GFX_COMPILE_SHADERS_ON_STARTUP);
   bUseFFV1 = Config::Get(Config::GFX_USE_FFV1);
@@ -171,7 +171,11 @@ struct VideoConfig final
   bool bCacheHiresTextures;
   bool bWaitForCacheHiresTextures;
   bool bDumpEFBTarget;
+  // zlib level of dumped textures, from 0 (fastest) to 9 (smallest)
+  int iDumpPNGCompressionLevel;
   bool bDumpFramesAsImages;
+  bool bDumpFramesRaw;
+  bool bDumpFramesRawCompression;
   bool bUseFFV1;
   std::string sDumpCodec;
   std::string sDumpFormat;
@@ -11,9 +11,11 @@
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/TessellationShaderManager.h"
 #include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoState.h"
 #include "VideoCommon/XFMemory.h"
@@ -64,6 +66,10 @@ void VideoCommon_DoState(PointerWrap &p)
   BoundingBox::DoState(p);
   p.DoMarker("BoundingBox");
 
+  // The registers have been replaced without going through BPStructs and XFStructs
+  InvalidatePixelShaderUID();
+  InvalidateVertexShaderUID();
+
 
   // TODO: search for more data that should be saved and add it here
 }
\ No newline at end of file
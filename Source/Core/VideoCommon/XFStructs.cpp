@@ -14,7 +14,9 @@
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/XFMemory.h"
 #include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/OpcodeDecoding.h"
 
@@ -59,6 +61,8 @@ inline void XFRegWritten(int transferSize, u32 baseAddress)
       if (xfmem.numChan.numColorChans != (newValue & 3))
         g_vertex_manager->Flush();
       VertexShaderManager::SetLightingConfigChanged();
+      InvalidateVertexShaderUID();
+      InvalidatePixelShaderUID();
       break;
 
     case XFMEM_SETCHAN0_AMBCOLOR: // Channel Ambient Color
@@ -94,12 +98,15 @@ inline void XFRegWritten(int transferSize, u32 baseAddress)
       if (((u32*)&xfmem)[address - 0x1000] != (newValue & 0x7fff))
         g_vertex_manager->Flush();
       VertexShaderManager::SetLightingConfigChanged();
+      InvalidateVertexShaderUID();
+      InvalidatePixelShaderUID();
       break;
 
     case XFMEM_DUALTEX:
       if (xfmem.dualTexTrans.enabled != (newValue & 1))
         g_vertex_manager->Flush();
       VertexShaderManager::SetTexMatrixInfoChanged(-1);
+      InvalidateVertexShaderUID();
       break;
 
 
@@ -135,12 +142,16 @@ inline void XFRegWritten(int transferSize, u32 baseAddress)
       g_vertex_manager->Flush();
       VertexShaderManager::SetProjectionChanged();
       GeometryShaderManager::SetProjectionChanged();
+      // Forced lighting depends on the projection type
+      InvalidateVertexShaderUID();
+      InvalidatePixelShaderUID();
       nextAddress = XFMEM_SETPROJECTION + 7;
       break;
 
     case XFMEM_SETNUMTEXGENS: // GXSetNumTexGens
       if (xfmem.numTexGen.numTexGens != (newValue & 15))
         g_vertex_manager->Flush();
+      InvalidateVertexShaderUID();
       break;
 
     case XFMEM_SETTEXMTXINFO:
@@ -153,6 +164,7 @@ inline void XFRegWritten(int transferSize, u32 baseAddress)
     case XFMEM_SETTEXMTXINFO + 7:
       g_vertex_manager->Flush();
       VertexShaderManager::SetTexMatrixInfoChanged(address - XFMEM_SETTEXMTXINFO);
+      InvalidateVertexShaderUID();
       nextAddress = XFMEM_SETTEXMTXINFO + 8;
       break;
 
@@ -166,6 +178,7 @@ inline void XFRegWritten(int transferSize, u32 baseAddress)
     case XFMEM_SETPOSMTXINFO + 7:
       g_vertex_manager->Flush();
       VertexShaderManager::SetTexMatrixInfoChanged(address - XFMEM_SETPOSMTXINFO);
+      InvalidateVertexShaderUID();
       nextAddress = XFMEM_SETPOSMTXINFO + 8;
       break;
 
@@ -1515,6 +1515,394 @@ HostTextureFormat GetHostTextureFormat(u32 texformat, TlutFormat tlutfmt, bool c
   return fmt;
 }
 
+// AVX2 decoders, only used when cpu_info.bAVX2 is set. Every one of them decodes a whole texture
+// and produces exactly the same output as the SSE and C paths.
+
+// Lanes hold a big-endian 16-bit value in their low half
+FUNCTION_TARGET_AVX2
+static inline __m256i Swap16_AVX2(__m256i val)
+{
+  const __m256i mask = _mm256_setr_epi8(1, 0, -128, -128, 5, 4, -128, -128, 9, 8, -128, -128, 13,
+                                        12, -128, -128, 1, 0, -128, -128, 5, 4, -128, -128, 9, 8,
+                                        -128, -128, 13, 12, -128, -128);
+  return _mm256_shuffle_epi8(val, mask);
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i PackColor_AVX2(__m256i r, __m256i g, __m256i b, __m256i a, bool bgra)
+{
+  const __m256i ga = _mm256_or_si256(_mm256_slli_epi32(g, 8), _mm256_slli_epi32(a, 24));
+  if (bgra)
+    return _mm256_or_si256(_mm256_or_si256(b, _mm256_slli_epi32(r, 16)), ga);
+  return _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(b, 16)), ga);
+}
+
+// Same as decode5A3RGBA (or decode5A3 if bgra is set) on 8 values
+FUNCTION_TARGET_AVX2
+static inline __m256i Decode5A3_AVX2(__m256i val, bool bgra)
+{
+  const __m256i mask_x1f = _mm256_set1_epi32(0x1f);
+  const __m256i mask_x0f = _mm256_set1_epi32(0x0f);
+
+  // Both encodings are decoded, then each pixel picks its own
+  __m256i r = _mm256_and_si256(_mm256_srli_epi32(val, 10), mask_x1f);
+  __m256i g = _mm256_and_si256(_mm256_srli_epi32(val, 5), mask_x1f);
+  __m256i b = _mm256_and_si256(val, mask_x1f);
+  r = _mm256_or_si256(_mm256_slli_epi32(r, 3), _mm256_srli_epi32(r, 2));
+  g = _mm256_or_si256(_mm256_slli_epi32(g, 3), _mm256_srli_epi32(g, 2));
+  b = _mm256_or_si256(_mm256_slli_epi32(b, 3), _mm256_srli_epi32(b, 2));
+  const __m256i rgb555 = PackColor_AVX2(r, g, b, _mm256_set1_epi32(0xFF), bgra);
+
+  r = _mm256_and_si256(_mm256_srli_epi32(val, 8), mask_x0f);
+  g = _mm256_and_si256(_mm256_srli_epi32(val, 4), mask_x0f);
+  b = _mm256_and_si256(val, mask_x0f);
+  __m256i a = _mm256_and_si256(_mm256_srli_epi32(val, 12), _mm256_set1_epi32(0x07));
+  r = _mm256_or_si256(_mm256_slli_epi32(r, 4), r);
+  g = _mm256_or_si256(_mm256_slli_epi32(g, 4), g);
+  b = _mm256_or_si256(_mm256_slli_epi32(b, 4), b);
+  a = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(a, 5), _mm256_slli_epi32(a, 2)),
+                      _mm256_srli_epi32(a, 1));
+  const __m256i rgb4a3 = PackColor_AVX2(r, g, b, a, bgra);
+
+  const __m256i msb = _mm256_set1_epi32(0x8000);
+  const __m256i is_rgb555 = _mm256_cmpeq_epi32(_mm256_and_si256(val, msb), msb);
+  return _mm256_blendv_epi8(rgb4a3, rgb555, is_rgb555);
+}
+
+// Same as decode565RGBA on 8 values
+FUNCTION_TARGET_AVX2
+static inline __m256i Decode565RGBA_AVX2(__m256i val)
+{
+  __m256i r = _mm256_and_si256(_mm256_srli_epi32(val, 11), _mm256_set1_epi32(0x1f));
+  __m256i g = _mm256_and_si256(_mm256_srli_epi32(val, 5), _mm256_set1_epi32(0x3f));
+  __m256i b = _mm256_and_si256(val, _mm256_set1_epi32(0x1f));
+  r = _mm256_or_si256(_mm256_slli_epi32(r, 3), _mm256_srli_epi32(r, 2));
+  g = _mm256_or_si256(_mm256_slli_epi32(g, 2), _mm256_srli_epi32(g, 4));
+  b = _mm256_or_si256(_mm256_slli_epi32(b, 3), _mm256_srli_epi32(b, 2));
+  return PackColor_AVX2(r, g, b, _mm256_set1_epi32(0xFF), false);
+}
+
+// Same as decodeIA8Swapped on 8 values: (0 0 I A) -> (A I I I)
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeIA8Swapped_AVX2(__m256i val)
+{
+  const __m256i mask = _mm256_setr_epi8(1, 1, 1, 0, 5, 5, 5, 4, 9, 9, 9, 8, 13, 13, 13, 12, 1, 1,
+                                        1, 0, 5, 5, 5, 4, 9, 9, 9, 8, 13, 13, 13, 12);
+  return _mm256_shuffle_epi8(val, mask);
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodePalette_AVX2(const u16* tlut, __m256i indices, TlutFormat tlutfmt)
+{
+  // Every gather also reads the entry after the one it wants. That's harmless: TLUTs are at most
+  // at 0x7FE00 + 2 * 0x3FFF in TMEM, far from its end.
+  const __m256i val = _mm256_i32gather_epi32(reinterpret_cast<const int*>(tlut), indices, 2);
+  switch (tlutfmt)
+  {
+  case GX_TL_IA8:
+    return DecodeIA8Swapped_AVX2(val);
+  case GX_TL_RGB565:
+    return Decode565RGBA_AVX2(Swap16_AVX2(val));
+  default:
+    return Decode5A3_AVX2(Swap16_AVX2(val), false);
+  }
+}
+
+// The 4x4 block formats are decoded two rows at a time
+FUNCTION_TARGET_AVX2
+static inline void StoreTwoRows_AVX2(u32* dst, u32 width, __m256i rows)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm256_castsi256_si128(rows));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + width), _mm256_extracti128_si256(rows, 1));
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeC4_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height, u32 tlutaddr,
+                               TlutFormat tlutfmt)
+{
+  const u16* tlut = reinterpret_cast<const u16*>(texMem + tlutaddr);
+  const u32 Wsteps8 = (width + 7) / 8;
+  // Each byte holds two indices, high nibble first
+  const __m256i shifts = _mm256_setr_epi32(4, 0, 4, 0, 4, 0, 4, 0);
+  const __m256i mask = _mm256_set1_epi32(0x0f);
+  for (u32 y = 0; y < height; y += 8)
+    for (u32 x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+      for (u32 iy = 0, xStep = 8 * yStep; iy < 8; iy++, xStep++)
+      {
+        const __m128i bytes = _mm_cvtsi32_si128(*reinterpret_cast<const s32*>(src + 4 * xStep));
+        const __m256i doubled = _mm256_cvtepu8_epi32(_mm_unpacklo_epi8(bytes, bytes));
+        const __m256i indices = _mm256_and_si256(_mm256_srlv_epi32(doubled, shifts), mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (y + iy) * width + x),
+                            DecodePalette_AVX2(tlut, indices, tlutfmt));
+      }
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeC8_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height, u32 tlutaddr,
+                               TlutFormat tlutfmt)
+{
+  const u16* tlut = reinterpret_cast<const u16*>(texMem + tlutaddr);
+  const u32 Wsteps8 = (width + 7) / 8;
+  for (u32 y = 0; y < height; y += 4)
+    for (u32 x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+      for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+      {
+        const __m256i indices = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 8 * xStep)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (y + iy) * width + x),
+                            DecodePalette_AVX2(tlut, indices, tlutfmt));
+      }
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeC14X2_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height, u32 tlutaddr,
+                                  TlutFormat tlutfmt)
+{
+  const u16* tlut = reinterpret_cast<const u16*>(texMem + tlutaddr);
+  const u32 Wsteps4 = (width + 3) / 4;
+  const __m256i mask = _mm256_set1_epi32(0x3FFF);
+  for (u32 y = 0; y < height; y += 4)
+    for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+      for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+      {
+        const __m256i val = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8 * xStep)));
+        const __m256i indices = _mm256_and_si256(Swap16_AVX2(val), mask);
+        StoreTwoRows_AVX2(dst + (y + iy) * width + x, width,
+                          DecodePalette_AVX2(tlut, indices, tlutfmt));
+      }
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeIA8_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height)
+{
+  const u32 Wsteps4 = (width + 3) / 4;
+  for (u32 y = 0; y < height; y += 4)
+    for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+      for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+      {
+        const __m256i val = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8 * xStep)));
+        StoreTwoRows_AVX2(dst + (y + iy) * width + x, width, DecodeIA8Swapped_AVX2(val));
+      }
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeRGB565_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height)
+{
+  const u32 Wsteps4 = (width + 3) / 4;
+  for (u32 y = 0; y < height; y += 4)
+    for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+      for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+      {
+        const __m256i val = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8 * xStep)));
+        StoreTwoRows_AVX2(dst + (y + iy) * width + x, width,
+                          Decode565RGBA_AVX2(Swap16_AVX2(val)));
+      }
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeRGB5A3_AVX2(u32* dst, const u8* src, u32 width, u32 height, bool bgra)
+{
+  const u32 Wsteps4 = (width + 3) / 4;
+  for (u32 y = 0; y < height; y += 4)
+    for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+      for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+      {
+        const __m256i val = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8 * xStep)));
+        StoreTwoRows_AVX2(dst + (y + iy) * width + x, width,
+                          Decode5A3_AVX2(Swap16_AVX2(val), bgra));
+      }
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeRGBA8_AVX2(u32* dst, const u8* src, u32 width, u32 height, bool bgra)
+{
+  const u32 Wsteps4 = (width + 3) / 4;
+  // Interleaving the AR and GB halves of a block gives (A G R B) for every pixel
+  const __m256i mask = bgra ? _mm256_setr_epi8(3, 1, 2, 0, 7, 5, 6, 4, 11, 9, 10, 8, 15, 13, 14,
+                                               12, 3, 1, 2, 0, 7, 5, 6, 4, 11, 9, 10, 8, 15, 13,
+                                               14, 12) :
+                              _mm256_setr_epi8(2, 1, 3, 0, 6, 5, 7, 4, 10, 9, 11, 8, 14, 13, 15,
+                                               12, 2, 1, 3, 0, 6, 5, 7, 4, 10, 9, 11, 8, 14, 13,
+                                               15, 12);
+  for (u32 y = 0; y < height; y += 4)
+  {
+    u32 x = 0;
+    u32 yStep = (y / 4) * Wsteps4;
+    // Two blocks side by side make whole 8 pixel rows
+    for (; x + 8 <= width; x += 8, yStep += 2)
+    {
+      const u8* src2 = src + 64 * yStep;
+      const __m256i ar0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2));
+      const __m256i gb0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + 32));
+      const __m256i ar1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + 64));
+      const __m256i gb1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + 96));
+      // The low lanes hold rows 0 and 1, the high lanes rows 2 and 3
+      const __m256i rows02_0 = _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar0, gb0), mask);
+      const __m256i rows13_0 = _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar0, gb0), mask);
+      const __m256i rows02_1 = _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar1, gb1), mask);
+      const __m256i rows13_1 = _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar1, gb1), mask);
+
+      __m256i* dst2 = reinterpret_cast<__m256i*>(dst + y * width + x);
+      _mm256_storeu_si256(dst2, _mm256_permute2x128_si256(rows02_0, rows02_1, 0x20));
+      dst2 = reinterpret_cast<__m256i*>(dst + (y + 1) * width + x);
+      _mm256_storeu_si256(dst2, _mm256_permute2x128_si256(rows13_0, rows13_1, 0x20));
+      dst2 = reinterpret_cast<__m256i*>(dst + (y + 2) * width + x);
+      _mm256_storeu_si256(dst2, _mm256_permute2x128_si256(rows02_0, rows02_1, 0x31));
+      dst2 = reinterpret_cast<__m256i*>(dst + (y + 3) * width + x);
+      _mm256_storeu_si256(dst2, _mm256_permute2x128_si256(rows13_0, rows13_1, 0x31));
+    }
+    for (; x < width; x += 4, yStep++)
+    {
+      const u8* src2 = src + 64 * yStep;
+      const __m256i ar = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2));
+      const __m256i gb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src2 + 32));
+      const __m256i rows02 = _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar, gb), mask);
+      const __m256i rows13 = _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar, gb), mask);
+
+      u32* dst2 = dst + y * width + x;
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst2), _mm256_castsi256_si128(rows02));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst2 + width), _mm256_castsi256_si128(rows13));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst2 + 2 * width),
+                       _mm256_extracti128_si256(rows02, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst2 + 3 * width),
+                       _mm256_extracti128_si256(rows13, 1));
+    }
+  }
+}
+
+// One channel of the color tables of two DXT blocks: lanes 0-3 are the four colors of the first
+// block, lanes 4-7 those of the second. Each channel of the interpolated colors wraps around on
+// its own, like in the SSE2 CMPR decoder.
+FUNCTION_TARGET_AVX2
+static inline __m256i GetDXTChannel_AVX2(__m256i v1, __m256i v2, __m256i interpolate)
+{
+  const __m256i lane0 = _mm256_setr_epi32(-1, 0, 0, 0, -1, 0, 0, 0);
+  const __m256i lane2 = _mm256_setr_epi32(0, 0, -1, 0, 0, 0, -1, 0);
+  const __m256i lane3 = _mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1);
+
+  // (v1, v2, v1 + d, v2 - d) with d ~= (v2 - v1) / 3
+  const __m256i base = _mm256_blendv_epi8(v2, v1, _mm256_or_si256(lane0, lane2));
+  const __m256i diff = _mm256_sub_epi32(v2, v1);
+  const __m256i third = _mm256_sub_epi32(_mm256_srai_epi32(diff, 1), _mm256_srai_epi32(diff, 3));
+  const __m256i interpolated = _mm256_and_si256(
+      _mm256_sub_epi32(_mm256_add_epi32(base, _mm256_and_si256(third, lane2)),
+                       _mm256_and_si256(third, lane3)),
+      _mm256_set1_epi32(0xFF));
+
+  // (v1, v2, (v1 + v2) / 2, v2)
+  const __m256i average =
+      _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(v1, v2), _mm256_set1_epi32(1)), 1);
+  const __m256i averaged = _mm256_blendv_epi8(base, average, lane2);
+
+  return _mm256_blendv_epi8(averaged, interpolated, interpolate);
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i GetDXTColorsRGBA_AVX2(const DXT1Block* blocks)
+{
+  const s32 a1 = Common::swap16(blocks[0].color1);
+  const s32 a2 = Common::swap16(blocks[0].color2);
+  const s32 b1 = Common::swap16(blocks[1].color1);
+  const s32 b2 = Common::swap16(blocks[1].color2);
+  const __m256i c1 = _mm256_setr_epi32(a1, a1, a1, a1, b1, b1, b1, b1);
+  const __m256i c2 = _mm256_setr_epi32(a2, a2, a2, a2, b2, b2, b2, b2);
+  const __m256i interpolate = _mm256_cmpgt_epi32(c1, c2);
+
+  const __m256i mask_x1f = _mm256_set1_epi32(0x1f);
+  const __m256i mask_x3f = _mm256_set1_epi32(0x3f);
+  __m256i r1 = _mm256_and_si256(_mm256_srli_epi32(c1, 11), mask_x1f);
+  __m256i r2 = _mm256_and_si256(_mm256_srli_epi32(c2, 11), mask_x1f);
+  __m256i g1 = _mm256_and_si256(_mm256_srli_epi32(c1, 5), mask_x3f);
+  __m256i g2 = _mm256_and_si256(_mm256_srli_epi32(c2, 5), mask_x3f);
+  __m256i b1v = _mm256_and_si256(c1, mask_x1f);
+  __m256i b2v = _mm256_and_si256(c2, mask_x1f);
+  r1 = _mm256_or_si256(_mm256_slli_epi32(r1, 3), _mm256_srli_epi32(r1, 2));
+  r2 = _mm256_or_si256(_mm256_slli_epi32(r2, 3), _mm256_srli_epi32(r2, 2));
+  g1 = _mm256_or_si256(_mm256_slli_epi32(g1, 2), _mm256_srli_epi32(g1, 4));
+  g2 = _mm256_or_si256(_mm256_slli_epi32(g2, 2), _mm256_srli_epi32(g2, 4));
+  b1v = _mm256_or_si256(_mm256_slli_epi32(b1v, 3), _mm256_srli_epi32(b1v, 2));
+  b2v = _mm256_or_si256(_mm256_slli_epi32(b2v, 3), _mm256_srli_epi32(b2v, 2));
+
+  const __m256i r = GetDXTChannel_AVX2(r1, r2, interpolate);
+  const __m256i g = GetDXTChannel_AVX2(g1, g2, interpolate);
+  const __m256i b = GetDXTChannel_AVX2(b1v, b2v, interpolate);
+  // The fourth color is transparent when it isn't interpolated
+  const __m256i lane3 = _mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1);
+  const __m256i a = _mm256_andnot_si256(_mm256_andnot_si256(interpolate, lane3),
+                                        _mm256_set1_epi32(0xFF));
+  return PackColor_AVX2(r, g, b, a, false);
+}
+
+FUNCTION_TARGET_AVX2
+static void DecodeCMPR_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height)
+{
+  const u32 Wsteps8 = (width + 7) / 8;
+  const __m256i shifts = _mm256_setr_epi32(6, 4, 2, 0, 6, 4, 2, 0);
+  const __m256i mask = _mm256_set1_epi32(3);
+  const __m256i second_block = _mm256_setr_epi32(0, 0, 0, 0, 4, 4, 4, 4);
+  for (u32 y = 0; y < height; y += 8)
+    for (u32 x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+      for (u32 z = 0, xStep = 2 * yStep; z < 2; ++z, xStep++)
+      {
+        // Two blocks side by side share one 8-entry color table, so that each row of 8 pixels
+        // is a single permute.
+        const DXT1Block* blocks = reinterpret_cast<const DXT1Block*>(src) + 2 * xStep;
+        const __m256i table = GetDXTColorsRGBA_AVX2(blocks);
+
+        u32* dst2 = dst + (y + z * 4) * width + x;
+        for (u32 iy = 0; iy < 4; iy++)
+        {
+          const s32 sel0 = blocks[0].lines[iy];
+          const s32 sel1 = blocks[1].lines[iy];
+          const __m256i selectors =
+              _mm256_setr_epi32(sel0, sel0, sel0, sel0, sel1, sel1, sel1, sel1);
+          const __m256i indices = _mm256_add_epi32(
+              _mm256_and_si256(_mm256_srlv_epi32(selectors, shifts), mask), second_block);
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst2 + iy * width),
+                              _mm256_permutevar8x32_epi32(table, indices));
+        }
+      }
+}
+
+// Returns false for the formats that have no AVX2 decoder
+static bool Decode_RGBA_AVX2(u32* dst, const u8* src, u32 width, u32 height, u32 texformat,
+                             u32 tlutaddr, TlutFormat tlutfmt)
+{
+  switch (texformat)
+  {
+  case GX_TF_C4:
+    DecodeC4_RGBA_AVX2(dst, src, width, height, tlutaddr, tlutfmt);
+    return true;
+  case GX_TF_C8:
+    DecodeC8_RGBA_AVX2(dst, src, width, height, tlutaddr, tlutfmt);
+    return true;
+  case GX_TF_C14X2:
+    DecodeC14X2_RGBA_AVX2(dst, src, width, height, tlutaddr, tlutfmt);
+    return true;
+  case GX_TF_IA8:
+    DecodeIA8_RGBA_AVX2(dst, src, width, height);
+    return true;
+  case GX_TF_RGB565:
+    DecodeRGB565_RGBA_AVX2(dst, src, width, height);
+    return true;
+  case GX_TF_RGB5A3:
+    DecodeRGB5A3_AVX2(dst, src, width, height, false);
+    return true;
+  case GX_TF_RGBA8:
+    DecodeRGBA8_AVX2(dst, src, width, height, false);
+    return true;
+  case GX_TF_CMPR:
+    DecodeCMPR_RGBA_AVX2(dst, src, width, height);
+    return true;
+  default:
+    return false;
+  }
+}
+
 //switch endianness, unswizzle
 static HostTextureFormat Decode_real(u8 *dst, const u8 *src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt, bool compressed_supported)
 {
@@ -1648,6 +2036,11 @@ static HostTextureFormat Decode_real(u8 *dst, const u8 *src, u32 width, u32 heig
   return PC_TEX_FMT_RGB565;
   case GX_TF_RGB5A3:
   {
+    if (cpu_info.bAVX2)
+    {
+      DecodeRGB5A3_AVX2((u32*)dst, src, width, height, true);
+      return PC_TEX_FMT_BGRA32;
+    }
     for (u32 y = 0; y < height; y += 4)
       for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
         for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
@@ -1657,6 +2050,11 @@ static HostTextureFormat Decode_real(u8 *dst, const u8 *src, u32 width, u32 heig
   return PC_TEX_FMT_BGRA32;
   case GX_TF_RGBA8:  // speed critical
   {
+    if (cpu_info.bAVX2)
+    {
+      DecodeRGBA8_AVX2((u32*)dst, src, width, height, true);
+      return PC_TEX_FMT_BGRA32;
+    }
 
 #if _M_SSE >= 0x301
     if (cpu_info.bSSSE3)
@@ -1781,6 +2179,9 @@ static HostTextureFormat Decode_real(u8 *dst, const u8 *src, u32 width, u32 heig
 
 static HostTextureFormat Decode_RGBA(u32 * dst, const u8 * src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt)
 {
+  if (cpu_info.bAVX2 && Decode_RGBA_AVX2(dst, src, width, height, texformat, tlutaddr, tlutfmt))
+    return PC_TEX_FMT_RGBA32;
+
   const u32 Wsteps4 = (width + 3) / 4;
   const u32 Wsteps8 = (width + 7) / 8;
 
@@ -2151,7 +2552,7 @@ static HostTextureFormat Decode_RGBA(u32 * dst, const u8 * src, u32 width, u32 h
       for (u32 y = 0; y < height; y += 4)
         for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
           for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
-            decodebytesC14X2_5A3_To_BGRA32(dst + (y + iy) * width + x, (u16*)(src + 8 * xStep), tlutaddr);
+            decodebytesC14X2_5A3_To_RGBA(dst + (y + iy) * width + x, (u16*)(src + 8 * xStep), tlutaddr);
     }
     else if (tlutfmt == GX_TL_IA8)
     {
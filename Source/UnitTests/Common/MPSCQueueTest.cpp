@@ -0,0 +1,86 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "Common/CommonTypes.h"
+#include "Common/MPSCQueue.h"
+
+TEST(MPSCQueue, Simple)
+{
+  Common::MPSCQueue<u32> q;
+
+  EXPECT_TRUE(q.Empty());
+  u32 v;
+  EXPECT_FALSE(q.Pop(v));
+
+  q.Push(1);
+  EXPECT_FALSE(q.Empty());
+  EXPECT_TRUE(q.Pop(v));
+  EXPECT_EQ(1u, v);
+  EXPECT_TRUE(q.Empty());
+
+  // Test the FIFO order, also with pushes between the pops.
+  for (u32 i = 0; i < 1000; ++i)
+    q.Push(i);
+  for (u32 i = 0; i < 500; ++i)
+  {
+    EXPECT_TRUE(q.Pop(v));
+    EXPECT_EQ(i, v);
+  }
+  for (u32 i = 1000; i < 1500; ++i)
+    q.Push(i);
+  for (u32 i = 500; i < 1500; ++i)
+  {
+    EXPECT_TRUE(q.Pop(v));
+    EXPECT_EQ(i, v);
+  }
+  EXPECT_TRUE(q.Empty());
+
+  for (u32 i = 0; i < 1000; ++i)
+    q.Push(i);
+  EXPECT_TRUE(q.Pop(v));
+  EXPECT_FALSE(q.Empty());
+  q.Clear();
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(MPSCQueue, MultiThreaded)
+{
+  static constexpr u32 PRODUCERS = 4;
+  static constexpr u32 COUNT = 100000;
+  Common::MPSCQueue<u32> q;
+
+  auto inserter = [&q](u32 producer) {
+    for (u32 i = 0; i < COUNT; ++i)
+      q.Push(producer * COUNT + i);
+  };
+
+  // Each producer's elements have to come out in order
+  auto popper = [&q]() {
+    std::array<u32, PRODUCERS> next{};
+    for (u32 i = 0; i < PRODUCERS * COUNT; ++i)
+    {
+      u32 v;
+      while (!q.Pop(v))
+        ;
+      const u32 producer = v / COUNT;
+      ASSERT_LT(producer, PRODUCERS);
+      EXPECT_EQ(next[producer], v % COUNT);
+      next[producer] = v % COUNT + 1;
+    }
+    EXPECT_TRUE(q.Empty());
+  };
+
+  std::thread popper_thread(popper);
+  std::array<std::thread, PRODUCERS> inserter_threads;
+  for (u32 i = 0; i < PRODUCERS; ++i)
+    inserter_threads[i] = std::thread(inserter, i);
+
+  for (std::thread& thread : inserter_threads)
+    thread.join();
+  popper_thread.join();
+}
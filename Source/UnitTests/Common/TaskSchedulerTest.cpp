@@ -0,0 +1,97 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "Common/TaskScheduler.h"
+
+using Common::TaskGroup;
+using Common::TaskPriority;
+using Common::TaskScheduler;
+
+TEST(TaskScheduler, ParallelForCoversRange)
+{
+  for (s32 grain : {1, 7, 64, 1000, 5000})
+  {
+    std::vector<std::atomic<int>> hits(1000);
+    TaskScheduler::ParallelFor(0, 1000, grain, [&](s32 begin, s32 end) {
+      EXPECT_LE(end - begin, grain);
+      for (s32 i = begin; i < end; ++i)
+        hits[i]++;
+    });
+
+    for (const auto& hit : hits)
+      EXPECT_EQ(1, hit.load());
+  }
+}
+
+TEST(TaskScheduler, ParallelForEmptyRange)
+{
+  bool called = false;
+  TaskScheduler::ParallelFor(5, 5, 1, [&](s32, s32) { called = true; });
+  TaskScheduler::ParallelFor(5, 3, 1, [&](s32, s32) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+TEST(TaskScheduler, NestedGroups)
+{
+  std::atomic<int> count{0};
+  TaskGroup outer;
+  for (int i = 0; i < 16; ++i)
+  {
+    outer.Run([&count] {
+      TaskGroup inner;
+      for (int j = 0; j < 16; ++j)
+        inner.Run([&count] { count++; });
+      inner.Wait();
+    });
+  }
+  outer.Wait();
+  EXPECT_EQ(16 * 16, count.load());
+}
+
+TEST(TaskScheduler, SubmitAndCounters)
+{
+  TaskScheduler::ResetCounters();
+
+  std::atomic<int> count{0};
+  constexpr int NUM_TASKS = 100;
+  for (int i = 0; i < NUM_TASKS; ++i)
+    TaskScheduler::Submit([&count] { count++; });
+
+  // The counters are updated after the task has returned
+  while (TaskScheduler::GetCounters().tasks_executed < NUM_TASKS)
+    std::this_thread::yield();
+
+  const Common::TaskSchedulerCounters counters = TaskScheduler::GetCounters();
+  EXPECT_EQ(NUM_TASKS, count.load());
+  EXPECT_GE(counters.max_queue_depth, 1u);
+  EXPECT_GE(counters.steal_attempts, counters.tasks_stolen);
+}
+
+TEST(TaskScheduler, MultipleProducers)
+{
+  constexpr int NUM_PRODUCERS = 4;
+  constexpr int TASKS_PER_PRODUCER = 2000;
+  std::atomic<int> count{0};
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < NUM_PRODUCERS; ++i)
+  {
+    producers.emplace_back([&count, i] {
+      TaskGroup group;
+      const TaskPriority priority = i % 2 ? TaskPriority::High : TaskPriority::Background;
+      for (int j = 0; j < TASKS_PER_PRODUCER; ++j)
+        group.Run([&count] { count++; }, priority);
+      group.Wait();
+    });
+  }
+  for (auto& producer : producers)
+    producer.join();
+
+  EXPECT_EQ(NUM_PRODUCERS * TASKS_PER_PRODUCER, count.load());
+}
@@ -1018,6 +1018,131 @@ AVX_RRM_TEST(VPANDN, "dqword")
 AVX_RRM_TEST(VPOR, "dqword")
 AVX_RRM_TEST(VPXOR, "dqword")
 
+// for VEX-encoded moves from memory
+#define VEX_LOAD_TEST(Name, sizename)                                                              \
+  TEST_F(x64EmitterTest, Name)                                                                     \
+  {                                                                                                \
+    for (const auto& r : xmmnames)                                                                 \
+    {                                                                                              \
+      emitter->Name(r.reg, MatR(R12));                                                             \
+      ExpectDisassembly(#Name " " + r.name + ", " sizename " ptr ds:[r12]");                       \
+    }                                                                                              \
+  }
+
+VEX_LOAD_TEST(VMOVDQU, "dqword")
+
+TEST_F(x64EmitterTest, VMOVD_xmm)
+{
+  for (const auto& r : xmmnames)
+  {
+    emitter->VMOVD_xmm(r.reg, MatR(R12));
+    ExpectDisassembly("vmovd " + r.name + ", dword ptr ds:[r12]");
+  }
+}
+
+TEST_F(x64EmitterTest, VMOVQ_xmm)
+{
+  for (const auto& r : xmmnames)
+  {
+    emitter->VMOVQ_xmm(r.reg, MatR(R12));
+    ExpectDisassembly("vmovq " + r.name + ", qword ptr ds:[r12]");
+  }
+}
+
+// for VEX-encoded moves to memory
+#define VEX_STORE_TEST(Name, sizename)                                                             \
+  TEST_F(x64EmitterTest, Name)                                                                     \
+  {                                                                                                \
+    for (const auto& r : xmmnames)                                                                 \
+    {                                                                                              \
+      emitter->Name(MatR(R12), r.reg);                                                             \
+      ExpectDisassembly(#Name " " sizename " ptr ds:[r12], " + r.name);                            \
+    }                                                                                              \
+  }
+
+VEX_STORE_TEST(VMOVSS, "dword")
+VEX_STORE_TEST(VMOVLPS, "qword")
+VEX_STORE_TEST(VMOVUPS, "dqword")
+
+TEST_F(x64EmitterTest, VCVTSI2SS)
+{
+  for (const auto& r : xmmnames)
+  {
+    emitter->VCVTSI2SS(r.reg, XMM0, R(EAX));
+    emitter->VCVTSI2SS(XMM0, r.reg, MatR(R12));
+    ExpectDisassembly("vcvtsi2ss " + r.name + ", xmm0, eax vcvtsi2ss xmm0, " + r.name +
+                      ", dword ptr ds:[r12]");
+  }
+}
+
+TEST_F(x64EmitterTest, VZEROUPPER)
+{
+  emitter->VZEROUPPER();
+  ExpectDisassembly("vzeroupper");
+}
+
+// for 256-bit instructions that take the form op ymm, ymm, r/m
+#define AVX_YMM_RRM_TEST(Name, Mnemonic)                                                           \
+  TEST_F(x64EmitterTest, Name)                                                                     \
+  {                                                                                                \
+    for (const auto& r : ymmnames)                                                                 \
+    {                                                                                              \
+      emitter->Name(r.reg, YMM0, R(YMM0));                                                         \
+      emitter->Name(YMM0, YMM0, R(r.reg));                                                         \
+      emitter->Name(YMM0, r.reg, MatR(R12));                                                       \
+      ExpectDisassembly(Mnemonic " " + r.name + ", ymm0, ymm0 " Mnemonic " ymm0, ymm0, " +         \
+                        r.name + " " Mnemonic " ymm0, " + r.name + ", qqword ptr ds:[r12]");      \
+    }                                                                                              \
+  }
+
+AVX_YMM_RRM_TEST(VMULPS_ymm, "vmulps")
+AVX_YMM_RRM_TEST(VPSHUFB_ymm, "vpshufb")
+
+TEST_F(x64EmitterTest, VCVTDQ2PS_ymm)
+{
+  for (const auto& r : ymmnames)
+  {
+    emitter->VCVTDQ2PS_ymm(r.reg, R(YMM0));
+    emitter->VCVTDQ2PS_ymm(YMM0, MatR(R12));
+    ExpectDisassembly("vcvtdq2ps " + r.name + ", ymm0 vcvtdq2ps ymm0, qqword ptr ds:[r12]");
+  }
+}
+
+TEST_F(x64EmitterTest, VPSRAD_ymm)
+{
+  for (const auto& r : ymmnames)
+  {
+    emitter->VPSRAD_ymm(r.reg, YMM0, 24);
+    emitter->VPSRAD_ymm(YMM0, r.reg, 16);
+    ExpectDisassembly("vpsrad " + r.name + ", ymm0, 0x18 vpsrad ymm0, " + r.name + ", 0x10");
+  }
+}
+
+// The disassembler shows the 128-bit operand of these as a YMM register
+TEST_F(x64EmitterTest, VINSERTI128)
+{
+  for (const auto& r : ymmnames)
+  {
+    emitter->VINSERTI128(r.reg, YMM0, R(XMM0), 1);
+    emitter->VINSERTI128(YMM0, r.reg, MatR(R12), 1);
+    emitter->VINSERTI128(YMM0, YMM0, R(r.reg), 1);
+    ExpectDisassembly("vinserti128 " + r.name + ", ymm0, ymm0, 0x01 vinserti128 ymm0, " + r.name +
+                      ", qqword ptr ds:[r12], 0x01 vinserti128 ymm0, ymm0, " + r.name + ", 0x01");
+  }
+}
+
+TEST_F(x64EmitterTest, VEXTRACTI128)
+{
+  for (const auto& r : ymmnames)
+  {
+    emitter->VEXTRACTI128(R(XMM0), r.reg, 1);
+    emitter->VEXTRACTI128(MatR(R12), r.reg, 1);
+    emitter->VEXTRACTI128(R(r.reg), YMM0, 1);
+    ExpectDisassembly("vextracti128 ymm0, " + r.name + ", 0x01 vextracti128 qqword ptr ds:[r12], " +
+                      r.name + ", 0x01 vextracti128 " + r.name + ", ymm0, 0x01");
+  }
+}
+
 #define FMA3_TEST(Name, P, packed)                                                                 \
   AVX_RRM_TEST(Name##132##P##S, packed ? "dqword" : "dword")                                       \
   AVX_RRM_TEST(Name##213##P##S, packed ? "dqword" : "dword")                                       \
@@ -0,0 +1,151 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "Common/Swap.h"
+#include "Common/x64ABI.h"
+#include "Common/x64Emitter.h"
+#include "Core/PowerPC/Jit64Common/TrampolineCache.h"
+#include "Core/PowerPC/Jit64Common/TrampolineInfo.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/PowerPC.h"
+
+// include order is important
+#include <gtest/gtest.h>  // NOLINT
+
+using namespace Gen;
+
+namespace
+{
+class HostTLBFakeJit : public JitBase
+{
+public:
+  // CPUCoreBase methods
+  void Init() override {}
+  void Shutdown() override {}
+  void ClearCache() override {}
+  void Run() override {}
+  void SingleStep() override {}
+  const char* GetName() const override { return nullptr; }
+  // JitBase methods
+  JitBaseBlockCache* GetBlockCache() override { return nullptr; }
+  void Jit(u32 em_address) override {}
+  const CommonAsmRoutinesBase* GetAsmRoutines() override { return nullptr; }
+  bool HandleFault(uintptr_t access_address, SContext* ctx) override { return false; }
+};
+
+// An effective page that the MMU would have put in the host TLB
+constexpr u32 PAGE = 0x7E003000;
+
+// Generates the trampoline of a load or store whose fastmem access faulted, the way
+// Jitx86Base::BackPatch does, and a function that runs it.
+class HostTLBTest : public testing::Test
+{
+protected:
+  using Function = u64 (*)(u64 address, u64 value);
+
+  void SetUp() override
+  {
+    m_jit.jo.fastmem = true;
+    m_jit.jo.memcheck = true;
+    m_jit.jo.hostTLB = true;
+    g_jit = &m_jit;
+    m_saved_msr = MSR;
+    UReg_MSR msr(MSR);
+    msr.DR = 1;
+    MSR = msr.Hex;
+
+    m_caller.AllocCodeSpace(4096);
+    m_trampolines.AllocCodeSpace(4096);
+    m_page.fill(0);
+    EntryFor(PowerPC::host_read_tlb) = {PAGE, 0, reinterpret_cast<uintptr_t>(m_page.data()) - PAGE};
+    EntryFor(PowerPC::host_write_tlb) = {PAGE, 0,
+                                         reinterpret_cast<uintptr_t>(m_page.data()) - PAGE};
+  }
+
+  void TearDown() override
+  {
+    EntryFor(PowerPC::host_read_tlb) = {};
+    EntryFor(PowerPC::host_write_tlb) = {};
+    MSR = m_saved_msr;
+    g_jit = nullptr;
+    m_caller.FreeCodeSpace();
+    m_trampolines.FreeCodeSpace();
+  }
+
+  static PowerPC::HostTLBEntry& EntryFor(PowerPC::HostTLB& tlb)
+  {
+    return tlb[(PAGE >> PowerPC::HOST_TLB_PAGE_SHIFT) & (PowerPC::HOST_TLB_SIZE - 1)];
+  }
+
+  // The address is passed in R12 and the value in R13, which is also returned
+  Function Generate(bool read, int access_size)
+  {
+    const Function function = reinterpret_cast<Function>(m_caller.AlignCode16());
+    m_caller.ABI_PushRegistersAndAdjustStack(ABI_ALL_CALLEE_SAVED, 8);
+    m_caller.MOV(64, R(R12), R(ABI_PARAM1));
+    m_caller.MOV(64, R(R13), R(ABI_PARAM2));
+    u8* const access = m_caller.GetWritableCodePtr();
+    m_caller.NOP(BACKPATCH_SIZE);
+    m_caller.MOV(64, R(ABI_RETURN), R(R13));
+    m_caller.ABI_PopRegistersAndAdjustStack(ABI_ALL_CALLEE_SAVED, 8);
+    m_caller.RET();
+
+    TrampolineInfo info{};
+    info.start = access;
+    info.len = BACKPATCH_SIZE;
+    info.pc = PAGE;
+    info.nonAtomicSwapStoreSrc = INVALID_REG;
+    info.op_reg = read ? R13 : R12;
+    info.op_arg = read ? R(R12) : R(R13);
+    info.accessSize = access_size / 8;
+    info.read = read;
+
+    m_jit.js.generatingTrampoline = true;
+    m_jit.js.trampolineExceptionHandler = nullptr;
+    m_jit.js.compilerPC = info.pc;
+    const u8* trampoline = m_trampolines.GenerateTrampoline(info);
+    m_jit.js.generatingTrampoline = false;
+
+    XEmitter emitter(access);
+    emitter.JMP(trampoline, true);
+    return function;
+  }
+
+  HostTLBFakeJit m_jit;
+  X64CodeBlock m_caller;
+  TrampolineCache m_trampolines;
+  std::array<u8, PowerPC::HOST_TLB_PAGE_SIZE> m_page;
+  u32 m_saved_msr = 0;
+};
+}  // namespace
+
+// Trampolines force slowmem, which must not keep them from probing the host TLB
+TEST_F(HostTLBTest, TrampolineLoadHits)
+{
+  const u32 value = 0x12345678;
+  std::memcpy(&m_page[0x24], &value, sizeof(value));
+  const Function load = Generate(true, 32);
+  PowerPC::ResetHostTLBStats();
+
+  EXPECT_EQ(Common::swap32(value), load(PAGE + 0x24, 0));
+  EXPECT_EQ(1u, EntryFor(PowerPC::host_read_tlb).hits);
+  EXPECT_EQ(1u, PowerPC::GetHostTLBStats().hits);
+}
+
+TEST_F(HostTLBTest, TrampolineStoreHits)
+{
+  const Function store = Generate(false, 32);
+  PowerPC::ResetHostTLBStats();
+
+  store(PAGE + 0x40, 0x12345678);
+  u32 stored;
+  std::memcpy(&stored, &m_page[0x40], sizeof(stored));
+  EXPECT_EQ(Common::swap32(0x12345678), stored);
+  EXPECT_EQ(1u, EntryFor(PowerPC::host_write_tlb).hits);
+  EXPECT_EQ(1u, PowerPC::GetHostTLBStats().hits);
+}
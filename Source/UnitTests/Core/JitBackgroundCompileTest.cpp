@@ -0,0 +1,104 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+// include order is important
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+// Where the test code goes, in real mode
+constexpr u32 CODE_ADDRESS = 0x3000;
+// The cache line the code invalidates
+constexpr u32 DATA_ADDRESS = 0x3100;
+// Where the block returns to
+constexpr u32 RETURN_ADDRESS = 0x3200;
+
+constexpr u32 DCBI_R3 = 0x7C001BAC;   // dcbi 0, r3
+constexpr u32 ICBI_R3 = 0x7C001FAC;   // icbi 0, r3
+constexpr u32 DCBF_R3 = 0x7C0018AC;   // dcbf 0, r3
+constexpr u32 DCBST_R3 = 0x7C00186C;  // dcbst 0, r3
+constexpr u32 BLR = 0x4E800020;
+
+// Runs Jit64 with background compilation, so that blocks that miss the cache run in its
+// cached interpreter.
+class JitBackgroundCompileTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    SConfig::GetInstance().bJITBackgroundCompile = true;
+    SConfig::GetInstance().bEnableDebugging = false;
+    Memory::Init();
+    PowerPC::Init(PowerPC::CORE_JIT64);
+    CoreTiming::Init();
+    ASSERT_TRUE(g_jit && g_jit->CompilesInBackground());
+
+    // Real mode, with the instruction cache on so that icbi reaches the JIT
+    MSR = 0;
+    HID0.ICE = 1;
+  }
+
+  void TearDown() override
+  {
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  // Runs the code at CODE_ADDRESS until it returns, the way the dispatcher does on misses. A
+  // cold block is first compiled for the cached interpreter, and runs there on the next miss.
+  // icbi ends blocks.
+  void RunCode()
+  {
+    PowerPC::ppcState.gpr[3] = DATA_ADDRESS;
+    LR = RETURN_ADDRESS;
+    PC = NPC = CODE_ADDRESS;
+    for (int i = 0; i < 8 && PC != RETURN_ADDRESS; ++i)
+      g_jit->Jit(PC);
+  }
+
+  std::string m_profile_path;
+};
+}  // namespace
+
+// Interpreted cache instructions invalidate the JIT cache through JitInterface, which takes the
+// cache lock. Running the block must not hold it.
+TEST_F(JitBackgroundCompileTest, ColdBlockInvalidatesCache)
+{
+  u32 address = CODE_ADDRESS;
+  for (u32 instruction : {DCBI_R3, ICBI_R3, DCBF_R3, DCBST_R3, BLR})
+  {
+    Memory::Write_U32(instruction, address);
+    address += 4;
+  }
+
+  RunCode();
+  EXPECT_EQ(RETURN_ADDRESS, PC);
+
+  // And again from the cached interpreter's cache
+  RunCode();
+  EXPECT_EQ(RETURN_ADDRESS, PC);
+}
@@ -0,0 +1,190 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <initializer_list>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+// include order is important
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+// Where the test code goes, in real mode
+constexpr u32 CODE_ADDRESS = 0x3000;
+// Where the test code calls
+constexpr u32 FUNCTION_ADDRESS = 0x3100;
+// What the loops poll
+constexpr u32 DATA_ADDRESS = 0x1000;
+
+constexpr u32 LWZ_R3_R4 = 0x80640000;     // lwz r3, 0(r4)
+constexpr u32 LWZU_R3_R4 = 0x84640004;    // lwzu r3, 4(r4)
+constexpr u32 LWARX_R3_R4 = 0x7C602028;   // lwarx r3, 0, r4
+constexpr u32 STW_R3_R5 = 0x90650000;     // stw r3, 0(r5)
+constexpr u32 ADDI_R3_M1 = 0x3863FFFF;    // addi r3, r3, -1
+constexpr u32 ADDE_R5_R4 = 0x7CA42114;    // adde r5, r4, r4
+constexpr u32 RLWINM_R5_R3 = 0x5465063E;  // rlwinm r5, r3, 0, 24, 31
+constexpr u32 MFTB_R3 = 0x7C6C42E6;       // mftb r3
+constexpr u32 CMPWI_R3 = 0x2C030000;      // cmpwi r3, 0
+constexpr u32 CMPWI_R5 = 0x2C050000;      // cmpwi r5, 0
+constexpr u32 CMPW_R3_R4 = 0x7C032000;    // cmpw r3, r4
+constexpr u32 BL = 0x48000001;            // bl, with the displacement or'ed in
+constexpr u32 B_SELF = 0x48000000;        // b .
+constexpr u32 BEQ = 0x41820000;           // beq, with the displacement or'ed in
+constexpr u32 BEQL = 0x41820001;          // beql, with the displacement or'ed in
+constexpr u32 BNE = 0x40820000;           // bne, with the displacement or'ed in
+constexpr u32 BLT = 0x41800000;           // blt, with the displacement or'ed in
+constexpr u32 BDNZ = 0x42000000;          // bdnz, with the displacement or'ed in
+constexpr u32 BLR = 0x4E800020;
+
+constexpr u32 Back(u32 bytes)
+{
+  return -bytes & 0xFFFF;
+}
+
+class JitIdleLoopTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    SConfig::GetInstance().bJITBackgroundCompile = false;
+    SConfig::GetInstance().bEnableDebugging = false;
+    Memory::Init();
+    PowerPC::Init(PowerPC::CORE_JIT64);
+    CoreTiming::Init();
+    ASSERT_TRUE(g_jit);
+
+    MSR = 0;
+
+    m_block.m_stats = &m_stats;
+    m_block.m_gpa = &m_gpa;
+    m_block.m_fpa = &m_fpa;
+    m_analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE);
+    m_analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+  }
+
+  void TearDown() override
+  {
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  static void WriteCode(u32 address, std::initializer_list<u32> instructions)
+  {
+    for (u32 instruction : instructions)
+    {
+      Memory::Write_U32(instruction, address);
+      address += 4;
+    }
+  }
+
+  // Whether the analyzer takes the code at CODE_ADDRESS for a busy-wait loop
+  bool IsIdleLoop(std::initializer_list<u32> instructions)
+  {
+    WriteCode(CODE_ADDRESS, instructions);
+    m_analyzer.Analyze(CODE_ADDRESS, &m_block, &m_buffer, 100);
+    const PPCAnalyst::CodeOp* ops = m_buffer.codebuffer;
+    return std::any_of(ops, ops + m_block.m_num_instructions,
+                       [](const PPCAnalyst::CodeOp& op) { return op.branchIsIdleLoop; });
+  }
+
+  // Runs the code at CODE_ADDRESS with Jit64 for a time slice
+  static void Run(std::initializer_list<u32> instructions)
+  {
+    WriteCode(CODE_ADDRESS, instructions);
+    PowerPC::ppcState.gpr[4] = DATA_ADDRESS;
+    PC = NPC = CODE_ADDRESS;
+    g_jit->Run();
+  }
+
+  PPCAnalyst::PPCAnalyzer m_analyzer;
+  PPCAnalyst::CodeBlock m_block;
+  PPCAnalyst::CodeBuffer m_buffer{100};
+  PPCAnalyst::BlockStats m_stats;
+  PPCAnalyst::BlockRegStats m_gpa;
+  PPCAnalyst::BlockRegStats m_fpa;
+  std::string m_profile_path;
+};
+}  // namespace
+
+TEST_F(JitIdleLoopTest, PollingLoops)
+{
+  EXPECT_TRUE(IsIdleLoop({B_SELF}));
+  EXPECT_TRUE(IsIdleLoop({LWZ_R3_R4, CMPWI_R3, BEQ | Back(8)}));
+  EXPECT_TRUE(IsIdleLoop({LWZ_R3_R4, RLWINM_R5_R3, CMPWI_R5, BNE | Back(12), BLR}));
+}
+
+TEST_F(JitIdleLoopTest, PollingThroughFollowedCall)
+{
+  // Status getters like the DSP mailbox checks
+  WriteCode(FUNCTION_ADDRESS, {LWZ_R3_R4, BLR});
+  EXPECT_TRUE(IsIdleLoop({BL | (FUNCTION_ADDRESS - CODE_ADDRESS), CMPWI_R3, BEQ | Back(8)}));
+
+  WriteCode(FUNCTION_ADDRESS, {STW_R3_R5, BLR});
+  EXPECT_FALSE(IsIdleLoop({BL | (FUNCTION_ADDRESS - CODE_ADDRESS), CMPWI_R3, BEQ | Back(8)}));
+}
+
+TEST_F(JitIdleLoopTest, LoopsThatGetSomewhere)
+{
+  // Counting
+  EXPECT_FALSE(IsIdleLoop({ADDI_R3_M1, CMPWI_R3, BNE | Back(8)}));
+  EXPECT_FALSE(IsIdleLoop({LWZ_R3_R4, BDNZ | Back(4)}));
+  // Walking through memory
+  EXPECT_FALSE(IsIdleLoop({LWZU_R3_R4, CMPWI_R3, BEQ | Back(8)}));
+  // Storing
+  EXPECT_FALSE(IsIdleLoop({LWZ_R3_R4, STW_R3_R5, CMPWI_R3, BEQ | Back(12)}));
+  // Taking a reservation
+  EXPECT_FALSE(IsIdleLoop({LWARX_R3_R4, CMPWI_R3, BEQ | Back(8)}));
+  // Reading the carry
+  EXPECT_FALSE(IsIdleLoop({ADDE_R5_R4, CMPWI_R5, BEQ | Back(8)}));
+  // Waiting for the time base
+  EXPECT_FALSE(IsIdleLoop({MFTB_R3, CMPW_R3_R4, BLT | Back(8)}));
+}
+
+TEST_F(JitIdleLoopTest, BranchesThatDontLoop)
+{
+  // Not to the start of the block
+  EXPECT_FALSE(IsIdleLoop({ADDI_R3_M1, LWZ_R3_R4, CMPWI_R3, BEQ | Back(8)}));
+  // Calls
+  EXPECT_FALSE(IsIdleLoop({LWZ_R3_R4, CMPWI_R3, BEQL | Back(8)}));
+}
+
+TEST_F(JitIdleLoopTest, PollingLoopSkipsAhead)
+{
+  Memory::Write_U32(0, DATA_ADDRESS);
+  Run({LWZ_R3_R4, CMPWI_R3, BEQ | Back(8), BLR});
+  EXPECT_EQ(CODE_ADDRESS, PC);
+  EXPECT_NE(0u, CoreTiming::GetIdleTicks());
+}
+
+TEST_F(JitIdleLoopTest, DelayLoopRuns)
+{
+  PowerPC::ppcState.gpr[3] = 1000000;
+  Run({ADDI_R3_M1, CMPWI_R3, BNE | Back(8), BLR});
+  EXPECT_EQ(CODE_ADDRESS, PC);
+  EXPECT_LT(PowerPC::ppcState.gpr[3], 1000000u);
+  EXPECT_EQ(0u, CoreTiming::GetIdleTicks());
+}
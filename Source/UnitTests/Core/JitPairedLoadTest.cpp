@@ -0,0 +1,198 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <initializer_list>
+#include <string>
+
+#include "Common/BitUtils.h"
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+// include order is important
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+// Where the test code goes, in real mode
+constexpr u32 CODE_ADDRESS = 0x3000;
+// Where the test code returns to, and stops
+constexpr u32 RETURN_ADDRESS = 0x3100;
+// Where the loaded floats are, through the BAT that maps RAM at 0x80000000
+constexpr u32 DATA_PHYSICAL_ADDRESS = 0x1000;
+constexpr u32 DATA_ADDRESS = 0x80000000 | DATA_PHYSICAL_ADDRESS;
+
+constexpr u32 BLR = 0x4E800020;
+constexpr u32 B_SELF = 0x48000000;
+
+constexpr u32 PSQ_L(u32 fs, u32 ra, s32 offset, u32 w = 0, u32 i = 0, u32 opcode = 56)
+{
+  return opcode << 26 | fs << 21 | ra << 16 | w << 15 | i << 12 | (offset & 0xFFF);
+}
+constexpr u32 PSQ_LU(u32 fs, u32 ra, s32 offset)
+{
+  return PSQ_L(fs, ra, offset, 0, 0, 57);
+}
+
+// Dequantizes floats
+constexpr u32 GQR_FLOAT = 0;
+// Dequantizes unsigned bytes
+constexpr u32 GQR_U8 = 4 << 16;
+
+// Runs code with Jit64, with data address translation on, and the floats 1.0 to 8.0 at
+// DATA_ADDRESS.
+class JitPairedLoadTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    SConfig::GetInstance().bJITBackgroundCompile = false;
+    SConfig::GetInstance().bEnableDebugging = false;
+    // Loads are only fused without memcheck
+    SConfig::GetInstance().bMMU = false;
+    Memory::Init();
+    PowerPC::Init(PowerPC::CORE_JIT64);
+    CoreTiming::Init();
+    ASSERT_TRUE(g_jit);
+
+    UReg_MSR msr(0);
+    msr.FP = 1;
+    msr.DR = 1;
+    MSR = msr.Hex;
+    HID2.PSE = 1;
+    HID2.LSQE = 1;
+    PowerPC::ppcState.spr[SPR_DBAT0U] = 0x80001FFF;
+    PowerPC::ppcState.spr[SPR_DBAT0L] = 0x00000002;
+    PowerPC::DBATUpdated();
+    GQR(0) = GQR_FLOAT;
+    GQR(1) = GQR_U8;
+
+    for (u32 i = 0; i < 8; i++)
+      Memory::Write_U32(Common::BitCast<u32>(1.0f + i), DATA_PHYSICAL_ADDRESS + i * 4);
+  }
+
+  void TearDown() override
+  {
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  // Runs the instructions as one block, with r3 pointing at the float 3.0 and r4 at 1.0
+  static void Run(std::initializer_list<u32> instructions)
+  {
+    g_jit->ClearCache();
+    u32 address = CODE_ADDRESS;
+    for (u32 instruction : instructions)
+    {
+      Memory::Write_U32(instruction, address);
+      address += 4;
+    }
+    Memory::Write_U32(BLR, address);
+    Memory::Write_U32(B_SELF, RETURN_ADDRESS);
+
+    PowerPC::ppcState.gpr[3] = DATA_ADDRESS + 8;
+    PowerPC::ppcState.gpr[4] = DATA_ADDRESS;
+    LR = RETURN_ADDRESS;
+    PC = NPC = CODE_ADDRESS;
+    g_jit->Run();
+    ASSERT_EQ(RETURN_ADDRESS, PC);
+  }
+
+  static void ExpectPair(int reg, double ps0, double ps1)
+  {
+    EXPECT_EQ(ps0, rPS0(reg)) << "f" << reg;
+    EXPECT_EQ(ps1, rPS1(reg)) << "f" << reg;
+  }
+
+  std::string m_profile_path;
+};
+}  // namespace
+
+TEST_F(JitPairedLoadTest, ConsecutivePairs)
+{
+  Run({PSQ_L(1, 3, 0), PSQ_L(2, 3, 8)});
+  ExpectPair(1, 3.0, 4.0);
+  ExpectPair(2, 5.0, 6.0);
+
+  Run({PSQ_L(1, 3, -8), PSQ_L(2, 3, 0)});
+  ExpectPair(1, 1.0, 2.0);
+  ExpectPair(2, 3.0, 4.0);
+
+  // The second pair first
+  Run({PSQ_L(1, 3, 8), PSQ_L(2, 3, 0)});
+  ExpectPair(1, 5.0, 6.0);
+  ExpectPair(2, 3.0, 4.0);
+}
+
+TEST_F(JitPairedLoadTest, OtherBase)
+{
+  Run({PSQ_L(1, 3, 0), PSQ_L(2, 4, 8)});
+  ExpectPair(1, 3.0, 4.0);
+  ExpectPair(2, 3.0, 4.0);
+}
+
+TEST_F(JitPairedLoadTest, NotConsecutive)
+{
+  Run({PSQ_L(1, 3, 0), PSQ_L(2, 3, 16)});
+  ExpectPair(1, 3.0, 4.0);
+  ExpectPair(2, 7.0, 8.0);
+}
+
+TEST_F(JitPairedLoadTest, SingleLoads)
+{
+  Run({PSQ_L(1, 3, 0, 1), PSQ_L(2, 3, 8)});
+  ExpectPair(1, 3.0, 1.0);
+  ExpectPair(2, 5.0, 6.0);
+
+  Run({PSQ_L(1, 3, 0), PSQ_L(2, 3, 8, 1)});
+  ExpectPair(1, 3.0, 4.0);
+  ExpectPair(2, 5.0, 1.0);
+}
+
+TEST_F(JitPairedLoadTest, OtherQuantization)
+{
+  // The bytes of the float 5.0 are 0x40, 0xA0, ...
+  Run({PSQ_L(1, 3, 0), PSQ_L(2, 3, 8, 0, 1)});
+  ExpectPair(1, 3.0, 4.0);
+  ExpectPair(2, 64.0, 160.0);
+
+  Run({PSQ_L(1, 3, 0, 0, 1), PSQ_L(2, 3, 8, 0, 1)});
+  ExpectPair(1, 64.0, 64.0);
+  ExpectPair(2, 64.0, 160.0);
+}
+
+TEST_F(JitPairedLoadTest, Update)
+{
+  Run({PSQ_L(1, 3, 0), PSQ_LU(2, 3, 8)});
+  ExpectPair(1, 3.0, 4.0);
+  ExpectPair(2, 5.0, 6.0);
+  EXPECT_EQ(DATA_ADDRESS + 16, PowerPC::ppcState.gpr[3]);
+
+  Run({PSQ_LU(1, 3, 8), PSQ_L(2, 3, 8)});
+  ExpectPair(1, 5.0, 6.0);
+  ExpectPair(2, 7.0, 8.0);
+}
+
+TEST_F(JitPairedLoadTest, SameRegister)
+{
+  Run({PSQ_L(1, 3, 0), PSQ_L(1, 3, 8)});
+  ExpectPair(1, 5.0, 6.0);
+}
@@ -0,0 +1,246 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <initializer_list>
+#include <string>
+#include <unordered_set>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+// include order is important
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+// Where the test code goes, in real mode
+constexpr u32 CODE_ADDRESS = 0x3000;
+// Where the likely taken branch goes
+constexpr u32 TARGET_ADDRESS = 0x3104;
+
+constexpr u32 ADDI_R3 = 0x38630001;  // addi r3, r3, 1
+constexpr u32 ADDI_R4 = 0x38840001;  // addi r4, r4, 1
+constexpr u32 BEQ = 0x41820000;      // beq, with the displacement or'ed in
+constexpr u32 BEQL = 0x41820001;     // beql, with the displacement or'ed in
+constexpr u32 BNE = 0x40820000;      // bne, with the displacement or'ed in
+constexpr u32 BLR = 0x4E800020;
+
+class JitTraceTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    SConfig::GetInstance().bJITBackgroundCompile = false;
+    SConfig::GetInstance().bJITTraces = true;
+    SConfig::GetInstance().bEnableDebugging = false;
+    Memory::Init();
+    PowerPC::Init(PowerPC::CORE_JIT64);
+    CoreTiming::Init();
+    ASSERT_TRUE(g_jit);
+
+    MSR = 0;
+
+    m_block.m_stats = &m_stats;
+    m_block.m_gpa = &m_gpa;
+    m_block.m_fpa = &m_fpa;
+    m_analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE);
+  }
+
+  void TearDown() override
+  {
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  static void WriteCode(u32 address, std::initializer_list<u32> instructions)
+  {
+    for (u32 instruction : instructions)
+    {
+      Memory::Write_U32(instruction, address);
+      address += 4;
+    }
+  }
+
+  // A block that branches to TARGET_ADDRESS, or returns
+  static void WriteBranchingBlock()
+  {
+    WriteCode(CODE_ADDRESS, {ADDI_R3, BEQ | (TARGET_ADDRESS - CODE_ADDRESS - 4), BLR});
+    WriteCode(TARGET_ADDRESS, {ADDI_R4, BLR});
+  }
+
+  void Analyze(const std::unordered_set<u32>& likely_taken_branches)
+  {
+    m_analyzer.SetLikelyTakenBranches(&likely_taken_branches);
+    m_analyzer.Analyze(CODE_ADDRESS, &m_block, &m_buffer, 100);
+    m_analyzer.SetLikelyTakenBranches(nullptr);
+  }
+
+  const PPCAnalyst::CodeOp& Op(u32 index) const { return m_buffer.codebuffer[index]; }
+  u32 NumFollowed() const
+  {
+    u32 followed = 0;
+    for (u32 i = 0; i < m_block.m_num_instructions; i++)
+      followed += Op(i).branchFollowed;
+    return followed;
+  }
+
+  // Compiles the block at CODE_ADDRESS, as a trace if it was promoted to one
+  static JitBlock* Compile()
+  {
+    g_jit->Jit(CODE_ADDRESS);
+    return g_jit->GetBlockCache()->GetBlockFromStartAddress(CODE_ADDRESS, MSR);
+  }
+
+  // Has the block take its branch as often as a hot block would, and promotes it to a trace
+  static void MakeTrace(JitBlock* block)
+  {
+    ASSERT_EQ(1u, block->branch_profiles.size());
+    block->branch_profiles[0].taken = JitBase::TRACE_THRESHOLD;
+    PC = CODE_ADDRESS;
+    JitInterface::CompileTrace();
+  }
+
+  static bool IsTrace(const JitBlock* block)
+  {
+    return block->physical_addresses.count(TARGET_ADDRESS) != 0;
+  }
+
+  PPCAnalyst::PPCAnalyzer m_analyzer;
+  PPCAnalyst::CodeBlock m_block;
+  PPCAnalyst::CodeBuffer m_buffer{100};
+  PPCAnalyst::BlockStats m_stats;
+  PPCAnalyst::BlockRegStats m_gpa;
+  PPCAnalyst::BlockRegStats m_fpa;
+  std::string m_profile_path;
+};
+}  // namespace
+
+TEST_F(JitTraceTest, FollowsLikelyTakenBranch)
+{
+  WriteBranchingBlock();
+
+  Analyze({CODE_ADDRESS + 4});
+  ASSERT_EQ(4u, m_block.m_num_instructions);
+  EXPECT_TRUE(Op(1).branchFollowed);
+  EXPECT_EQ(TARGET_ADDRESS, Op(2).address);
+
+  Analyze({});
+  ASSERT_EQ(3u, m_block.m_num_instructions);
+  EXPECT_FALSE(Op(1).branchFollowed);
+  EXPECT_EQ(CODE_ADDRESS + 8, Op(2).address);
+}
+
+TEST_F(JitTraceTest, DoesntFollowLoops)
+{
+  // To the start of the block
+  WriteCode(CODE_ADDRESS, {ADDI_R3, BNE | 0xFFFC, BLR});
+  Analyze({CODE_ADDRESS + 4});
+  EXPECT_EQ(0u, NumFollowed());
+  EXPECT_EQ(CODE_ADDRESS + 8, Op(2).address);
+
+  // To itself
+  WriteCode(CODE_ADDRESS, {ADDI_R3, BNE, BLR});
+  Analyze({CODE_ADDRESS + 4});
+  EXPECT_EQ(0u, NumFollowed());
+  EXPECT_EQ(CODE_ADDRESS + 8, Op(2).address);
+}
+
+TEST_F(JitTraceTest, DoesntFollowCalls)
+{
+  WriteCode(CODE_ADDRESS, {ADDI_R3, BEQL | (TARGET_ADDRESS - CODE_ADDRESS - 4), BLR});
+  WriteCode(TARGET_ADDRESS, {ADDI_R4, BLR});
+  Analyze({CODE_ADDRESS + 4});
+  EXPECT_EQ(0u, NumFollowed());
+}
+
+TEST_F(JitTraceTest, FollowsAtMostEightBranches)
+{
+  // Branches over returns, all of them likely taken
+  std::unordered_set<u32> likely_taken_branches;
+  for (u32 address = CODE_ADDRESS; address < CODE_ADDRESS + 10 * 8; address += 8)
+  {
+    WriteCode(address, {BEQ | 8, BLR});
+    likely_taken_branches.insert(address);
+  }
+  WriteCode(CODE_ADDRESS + 10 * 8, {BLR});
+
+  Analyze(likely_taken_branches);
+  EXPECT_EQ(8u, NumFollowed());
+  // The ninth branch is not taken, and the block ends at the return after it
+  EXPECT_EQ(CODE_ADDRESS + 8 * 8 + 4, Op(m_block.m_num_instructions - 1).address);
+}
+
+TEST_F(JitTraceTest, HotBlockBecomesTrace)
+{
+  WriteBranchingBlock();
+
+  JitBlock* block = Compile();
+  ASSERT_NE(nullptr, block);
+  EXPECT_FALSE(IsTrace(block));
+  MakeTrace(block);
+  EXPECT_EQ(1u, g_jit->js.traceAddresses.count(CODE_ADDRESS));
+  EXPECT_EQ(1u, g_jit->js.likelyTakenBranches.count(CODE_ADDRESS + 4));
+  EXPECT_EQ(nullptr, g_jit->GetBlockCache()->GetBlockFromStartAddress(CODE_ADDRESS, MSR));
+
+  block = Compile();
+  ASSERT_NE(nullptr, block);
+  EXPECT_TRUE(IsTrace(block));
+  EXPECT_TRUE(block->branch_profiles.empty());
+}
+
+TEST_F(JitTraceTest, InvalidatedTraceFallsBack)
+{
+  WriteBranchingBlock();
+  MakeTrace(Compile());
+  ASSERT_TRUE(IsTrace(Compile()));
+
+  // Code that was replaced has to turn hot again
+  JitInterface::InvalidateICache(CODE_ADDRESS, 32, true);
+  EXPECT_EQ(0u, g_jit->js.traceAddresses.count(CODE_ADDRESS));
+  EXPECT_EQ(0u, g_jit->js.likelyTakenBranches.count(CODE_ADDRESS + 4));
+  EXPECT_FALSE(IsTrace(Compile()));
+}
+
+TEST_F(JitTraceTest, InvalidationKeepsOtherTraces)
+{
+  WriteBranchingBlock();
+  MakeTrace(Compile());
+
+  JitInterface::InvalidateICache(CODE_ADDRESS - 32, 32, true);
+  JitInterface::InvalidateICache(CODE_ADDRESS + 8, 32, true);
+  EXPECT_EQ(1u, g_jit->js.traceAddresses.count(CODE_ADDRESS));
+  EXPECT_EQ(1u, g_jit->js.likelyTakenBranches.count(CODE_ADDRESS + 4));
+  EXPECT_TRUE(IsTrace(Compile()));
+}
+
+TEST_F(JitTraceTest, ClearCacheForgetsTraces)
+{
+  WriteBranchingBlock();
+  MakeTrace(Compile());
+
+  g_jit->ClearCache();
+  EXPECT_TRUE(g_jit->js.traceAddresses.empty());
+  EXPECT_TRUE(g_jit->js.likelyTakenBranches.empty());
+  EXPECT_FALSE(IsTrace(Compile()));
+}
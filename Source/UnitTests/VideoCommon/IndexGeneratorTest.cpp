@@ -0,0 +1,158 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <initializer_list>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+
+namespace
+{
+struct PrimitiveCase
+{
+  const char* name;
+  int primitive;
+};
+
+const PrimitiveCase PRIMITIVES[] = {
+    {"Quads", OpcodeDecoder::GX_DRAW_QUADS},
+    {"Triangles", OpcodeDecoder::GX_DRAW_TRIANGLES},
+    {"TriangleStrip", OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP},
+    {"TriangleFan", OpcodeDecoder::GX_DRAW_TRIANGLE_FAN},
+    {"Lines", OpcodeDecoder::GX_DRAW_LINES},
+    {"LineStrip", OpcodeDecoder::GX_DRAW_LINE_STRIP},
+    {"Points", OpcodeDecoder::GX_DRAW_POINTS},
+};
+
+// The indices the primitives are drawn with, one triangle, line or point at a time
+std::vector<u16> ExpectedIndices(int primitive, u32 first, u32 count)
+{
+  std::vector<u16> indices;
+  const auto add = [&indices](std::initializer_list<u32> values) {
+    for (u32 value : values)
+      indices.push_back(static_cast<u16>(value));
+  };
+
+  switch (primitive)
+  {
+  case OpcodeDecoder::GX_DRAW_QUADS:
+    for (u32 i = 0; i + 4 <= count; i += 4)
+      add({first + i, first + i + 1, first + i + 2, first + i, first + i + 2, first + i + 3});
+    if (count % 4 == 3)
+      add({first + count - 3, first + count - 2, first + count - 1});
+    break;
+  case OpcodeDecoder::GX_DRAW_TRIANGLES:
+    for (u32 i = 0; i + 3 <= count; i += 3)
+      add({first + i, first + i + 1, first + i + 2});
+    break;
+  case OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP:
+    for (u32 i = 0; i + 3 <= count; i++)
+    {
+      if (i & 1)
+        add({first + i, first + i + 2, first + i + 1});
+      else
+        add({first + i, first + i + 1, first + i + 2});
+    }
+    break;
+  case OpcodeDecoder::GX_DRAW_TRIANGLE_FAN:
+    for (u32 i = 2; i < count; i++)
+      add({first, first + i - 1, first + i});
+    break;
+  case OpcodeDecoder::GX_DRAW_LINES:
+    for (u32 i = 0; i + 2 <= count; i += 2)
+      add({first + i, first + i + 1});
+    break;
+  case OpcodeDecoder::GX_DRAW_LINE_STRIP:
+    for (u32 i = 1; i < count; i++)
+      add({first + i - 1, first + i});
+    break;
+  case OpcodeDecoder::GX_DRAW_POINTS:
+    for (u32 i = 0; i < count; i++)
+      add({first + i});
+    break;
+  }
+  return indices;
+}
+
+// Generates the indices of a primitive that follows first vertices of another batch
+std::vector<u16> GenerateIndices(int primitive, u32 first, u32 count)
+{
+  // The largest primitive needs 3 indices per vertex, and some room to spot overruns
+  std::vector<u16> buffer((first + count) * 3 + 64, 0xFFFF);
+  IndexGenerator::Start(buffer.data());
+  IndexGenerator::AddIndices(OpcodeDecoder::GX_DRAW_POINTS, first);
+  const u32 start = IndexGenerator::GetIndexLen();
+  IndexGenerator::AddIndices(primitive, count);
+  const u32 end = IndexGenerator::GetIndexLen();
+
+  for (size_t i = end; i < buffer.size(); i++)
+    EXPECT_EQ(0xFFFF, buffer[i]) << "written past the end at " << i;
+  return std::vector<u16>(buffer.begin() + start, buffer.begin() + end);
+}
+
+class IndexGeneratorTest : public testing::Test
+{
+protected:
+  void SetUp() override { IndexGenerator::Init(); }
+};
+}  // namespace
+
+TEST_F(IndexGeneratorTest, MatchesReference)
+{
+  for (const PrimitiveCase& primitive : PRIMITIVES)
+  {
+    for (u32 first : {0u, 5u, 1000u})
+    {
+      // Covers a few whole groups of triangles, with every possible remainder
+      for (u32 count = 0; count < 200; count++)
+      {
+        ASSERT_EQ(ExpectedIndices(primitive.primitive, first, count),
+                  GenerateIndices(primitive.primitive, first, count))
+            << primitive.name << ", " << count << " vertices after " << first;
+      }
+    }
+  }
+}
+
+TEST_F(IndexGeneratorTest, LastIndex)
+{
+  // The indices of the last vertices must not wrap around
+  const u32 count = 600;
+  const u32 first = IndexGenerator::GetRemainingIndices() + 1 - count;
+  for (const PrimitiveCase& primitive : PRIMITIVES)
+  {
+    EXPECT_EQ(ExpectedIndices(primitive.primitive, first, count),
+              GenerateIndices(primitive.primitive, first, count))
+        << primitive.name;
+  }
+}
+
+TEST_F(IndexGeneratorTest, Remapped)
+{
+  // Every index goes through the remap table, and only the loaded vertices are counted
+  const u16 remap[] = {0, 1, 2, 1, 3, 2, 3, 0, 4, 2, 5, 1, 4};
+  const u32 count = static_cast<u32>(sizeof(remap) / sizeof(remap[0]));
+  const u32 loaded = 6;
+  const u32 first = 7;
+  for (const PrimitiveCase& primitive : PRIMITIVES)
+  {
+    std::vector<u16> expected = ExpectedIndices(primitive.primitive, 0, count);
+    for (u16& index : expected)
+      index = static_cast<u16>(first + remap[index]);
+
+    std::vector<u16> buffer((first + count) * 3 + 64, 0xFFFF);
+    IndexGenerator::Start(buffer.data());
+    IndexGenerator::AddIndices(OpcodeDecoder::GX_DRAW_POINTS, first);
+    const u32 start = IndexGenerator::GetIndexLen();
+    IndexGenerator::AddRemappedIndices(primitive.primitive, count, remap, loaded);
+    EXPECT_EQ(expected, std::vector<u16>(buffer.begin() + start,
+                                         buffer.begin() + IndexGenerator::GetIndexLen()))
+        << primitive.name;
+    EXPECT_EQ(first + loaded, IndexGenerator::GetNumVerts()) << primitive.name;
+  }
+}
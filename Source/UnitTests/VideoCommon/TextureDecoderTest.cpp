@@ -0,0 +1,169 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "VideoCommon/LookUpTables.h"
+#include "VideoCommon/TextureDecoder.h"
+
+namespace
+{
+struct FormatCase
+{
+  const char* name;
+  TextureFormat format;
+  TlutFormat tlut_format;
+};
+
+const FormatCase FORMATS[] = {
+    {"I4", GX_TF_I4, GX_TL_IA8},
+    {"I8", GX_TF_I8, GX_TL_IA8},
+    {"IA4", GX_TF_IA4, GX_TL_IA8},
+    {"IA8", GX_TF_IA8, GX_TL_IA8},
+    {"RGB565", GX_TF_RGB565, GX_TL_IA8},
+    {"RGB5A3", GX_TF_RGB5A3, GX_TL_IA8},
+    {"RGBA8", GX_TF_RGBA8, GX_TL_IA8},
+    {"C4/IA8", GX_TF_C4, GX_TL_IA8},
+    {"C4/RGB565", GX_TF_C4, GX_TL_RGB565},
+    {"C4/RGB5A3", GX_TF_C4, GX_TL_RGB5A3},
+    {"C8/IA8", GX_TF_C8, GX_TL_IA8},
+    {"C8/RGB565", GX_TF_C8, GX_TL_RGB565},
+    {"C8/RGB5A3", GX_TF_C8, GX_TL_RGB5A3},
+    {"C14X2/IA8", GX_TF_C14X2, GX_TL_IA8},
+    {"C14X2/RGB565", GX_TF_C14X2, GX_TL_RGB565},
+    {"C14X2/RGB5A3", GX_TF_C14X2, GX_TL_RGB5A3},
+    {"CMPR", GX_TF_CMPR, GX_TL_IA8},
+};
+
+// Enough room for the 0x4000 entries C14X2 can index
+constexpr u32 TLUT_ADDRESS = 0x40000;
+constexpr u32 TLUT_SIZE = 0x4000 * sizeof(u16);
+
+class TextureDecoderTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_had_avx2 = cpu_info.bAVX2;
+    std::mt19937 rng(1234);
+    for (u32 i = 0; i < TLUT_SIZE; ++i)
+      texMem[TLUT_ADDRESS + i] = static_cast<u8>(rng());
+  }
+
+  void TearDown() override { cpu_info.bAVX2 = m_had_avx2; }
+
+  static std::vector<u8> MakeSource(const FormatCase& format, u32 width, u32 height, u32 seed)
+  {
+    std::vector<u8> src(TexDecoder::GetTextureSizeInBytes(width, height, format.format));
+    std::mt19937 rng(seed);
+    for (u8& byte : src)
+      byte = static_cast<u8>(rng());
+    return src;
+  }
+
+  static std::vector<u8> Decode(const FormatCase& format, const std::vector<u8>& src, u32 width,
+                                u32 height, bool rgba_only)
+  {
+    // Decoders may write a whole block past the end of a row
+    std::vector<u8> dst(width * height * 4 + 64, 0xCD);
+    TexDecoder::Decode(dst.data(), src.data(), width, height, format.format, TLUT_ADDRESS,
+                       format.tlut_format, rgba_only);
+    return dst;
+  }
+
+  // Scalar version of what the SIMD decoders do for CMPR. DecodeTexel differs for the fourth color
+  // of blocks that aren't interpolated: it gives the average color, the decoders give color 2.
+  static u32 DecodeCMPRTexel(const u8* src, u32 s, u32 t, u32 width)
+  {
+    // 8x8 tiles of four 4x4 blocks, 8 bytes each
+    const u32 tile = (t / 8) * ((width + 7) / 8) + s / 8;
+    const u8* block = src + (tile * 4 + (t / 4 % 2) * 2 + s / 4 % 2) * 8;
+    const u16 c1 = (block[0] << 8) | block[1];
+    const u16 c2 = (block[2] << 8) | block[3];
+    const int v1[] = {Convert5To8(c1 >> 11), Convert6To8((c1 >> 5) & 0x3F), Convert5To8(c1 & 0x1F)};
+    const int v2[] = {Convert5To8(c2 >> 11), Convert6To8((c2 >> 5) & 0x3F), Convert5To8(c2 & 0x1F)};
+    const bool interpolate = c1 > c2;
+    const u32 selector = (block[4 + t % 4] >> (6 - 2 * (s % 4))) & 3;
+
+    u32 color = (selector == 3 && !interpolate) ? 0 : 0xFF000000;
+    for (int i = 0; i < 3; ++i)
+    {
+      // Each channel wraps around on its own
+      const int diff = v2[i] - v1[i];
+      const int third = (diff >> 1) - (diff >> 3);
+      const int channels[] = {v1[i], v2[i], interpolate ? v1[i] + third : (v1[i] + v2[i] + 1) / 2,
+                              interpolate ? v2[i] - third : v2[i]};
+      color |= static_cast<u32>(channels[selector] & 0xFF) << (i * 8);
+    }
+    return color;
+  }
+
+  bool m_had_avx2 = false;
+};
+}  // namespace
+
+TEST_F(TextureDecoderTest, MatchesTexelDecoder)
+{
+  constexpr u32 WIDTH = 64;
+  constexpr u32 HEIGHT = 32;
+  const u16* tlut = reinterpret_cast<const u16*>(texMem + TLUT_ADDRESS);
+
+  for (const FormatCase& format : FORMATS)
+  {
+    const std::vector<u8> src = MakeSource(format, WIDTH, HEIGHT, 1);
+    const std::vector<u8> dst = Decode(format, src, WIDTH, HEIGHT, true);
+    const u32* decoded = reinterpret_cast<const u32*>(dst.data());
+
+    for (u32 t = 0; t < HEIGHT; ++t)
+    {
+      for (u32 s = 0; s < WIDTH; ++s)
+      {
+        u32 expected;
+        if (format.format == GX_TF_CMPR)
+        {
+          expected = DecodeCMPRTexel(src.data(), s, t, WIDTH);
+        }
+        else
+        {
+          TexDecoder::DecodeTexel(reinterpret_cast<u8*>(&expected), src.data(), s, t, WIDTH - 1,
+                                  format.format, tlut, format.tlut_format);
+        }
+        ASSERT_EQ(expected, decoded[t * WIDTH + s])
+            << format.name << " at (" << s << ", " << t << ")";
+      }
+    }
+  }
+}
+
+TEST_F(TextureDecoderTest, AVX2MatchesSSE)
+{
+  if (!cpu_info.bAVX2)
+  {
+    std::printf("AVX2 isn't supported, skipping.\n");
+    return;
+  }
+
+  constexpr u32 WIDTH = 136;
+  constexpr u32 HEIGHT = 40;
+  for (const FormatCase& format : FORMATS)
+  {
+    const std::vector<u8> src = MakeSource(format, WIDTH, HEIGHT, 2);
+    for (bool rgba_only : {true, false})
+    {
+      cpu_info.bAVX2 = false;
+      const std::vector<u8> expected = Decode(format, src, WIDTH, HEIGHT, rgba_only);
+      cpu_info.bAVX2 = true;
+      const std::vector<u8> actual = Decode(format, src, WIDTH, HEIGHT, rgba_only);
+      EXPECT_EQ(0, std::memcmp(expected.data(), actual.data(), expected.size()))
+          << format.name << (rgba_only ? " (RGBA)" : " (native)");
+    }
+  }
+}
@@ -2,21 +2,34 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <random>
 #include <tuple>
 #include <type_traits>
 #include <unordered_set>
+#include <vector>
 
 #include <gtest/gtest.h>  // NOLINT
 
+#include "Common/BitSet.h"
+#include "Common/CPUDetect.h"
 #include "Common/Common.h"
 #include "Common/MathUtil.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VertexDeduplicator.h"
 #include "VideoCommon/VertexLoaderBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/DataReader.h"
+#ifdef _M_X86_64
+// gtest's TEST macro conflicts with the TEST method in the x64Emitter, so the tests of the JIT
+// vertex loader below are attached to a fixture with TEST_F.
+#undef TEST
+#include "VideoCommon/VertexLoaderX64.h"
+#endif
 /*
 TEST(VertexLoaderUID, UniqueEnough)
 {
@@ -356,3 +369,251 @@ TEST_F(VertexLoaderTest, LargeFloatVertexSpeed)
     RunVertices(100000);
 }
 */
+
+#ifdef _M_X86_64
+namespace
+{
+// Indices go up to 0xFFFE, and every array shares the same data
+constexpr u32 ARRAY_STRIDE = 64;
+constexpr size_t ARRAY_SIZE = 0x10000 * ARRAY_STRIDE;
+
+// Any byte that can't turn a float into a NaN or an infinity, or an index into a skipped vertex
+u8 RandomByte(std::mt19937& rng)
+{
+  u8 value;
+  do
+    value = static_cast<u8>(rng());
+  while ((value & 0x7F) == 0x7F);
+  return value;
+}
+
+void FillRandom(std::mt19937& rng, std::vector<u8>* data)
+{
+  for (u8& value : *data)
+    value = RandomByte(rng);
+}
+
+// Any format a game could ask for, with every attribute present in some of them
+void RandomFormat(std::mt19937& rng, TVtxDesc* vtx_desc, VAT* vtx_attr)
+{
+  const auto format = [&rng](u32 value) { return value > FORMAT_FLOAT ? rng() % 5 : value; };
+  const auto color = [&rng](u32 value) { return value > FORMAT_32B_8888 ? rng() % 6 : value; };
+
+  vtx_desc->Hex = (rng() | static_cast<u64>(rng()) << 32) & ((1ull << 33) - 1);
+  if (!vtx_desc->Position)
+    vtx_desc->Position = DIRECT;
+
+  vtx_attr->g0.Hex = rng();
+  vtx_attr->g1.Hex = rng();
+  vtx_attr->g2.Hex = rng();
+  // Games always set it, and the loaders only agree on how to dequantize with it set
+  vtx_attr->g0.ByteDequant = 1;
+  vtx_attr->g0.PosFormat = format(vtx_attr->g0.PosFormat);
+  vtx_attr->g0.NormalFormat = format(vtx_attr->g0.NormalFormat);
+  // Only the software loader drops the alpha of colors that are declared as RGB
+  vtx_attr->g0.Color0Elements = 1;
+  vtx_attr->g0.Color1Elements = 1;
+  vtx_attr->g0.Color0Comp = color(vtx_attr->g0.Color0Comp);
+  vtx_attr->g0.Color1Comp = color(vtx_attr->g0.Color1Comp);
+  vtx_attr->g0.Tex0CoordFormat = format(vtx_attr->g0.Tex0CoordFormat);
+  vtx_attr->g1.Tex1CoordFormat = format(vtx_attr->g1.Tex1CoordFormat);
+  vtx_attr->g1.Tex2CoordFormat = format(vtx_attr->g1.Tex2CoordFormat);
+  vtx_attr->g1.Tex3CoordFormat = format(vtx_attr->g1.Tex3CoordFormat);
+  vtx_attr->g1.Tex4CoordFormat = format(vtx_attr->g1.Tex4CoordFormat);
+  vtx_attr->g2.Tex5CoordFormat = format(vtx_attr->g2.Tex5CoordFormat);
+  vtx_attr->g2.Tex6CoordFormat = format(vtx_attr->g2.Tex6CoordFormat);
+  vtx_attr->g2.Tex7CoordFormat = format(vtx_attr->g2.Tex7CoordFormat);
+}
+
+testing::AssertionResult SameVertices(const std::vector<u8>& expected,
+                                      const std::vector<u8>& actual, u32 stride)
+{
+  if (expected.size() != actual.size())
+  {
+    return testing::AssertionFailure() << actual.size() / stride << " vertices loaded instead of "
+                                       << expected.size() / stride;
+  }
+  for (size_t i = 0; i < expected.size(); i++)
+  {
+    if (expected[i] != actual[i])
+    {
+      return testing::AssertionFailure() << "vertex " << i / stride << " differs at offset "
+                                         << i % stride;
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+class VertexLoaderX64Test : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_array.resize(ARRAY_SIZE);
+    FillRandom(m_rng, &m_array);
+    for (int i = 0; i < 12; i++)
+    {
+      cached_arraybases[i] = m_array.data();
+      g_main_cp_state.array_strides[i] = ARRAY_STRIDE;
+    }
+    g_main_cp_state.matrix_index_a.Hex = 0x2A;
+    m_has_avx2 = cpu_info.bAVX2;
+  }
+
+  void TearDown() override { cpu_info.bAVX2 = m_has_avx2; }
+
+  // The vertices written by loader, up to the last one that wasn't skipped
+  std::vector<u8> Run(VertexLoaderBase* loader, const TVtxDesc& vtx_desc, const VAT& vtx_attr,
+                      std::vector<u8>& src, int count)
+  {
+    // Make room for the vector stores that write past the end of an attribute
+    std::vector<u8> dst((count + 1) * loader->m_native_stride);
+    VertexLoaderParameters parameters = {};
+    parameters.source = src.data();
+    parameters.destination = dst.data();
+    parameters.VtxDesc = &vtx_desc;
+    parameters.VtxAttr = &vtx_attr;
+    parameters.buf_size = src.size();
+    parameters.primitive = OpcodeDecoder::GX_DRAW_TRIANGLES;
+    parameters.count = count;
+    const int loaded = loader->RunVertices(parameters);
+    dst.resize(loaded * loader->m_native_stride);
+    return dst;
+  }
+
+  std::unique_ptr<VertexLoaderBase> CreateX64(const TVtxDesc& vtx_desc, const VAT& vtx_attr,
+                                              bool avx2)
+  {
+    cpu_info.bAVX2 = avx2;
+    return std::make_unique<VertexLoaderX64>(vtx_desc, vtx_attr);
+  }
+
+  std::mt19937 m_rng;
+  std::vector<u8> m_array;
+  bool m_has_avx2;
+};
+}  // namespace
+
+TEST_F(VertexLoaderX64Test, MatchesSoftwareLoader)
+{
+  int draws_with_skipped_vertices = 0;
+  for (int i = 0; i < 2000; i++)
+  {
+    TVtxDesc vtx_desc;
+    VAT vtx_attr;
+    RandomFormat(m_rng, &vtx_desc, &vtx_attr);
+    VertexLoader reference(vtx_desc, vtx_attr);
+
+    // Odd counts leave a vertex after the last pair, and a few vertices are skipped
+    const int count = 1 + m_rng() % 40;
+    std::vector<u8> src(count * reference.m_VertexSize + 16);
+    FillRandom(m_rng, &src);
+    const u32 matrices = vtx_desc.PosMatIdx + BitSet32(vtx_desc.Hex & 0x1FE).Count();
+    int skipped = 0;
+    for (int vertex = 0; vertex < count; vertex++)
+    {
+      u8* data = &src[vertex * reference.m_VertexSize];
+      // Only the software loader masks the texture matrix indices, so keep them in range
+      for (u32 i = 0; i < matrices; i++)
+        data[i] &= 0x3F;
+      if (vtx_desc.Position >= INDEX8 && m_rng() % 8 == 0)
+      {
+        std::memset(data + matrices, 0xFF, vtx_desc.Position == INDEX8 ? 1 : 2);
+        skipped++;
+      }
+      else if (vtx_desc.Position >= INDEX8)
+      {
+        // A random index could still be all ones
+        data[matrices] &= 0x7F;
+      }
+    }
+    const std::vector<u8> expected = Run(&reference, vtx_desc, vtx_attr, src, count);
+    ASSERT_EQ(static_cast<size_t>(count - skipped) * reference.m_native_stride, expected.size());
+    draws_with_skipped_vertices += skipped != 0;
+
+    for (bool avx2 : {false, true})
+    {
+      if (avx2 && !m_has_avx2)
+        continue;
+
+      std::unique_ptr<VertexLoaderBase> loader = CreateX64(vtx_desc, vtx_attr, avx2);
+      ASSERT_EQ(reference.m_VertexSize, loader->m_VertexSize);
+      ASSERT_EQ(reference.m_native_stride, loader->m_native_stride);
+      ASSERT_TRUE(SameVertices(expected, Run(loader.get(), vtx_desc, vtx_attr, src, count),
+                               loader->m_native_stride))
+          << (avx2 ? "AVX2" : "SSE") << ", " << count << " vertices, " << loader->GetName()
+          << std::hex << ", desc " << vtx_desc.Hex << ", vat " << vtx_attr.g0.Hex << " "
+          << vtx_attr.g1.Hex << " " << vtx_attr.g2.Hex;
+    }
+  }
+  EXPECT_LT(100, draws_with_skipped_vertices);
+}
+
+TEST_F(VertexLoaderX64Test, DeduplicatedVertices)
+{
+  TVtxDesc vtx_desc = {};
+  vtx_desc.PosMatIdx = 1;
+  vtx_desc.Position = INDEX16;
+  vtx_desc.Normal = INDEX8;
+  vtx_desc.Tex0Coord = INDEX16;
+  VAT vtx_attr = {};
+  vtx_attr.g0.PosElements = 1;
+  vtx_attr.g0.PosFormat = FORMAT_FLOAT;
+  vtx_attr.g0.NormalFormat = FORMAT_FLOAT;
+  vtx_attr.g0.Tex0CoordElements = 1;
+  vtx_attr.g0.Tex0CoordFormat = FORMAT_FLOAT;
+  std::unique_ptr<VertexLoaderBase> loader = CreateX64(vtx_desc, vtx_attr, m_has_avx2);
+  const int vertex_size = loader->m_VertexSize;
+  const int stride = loader->m_native_stride;
+  ASSERT_TRUE(VertexDeduplicator::CanDeduplicate(vtx_desc, vertex_size));
+
+  // The triangles of a grid, so most vertices are used six times, with one of them skipped
+  constexpr u32 GRID = 8;
+  std::vector<u8> src;
+  for (u32 y = 0; y + 1 < GRID; y++)
+  {
+    for (u32 x = 0; x + 1 < GRID; x++)
+    {
+      for (u32 corner : {0u, 1u, GRID, 1u, GRID + 1, GRID})
+      {
+        const u32 index = y * GRID + x + corner;
+        src.push_back(static_cast<u8>(index % 2 * 3));
+        src.push_back(static_cast<u8>(index >> 8));
+        src.push_back(static_cast<u8>(index));
+        src.push_back(static_cast<u8>(index % 5));
+        src.push_back(static_cast<u8>(index >> 8));
+        src.push_back(static_cast<u8>(index));
+      }
+    }
+  }
+  src[10 * vertex_size + 1] = 0xFF;
+  src[10 * vertex_size + 2] = 0xFF;
+  const int count = static_cast<int>(src.size()) / vertex_size;
+  const std::vector<u8> expected = Run(loader.get(), vtx_desc, vtx_attr, src, count);
+  const int loaded = static_cast<int>(expected.size()) / stride;
+  ASSERT_EQ(count - 1, loaded);
+
+  VertexDeduplicator deduplicator;
+  ASSERT_TRUE(deduplicator.Deduplicate(src.data(), src.size(), count, vertex_size, vtx_desc));
+  ASSERT_EQ(static_cast<u32>(loaded), deduplicator.GetNumVertices());
+  const u32 unique = deduplicator.GetNumUniqueVertices();
+  EXPECT_EQ(GRID * GRID, unique);
+
+  std::vector<u8> unique_src(deduplicator.GetVertices(),
+                             deduplicator.GetVertices() + unique * vertex_size);
+  const std::vector<u8> actual = Run(loader.get(), vtx_desc, vtx_attr, unique_src, unique);
+  ASSERT_EQ(unique * stride, actual.size());
+  for (int i = 0; i < loaded; i++)
+  {
+    EXPECT_EQ(0, std::memcmp(&expected[i * stride], &actual[deduplicator.GetRemap()[i] * stride],
+                             stride))
+        << "vertex " << i;
+  }
+
+  // Vertices that are all different aren't worth the trouble
+  for (int i = 0; i < count; i++)
+    src[i * vertex_size + 2] = static_cast<u8>(i);
+  EXPECT_FALSE(deduplicator.Deduplicate(src.data(), src.size(), count, vertex_size, vtx_desc));
+}
+
+#endif